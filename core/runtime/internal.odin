@@ -335,7 +335,8 @@ type_assertion_check :: proc "contextless" (ok: bool, file: string, line, column
 	handle_error(file, line, column, from, to);
 }
 
-string_decode_rune :: inline proc "contextless" (s: string) -> (rune, int) {
+// NOTE: Not "contextless", so the context of the caller is used rather than a new one for every rune
+string_decode_rune :: inline proc(s: string) -> (rune, int) {
 	return utf8.decode_rune_in_string(s);
 }
 
@@ -0,0 +1,84 @@
+package main
+
+// Throughput of `for r in s` on a large ASCII and a large mixed UTF-8 string
+//
+// `for r in s` decodes ASCII inline and only calls the decoder for multi-byte sequences. The
+// "decoder per rune" loop calls `utf8.decode_rune_in_string` for every rune, which is how every
+// `for r in s` loop was compiled before, so the two columns show the difference.
+//
+//     odin run examples/benchmarks/range_string.odin -opt=0
+
+import "core:fmt"
+import "core:time"
+import "core:unicode/utf8"
+
+SIZE :: 64 * 1024 * 1024;
+RUNS :: 5;
+
+make_text :: proc(pieces: []string) -> string {
+	data := make([]u8, SIZE);
+	n := 0;
+	for i := 0; n+len(pieces[i]) <= SIZE; i = (i+1) % len(pieces) {
+		copy(data[n:], cast([]u8)pieces[i]);
+		n += len(pieces[i]);
+	}
+	return string(data[:n]);
+}
+
+range_string :: proc(s: string) -> (sum: u64, count: int) {
+	for r in s {
+		sum += u64(r);
+		count += 1;
+	}
+	return;
+}
+
+decoder_per_rune :: proc(s: string) -> (sum: u64, count: int) {
+	for i := 0; i < len(s); {
+		r, n := utf8.decode_rune_in_string(s[i:]);
+		sum += u64(r);
+		count += 1;
+		i += n;
+	}
+	return;
+}
+
+// NOTE: The best of several runs, in MiB/s
+measure :: proc(s: string, p: proc(s: string) -> (u64, int)) -> (throughput: f64, sum: u64, count: int) {
+	best := max(f64);
+	for in 0..RUNS-1 {
+		start := time.now();
+		sum, count = p(s);
+		seconds := time.duration_seconds(time.diff(start, time.now()));
+		best = min(best, seconds);
+	}
+	throughput = f64(len(s)) / (1024*1024) / best;
+	return;
+}
+
+main :: proc() {
+	ascii := make_text([]string{
+		"The quick brown fox jumps over the lazy dog. ",
+		"Pack my box with five dozen liquor jugs!\n",
+	});
+	mixed := make_text([]string{
+		"The quick brown fox jumps over the lazy dog. ",
+		"Größenwahn und Überfluss, ",
+		"日本語のテキスト、",
+		"Привет, мир! ",
+		"emoji 🦊🐶\n",
+	});
+	defer delete(ascii);
+	defer delete(mixed);
+
+	inputs := [?]struct{name: string, text: string}{
+		{"ascii", ascii},
+		{"mixed", mixed},
+	};
+	for input in inputs {
+		fast, fast_sum, fast_count := measure(input.text, range_string);
+		slow, slow_sum, slow_count := measure(input.text, decoder_per_rune);
+		assert(fast_sum == slow_sum && fast_count == slow_count);
+		fmt.printf("%s: for r in s %.0f MiB/s, decoder per rune %.0f MiB/s (%.2fx)\n", input.name, fast, slow, fast/slow);
+	}
+}
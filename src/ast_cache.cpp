@@ -0,0 +1,981 @@
+// Cache of parsed files (-ast-cache)
+//
+// Once a file of a library collection (core:, shared: and any added with -collection) has been
+// parsed without any errors or warnings, its AST is written to '<ODIN_ROOT>/.odin-ast-cache/'.
+// The next build which finds the same source, compiler build, and target maps that file in and
+// copies the nodes across rather than tokenizing and parsing the source again.
+//
+// The nodes are stored as they are in memory but every pointer within them is replaced with a
+// reference which does not depend upon where the cache is loaded:
+//	Ast *          - index+1 into the nodes, 0 is nullptr
+//	CommentGroup * - index+1 into the comment groups
+//	Array<T>.data  - offset+1 into the data section
+//	String.text    - see AstCacheStringTag
+//
+// NOTE: Only the parsing is cached. The Scopes, Entities, and Types of a checked package
+// point into the universal scope and the types which are shared by every package, and checking
+// a later package will add to them (e.g. polymorphic procedures), so they cannot be stored for
+// a single package.
+
+#define AST_CACHE_MAGIC   0x005453416e69646full // "odinAST" as a little endian u64
+#define AST_CACHE_VERSION 1
+
+enum AstCacheStringTag {
+	AstCacheString_None     = 0, // nullptr
+	AstCacheString_Source   = 1, // Offset within the source of the file
+	AstCacheString_Interned = 2, // Index into the interned strings, they are interned again when loaded
+	AstCacheString_Data     = 3, // Offset within the data section
+
+	AstCacheString_TagBits  = 2,
+};
+
+struct AstCacheHeader {
+	u64 magic;
+	u64 version;
+	u64 key;         // NOTE: See 'ast_cache_key'
+	u64 source_hash;
+	u64 source_size;
+	u64 total_size;
+
+	u64 node_count;
+	u64 group_count;
+	u64 interned_count;
+	u64 data_size;
+
+	// NOTE: The parts of the AstFile which are set whilst parsing
+	Token        package_token;
+	String       package_name;
+	Ast *        pkg_decl;
+	Array<Ast *> decls;
+	Array<Ast *> imports;
+	i64          line_count;
+	i64          token_count;
+	i64          node_count_parsed;
+};
+
+enum AstCacheMode {
+	AstCache_Save,
+	AstCache_Load,
+};
+
+struct AstCache {
+	AstCacheMode mode;
+	AstFile *    file;
+	bool         ok; // NOTE: Cleared if the file cannot be saved or the cache is corrupt
+
+	// NOTE: Saving
+	Array<Ast *>          nodes;
+	Map<uintptr>          node_map;     // Key: Ast *
+	Array<CommentGroup *> groups;
+	Map<uintptr>          group_map;    // Key: CommentGroup *
+	Array<String>         interned;
+	Map<uintptr>          interned_map; // Key: u8 * of an interned string
+	Array<u8>             data;
+
+	// NOTE: Loading
+	Ast *         loaded_nodes;
+	isize         loaded_node_count;
+	CommentGroup *loaded_groups;
+	isize         loaded_group_count;
+	String *      loaded_interned;
+	isize         loaded_interned_count;
+	u8 *          loaded_data;
+	isize         loaded_data_size;
+};
+
+gb_global String ast_cache_dir = {};
+
+
+bool ast_cache__create_directory(String path) {
+#if defined(GB_SYSTEM_WINDOWS)
+	String16 wpath = string_to_string16(heap_allocator(), path);
+	defer (gb_free(heap_allocator(), wpath.text));
+	return CreateDirectoryW(wpath.text, nullptr) || GetLastError() == ERROR_ALREADY_EXISTS;
+#else
+	char *c_str = alloc_cstring(heap_allocator(), path);
+	defer (gb_free(heap_allocator(), c_str));
+	return mkdir(c_str, 0755) == 0 || errno == EEXIST;
+#endif
+}
+
+u64 ast_cache__process_id(void) {
+#if defined(GB_SYSTEM_WINDOWS)
+	return cast(u64)GetCurrentProcessId();
+#else
+	return cast(u64)getpid();
+#endif
+}
+
+void init_ast_cache(void) {
+	String dir = concatenate_strings(heap_allocator(), build_context.ODIN_ROOT, str_lit(".odin-ast-cache"));
+	if (!ast_cache__create_directory(dir)) {
+		// NOTE: e.g. A read-only installation, every file is just parsed as usual
+		gb_free(heap_allocator(), dir.text);
+		return;
+	}
+	ast_cache_dir = dir;
+}
+
+bool ast_cache_use_for_file(AstFile *f) {
+	if (ast_cache_dir.len == 0 || f->tokenizer.start == nullptr) {
+		return false;
+	}
+	for_array(i, library_collections) {
+		String path = library_collections[i].path;
+		if (path.len > 0 && string_starts_with(f->fullpath, path)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+i64 ast_cache_diagnostic_count(void) {
+	gb_mutex_lock(&global_error_collector.mutex);
+	defer (gb_mutex_unlock(&global_error_collector.mutex));
+	return global_error_collector.count + global_error_collector.warning_count;
+}
+
+u64 ast_cache_key(AstFile *f) {
+	u64 h = 0xcbf29ce484222325ull;
+	h = build_cache__hash_u64(h, AST_CACHE_VERSION);
+	h = build_cache__hash_string(h, build_context.ODIN_VERSION);
+	// NOTE: The layout of the nodes may differ between any two builds of the compiler
+	h = build_cache__hash_string(h, str_lit(__DATE__ " " __TIME__));
+	h = build_cache__hash_u64(h, gb_size_of(Ast));
+	h = build_cache__hash_u64(h, Ast_COUNT);
+	// NOTE: Whether a file is parsed at all depends on its '+build' tags
+	h = build_cache__hash_string(h, build_context.ODIN_OS);
+	h = build_cache__hash_string(h, build_context.ODIN_ARCH);
+	h = build_cache__hash_u64(h, f->pkg->kind);
+	h = build_cache__hash_string(h, f->fullpath);
+	return h;
+}
+
+String ast_cache_path(gbAllocator a, AstFile *f) {
+	u64 h = build_cache__hash_string(0xcbf29ce484222325ull, f->fullpath);
+	String name = build_cache__hex(a, h);
+	defer (gb_free(a, name.text));
+	isize len = ast_cache_dir.len + 1 + name.len + 4;
+	u8 *text = gb_alloc_array(a, u8, len+1);
+	gb_snprintf(cast(char *)text, len+1, "%.*s/%.*s.ast", LIT(ast_cache_dir), LIT(name));
+	return make_string(text, len);
+}
+
+u64 ast_cache_source_hash(AstFile *f) {
+	Tokenizer *t = &f->tokenizer;
+	return build_cache__hash(0xcbf29ce484222325ull, t->start, t->end - t->start);
+}
+
+
+uintptr ast_cache__write(AstCache *c, void const *ptr, isize size) {
+	isize offset = c->data.count;
+	array_resize(&c->data, align_formula_isize(offset+size, 8));
+	gb_memmove(c->data.data+offset, ptr, size);
+	return cast(uintptr)offset;
+}
+
+bool ast_cache__data(AstCache *c, uintptr ref, isize size, u8 **data_) {
+	if (ref == 0) {
+		*data_ = nullptr;
+		return size == 0;
+	}
+	uintptr offset = ref-1;
+	if (size < 0 || offset > cast(uintptr)c->loaded_data_size || cast(uintptr)size > cast(uintptr)c->loaded_data_size-offset) {
+		c->ok = false;
+		*data_ = nullptr;
+		return false;
+	}
+	*data_ = c->loaded_data + offset;
+	return true;
+}
+
+void ast_cache_string(AstCache *c, String *s) {
+	if (c->mode == AstCache_Save) {
+		Tokenizer *t = &c->file->tokenizer;
+		uintptr ref = 0;
+		if (s->len == 0) {
+			ref = AstCacheString_None;
+		} else if (string_is_interned(*s)) {
+			uintptr *found = map_get(&c->interned_map, hash_pointer(s->text));
+			uintptr index = 0;
+			if (found != nullptr) {
+				index = *found;
+			} else {
+				index = c->interned.count;
+				array_add(&c->interned, *s);
+				map_set(&c->interned_map, hash_pointer(s->text), index);
+			}
+			ref = (index << AstCacheString_TagBits) | AstCacheString_Interned;
+		} else if (t->start <= s->text && s->text+s->len <= t->end) {
+			uintptr offset = s->text - t->start;
+			ref = (offset << AstCacheString_TagBits) | AstCacheString_Source;
+		} else {
+			uintptr offset = ast_cache__write(c, s->text, s->len);
+			ref = (offset << AstCacheString_TagBits) | AstCacheString_Data;
+		}
+		s->text = cast(u8 *)ref;
+		return;
+	}
+
+	Tokenizer *t = &c->file->tokenizer;
+	uintptr ref = cast(uintptr)s->text;
+	uintptr value = ref >> AstCacheString_TagBits;
+	switch (ref & ((1<<AstCacheString_TagBits)-1)) {
+	case AstCacheString_None:
+		s->text = nullptr;
+		if (s->len != 0) c->ok = false;
+		break;
+	case AstCacheString_Source:
+		if (s->len < 0 || value > cast(uintptr)(t->end-t->start) || cast(uintptr)s->len > cast(uintptr)(t->end-t->start)-value) {
+			c->ok = false;
+			*s = {};
+		} else {
+			s->text = t->start + value;
+		}
+		break;
+	case AstCacheString_Interned:
+		if (value >= cast(uintptr)c->loaded_interned_count || c->loaded_interned[value].len != s->len) {
+			c->ok = false;
+			*s = {};
+		} else {
+			*s = c->loaded_interned[value];
+		}
+		break;
+	case AstCacheString_Data:
+		if (!ast_cache__data(c, value+1, s->len, &s->text)) {
+			*s = {};
+		}
+		break;
+	}
+}
+
+void ast_cache_token(AstCache *c, Token *token) {
+	ast_cache_string(c, &token->string);
+
+	// NOTE: Every token of a file refers to that file, only empty tokens have no file
+	String *file = &token->pos.file;
+	if (c->mode == AstCache_Save) {
+		if (file->len == 0) {
+			file->text = nullptr;
+		} else if (*file == c->file->tokenizer.fullpath) {
+			file->text = cast(u8 *)cast(uintptr)1;
+		} else {
+			c->ok = false;
+		}
+	} else if (file->text != nullptr) {
+		if (cast(uintptr)file->text != 1 || file->len != c->file->tokenizer.fullpath.len) {
+			c->ok = false;
+		}
+		*file = c->file->tokenizer.fullpath;
+	}
+}
+
+void ast_cache_node(AstCache *c, Ast **node) {
+	if (c->mode == AstCache_Save) {
+		if (*node == nullptr) {
+			return;
+		}
+		uintptr *found = map_get(&c->node_map, hash_pointer(*node));
+		uintptr index = 0;
+		if (found != nullptr) {
+			index = *found;
+		} else {
+			index = c->nodes.count;
+			array_add(&c->nodes, *node);
+			map_set(&c->node_map, hash_pointer(*node), index);
+		}
+		*node = cast(Ast *)(index+1);
+		return;
+	}
+
+	uintptr ref = cast(uintptr)*node;
+	if (ref == 0) {
+		return;
+	}
+	if (ref > cast(uintptr)c->loaded_node_count) {
+		c->ok = false;
+		*node = nullptr;
+		return;
+	}
+	*node = &c->loaded_nodes[ref-1];
+}
+
+void ast_cache_comment_group(AstCache *c, CommentGroup **group) {
+	if (c->mode == AstCache_Save) {
+		if (*group == nullptr) {
+			return;
+		}
+		uintptr *found = map_get(&c->group_map, hash_pointer(*group));
+		uintptr index = 0;
+		if (found != nullptr) {
+			index = *found;
+		} else {
+			index = c->groups.count;
+			array_add(&c->groups, *group);
+			map_set(&c->group_map, hash_pointer(*group), index);
+		}
+		*group = cast(CommentGroup *)(index+1);
+		return;
+	}
+
+	uintptr ref = cast(uintptr)*group;
+	if (ref == 0) {
+		return;
+	}
+	if (ref > cast(uintptr)c->loaded_group_count) {
+		c->ok = false;
+		*group = nullptr;
+		return;
+	}
+	*group = &c->loaded_groups[ref-1];
+}
+
+// NOTE: The elements are handled one at a time as a copy, as saving a string or token
+// may write to (and move) the data section which holds the elements
+template <typename T, typename Proc>
+void ast_cache_array(AstCache *c, Array<T> *array, Proc elem_proc) {
+	isize count = array->count;
+	if (c->mode == AstCache_Save) {
+		if (count == 0) {
+			*array = {};
+			return;
+		}
+		uintptr offset = ast_cache__write(c, array->data, count*gb_size_of(T));
+		for (isize i = 0; i < count; i++) {
+			T elem = (cast(T *)(c->data.data+offset))[i];
+			elem_proc(c, &elem);
+			(cast(T *)(c->data.data+offset))[i] = elem;
+		}
+		*array = {};
+		array->data     = cast(T *)(offset+1);
+		array->count    = count;
+		array->capacity = count;
+		return;
+	}
+
+	u8 *data = nullptr;
+	if (count < 0 || !ast_cache__data(c, cast(uintptr)array->data, count*gb_size_of(T), &data)) {
+		*array = {};
+		c->ok = false;
+		return;
+	}
+	// NOTE: The data section is copied into the AST arena when loaded, like 'clone_ast_array'
+	*array = array_make_from_ptr(cast(T *)data, count, count);
+	array->allocator = ast_allocator();
+	for (isize i = 0; i < count; i++) {
+		elem_proc(c, &(*array)[i]);
+	}
+}
+
+void ast_cache_nodes(AstCache *c, Array<Ast *> *nodes) {
+	ast_cache_array(c, nodes, ast_cache_node);
+}
+void ast_cache_tokens(AstCache *c, Array<Token> *tokens) {
+	ast_cache_array(c, tokens, ast_cache_token);
+}
+
+void ast_cache_visit(AstCache *c, Ast *n) {
+	if (c->mode == AstCache_Save) {
+		// NOTE: Nothing has been checked yet, these are cleared just in case
+		n->file         = nullptr;
+		n->scope        = nullptr;
+		n->been_handled = false;
+		n->tav          = {};
+	} else {
+		n->file = c->file;
+	}
+
+	switch (n->kind) {
+	default:
+		c->ok = false;
+		break;
+
+	case Ast_Ident:
+		ast_cache_token(c, &n->Ident.token);
+		n->Ident.entity = nullptr;
+		break;
+	case Ast_Implicit:
+		ast_cache_token(c, &n->Implicit);
+		break;
+	case Ast_Undef:
+		ast_cache_token(c, &n->Undef);
+		break;
+	case Ast_BasicLit:
+		ast_cache_token(c, &n->BasicLit.token);
+		break;
+	case Ast_BasicDirective:
+		ast_cache_token(c, &n->BasicDirective.token);
+		ast_cache_string(c, &n->BasicDirective.name);
+		break;
+	case Ast_Ellipsis:
+		ast_cache_token(c, &n->Ellipsis.token);
+		ast_cache_node(c, &n->Ellipsis.expr);
+		break;
+	case Ast_ProcGroup:
+		ast_cache_token(c, &n->ProcGroup.token);
+		ast_cache_token(c, &n->ProcGroup.open);
+		ast_cache_token(c, &n->ProcGroup.close);
+		ast_cache_nodes(c, &n->ProcGroup.args);
+		break;
+	case Ast_ProcLit:
+		ast_cache_node(c, &n->ProcLit.type);
+		ast_cache_node(c, &n->ProcLit.body);
+		break;
+	case Ast_CompoundLit:
+		ast_cache_node(c, &n->CompoundLit.type);
+		ast_cache_nodes(c, &n->CompoundLit.elems);
+		ast_cache_token(c, &n->CompoundLit.open);
+		ast_cache_token(c, &n->CompoundLit.close);
+		break;
+
+	case Ast_BadExpr:
+		ast_cache_token(c, &n->BadExpr.begin);
+		ast_cache_token(c, &n->BadExpr.end);
+		break;
+	case Ast_TagExpr:
+		ast_cache_token(c, &n->TagExpr.token);
+		ast_cache_token(c, &n->TagExpr.name);
+		ast_cache_node(c, &n->TagExpr.expr);
+		break;
+	case Ast_RunExpr:
+		ast_cache_token(c, &n->RunExpr.token);
+		ast_cache_token(c, &n->RunExpr.name);
+		ast_cache_node(c, &n->RunExpr.expr);
+		break;
+	case Ast_UnaryExpr:
+		ast_cache_token(c, &n->UnaryExpr.op);
+		ast_cache_node(c, &n->UnaryExpr.expr);
+		break;
+	case Ast_BinaryExpr:
+		ast_cache_token(c, &n->BinaryExpr.op);
+		ast_cache_node(c, &n->BinaryExpr.left);
+		ast_cache_node(c, &n->BinaryExpr.right);
+		break;
+	case Ast_ParenExpr:
+		ast_cache_node(c, &n->ParenExpr.expr);
+		ast_cache_token(c, &n->ParenExpr.open);
+		ast_cache_token(c, &n->ParenExpr.close);
+		break;
+	case Ast_SelectorExpr:
+		ast_cache_token(c, &n->SelectorExpr.token);
+		ast_cache_node(c, &n->SelectorExpr.expr);
+		ast_cache_node(c, &n->SelectorExpr.selector);
+		break;
+	case Ast_IndexExpr:
+		ast_cache_node(c, &n->IndexExpr.expr);
+		ast_cache_node(c, &n->IndexExpr.index);
+		ast_cache_token(c, &n->IndexExpr.open);
+		ast_cache_token(c, &n->IndexExpr.close);
+		break;
+	case Ast_DerefExpr:
+		ast_cache_token(c, &n->DerefExpr.op);
+		ast_cache_node(c, &n->DerefExpr.expr);
+		break;
+	case Ast_SliceExpr:
+		ast_cache_node(c, &n->SliceExpr.expr);
+		ast_cache_token(c, &n->SliceExpr.open);
+		ast_cache_token(c, &n->SliceExpr.close);
+		ast_cache_token(c, &n->SliceExpr.interval);
+		ast_cache_node(c, &n->SliceExpr.low);
+		ast_cache_node(c, &n->SliceExpr.high);
+		break;
+	case Ast_CallExpr:
+		ast_cache_node(c, &n->CallExpr.proc);
+		ast_cache_nodes(c, &n->CallExpr.args);
+		ast_cache_token(c, &n->CallExpr.open);
+		ast_cache_token(c, &n->CallExpr.close);
+		ast_cache_token(c, &n->CallExpr.ellipsis);
+		break;
+	case Ast_FieldValue:
+		ast_cache_token(c, &n->FieldValue.eq);
+		ast_cache_node(c, &n->FieldValue.field);
+		ast_cache_node(c, &n->FieldValue.value);
+		break;
+	case Ast_TernaryExpr:
+		ast_cache_node(c, &n->TernaryExpr.cond);
+		ast_cache_node(c, &n->TernaryExpr.x);
+		ast_cache_node(c, &n->TernaryExpr.y);
+		break;
+	case Ast_TypeAssertion:
+		ast_cache_node(c, &n->TypeAssertion.expr);
+		ast_cache_token(c, &n->TypeAssertion.dot);
+		ast_cache_node(c, &n->TypeAssertion.type);
+		break;
+	case Ast_TypeCast:
+		ast_cache_token(c, &n->TypeCast.token);
+		ast_cache_node(c, &n->TypeCast.type);
+		ast_cache_node(c, &n->TypeCast.expr);
+		break;
+	case Ast_AutoCast:
+		ast_cache_token(c, &n->AutoCast.token);
+		ast_cache_node(c, &n->AutoCast.expr);
+		break;
+
+	case Ast_BadStmt:
+		ast_cache_token(c, &n->BadStmt.begin);
+		ast_cache_token(c, &n->BadStmt.end);
+		break;
+	case Ast_EmptyStmt:
+		ast_cache_token(c, &n->EmptyStmt.token);
+		break;
+	case Ast_ExprStmt:
+		ast_cache_node(c, &n->ExprStmt.expr);
+		break;
+	case Ast_TagStmt:
+		ast_cache_token(c, &n->TagStmt.token);
+		ast_cache_token(c, &n->TagStmt.name);
+		ast_cache_node(c, &n->TagStmt.stmt);
+		break;
+	case Ast_AssignStmt:
+		ast_cache_token(c, &n->AssignStmt.op);
+		ast_cache_nodes(c, &n->AssignStmt.lhs);
+		ast_cache_nodes(c, &n->AssignStmt.rhs);
+		break;
+	case Ast_IncDecStmt:
+		ast_cache_token(c, &n->IncDecStmt.op);
+		ast_cache_node(c, &n->IncDecStmt.expr);
+		break;
+	case Ast_BlockStmt:
+		ast_cache_nodes(c, &n->BlockStmt.stmts);
+		ast_cache_node(c, &n->BlockStmt.label);
+		ast_cache_token(c, &n->BlockStmt.open);
+		ast_cache_token(c, &n->BlockStmt.close);
+		break;
+	case Ast_IfStmt:
+		ast_cache_token(c, &n->IfStmt.token);
+		ast_cache_node(c, &n->IfStmt.label);
+		ast_cache_node(c, &n->IfStmt.init);
+		ast_cache_node(c, &n->IfStmt.cond);
+		ast_cache_node(c, &n->IfStmt.body);
+		ast_cache_node(c, &n->IfStmt.else_stmt);
+		break;
+	case Ast_WhenStmt:
+		ast_cache_token(c, &n->WhenStmt.token);
+		ast_cache_node(c, &n->WhenStmt.cond);
+		ast_cache_node(c, &n->WhenStmt.body);
+		ast_cache_node(c, &n->WhenStmt.else_stmt);
+		break;
+	case Ast_ReturnStmt:
+		ast_cache_token(c, &n->ReturnStmt.token);
+		ast_cache_nodes(c, &n->ReturnStmt.results);
+		break;
+	case Ast_ForStmt:
+		ast_cache_token(c, &n->ForStmt.token);
+		ast_cache_node(c, &n->ForStmt.label);
+		ast_cache_node(c, &n->ForStmt.init);
+		ast_cache_node(c, &n->ForStmt.cond);
+		ast_cache_node(c, &n->ForStmt.post);
+		ast_cache_node(c, &n->ForStmt.body);
+		break;
+	case Ast_RangeStmt:
+		ast_cache_token(c, &n->RangeStmt.token);
+		ast_cache_node(c, &n->RangeStmt.label);
+		ast_cache_node(c, &n->RangeStmt.val0);
+		ast_cache_node(c, &n->RangeStmt.val1);
+		ast_cache_token(c, &n->RangeStmt.in_token);
+		ast_cache_node(c, &n->RangeStmt.expr);
+		ast_cache_node(c, &n->RangeStmt.body);
+		break;
+	case Ast_CaseClause:
+		ast_cache_token(c, &n->CaseClause.token);
+		ast_cache_nodes(c, &n->CaseClause.list);
+		ast_cache_nodes(c, &n->CaseClause.stmts);
+		n->CaseClause.implicit_entity = nullptr;
+		break;
+	case Ast_SwitchStmt:
+		ast_cache_token(c, &n->SwitchStmt.token);
+		ast_cache_node(c, &n->SwitchStmt.label);
+		ast_cache_node(c, &n->SwitchStmt.init);
+		ast_cache_node(c, &n->SwitchStmt.tag);
+		ast_cache_node(c, &n->SwitchStmt.body);
+		break;
+	case Ast_TypeSwitchStmt:
+		ast_cache_token(c, &n->TypeSwitchStmt.token);
+		ast_cache_node(c, &n->TypeSwitchStmt.label);
+		ast_cache_node(c, &n->TypeSwitchStmt.tag);
+		ast_cache_node(c, &n->TypeSwitchStmt.body);
+		break;
+	case Ast_DeferStmt:
+		ast_cache_token(c, &n->DeferStmt.token);
+		ast_cache_node(c, &n->DeferStmt.stmt);
+		break;
+	case Ast_BranchStmt:
+		ast_cache_token(c, &n->BranchStmt.token);
+		ast_cache_node(c, &n->BranchStmt.label);
+		break;
+	case Ast_UsingStmt:
+		ast_cache_token(c, &n->UsingStmt.token);
+		ast_cache_nodes(c, &n->UsingStmt.list);
+		break;
+
+	case Ast_BadDecl:
+		ast_cache_token(c, &n->BadDecl.begin);
+		ast_cache_token(c, &n->BadDecl.end);
+		break;
+	case Ast_ForeignBlockDecl:
+		ast_cache_token(c, &n->ForeignBlockDecl.token);
+		ast_cache_node(c, &n->ForeignBlockDecl.foreign_library);
+		ast_cache_node(c, &n->ForeignBlockDecl.body);
+		ast_cache_nodes(c, &n->ForeignBlockDecl.attributes);
+		ast_cache_comment_group(c, &n->ForeignBlockDecl.docs);
+		break;
+	case Ast_Label:
+		ast_cache_token(c, &n->Label.token);
+		ast_cache_node(c, &n->Label.name);
+		break;
+	case Ast_ValueDecl:
+		ast_cache_nodes(c, &n->ValueDecl.names);
+		ast_cache_node(c, &n->ValueDecl.type);
+		ast_cache_nodes(c, &n->ValueDecl.values);
+		ast_cache_nodes(c, &n->ValueDecl.attributes);
+		ast_cache_comment_group(c, &n->ValueDecl.docs);
+		ast_cache_comment_group(c, &n->ValueDecl.comment);
+		break;
+	case Ast_PackageDecl:
+		ast_cache_token(c, &n->PackageDecl.token);
+		ast_cache_token(c, &n->PackageDecl.name);
+		ast_cache_comment_group(c, &n->PackageDecl.docs);
+		ast_cache_comment_group(c, &n->PackageDecl.comment);
+		break;
+	case Ast_ImportDecl:
+		// NOTE: 'fullpath' depends upon the collections, it is set again by 'parse_setup_file_decls'
+		n->ImportDecl.package  = nullptr;
+		n->ImportDecl.fullpath = {};
+		ast_cache_token(c, &n->ImportDecl.token);
+		ast_cache_token(c, &n->ImportDecl.relpath);
+		ast_cache_token(c, &n->ImportDecl.import_name);
+		ast_cache_comment_group(c, &n->ImportDecl.docs);
+		ast_cache_comment_group(c, &n->ImportDecl.comment);
+		break;
+	case Ast_ForeignImportDecl:
+		n->ForeignImportDecl.fullpaths = {};
+		ast_cache_token(c, &n->ForeignImportDecl.token);
+		ast_cache_tokens(c, &n->ForeignImportDecl.filepaths);
+		ast_cache_token(c, &n->ForeignImportDecl.library_name);
+		ast_cache_string(c, &n->ForeignImportDecl.collection_name);
+		ast_cache_comment_group(c, &n->ForeignImportDecl.docs);
+		ast_cache_comment_group(c, &n->ForeignImportDecl.comment);
+		break;
+
+	case Ast_Attribute:
+		ast_cache_token(c, &n->Attribute.token);
+		ast_cache_nodes(c, &n->Attribute.elems);
+		ast_cache_token(c, &n->Attribute.open);
+		ast_cache_token(c, &n->Attribute.close);
+		break;
+	case Ast_Field:
+		ast_cache_nodes(c, &n->Field.names);
+		ast_cache_node(c, &n->Field.type);
+		ast_cache_node(c, &n->Field.default_value);
+		ast_cache_comment_group(c, &n->Field.docs);
+		ast_cache_comment_group(c, &n->Field.comment);
+		break;
+	case Ast_FieldList:
+		ast_cache_token(c, &n->FieldList.token);
+		ast_cache_nodes(c, &n->FieldList.list);
+		break;
+
+	case Ast_TypeidType:
+		ast_cache_token(c, &n->TypeidType.token);
+		ast_cache_node(c, &n->TypeidType.specialization);
+		break;
+	case Ast_HelperType:
+		ast_cache_token(c, &n->HelperType.token);
+		ast_cache_node(c, &n->HelperType.type);
+		break;
+	case Ast_DistinctType:
+		ast_cache_token(c, &n->DistinctType.token);
+		ast_cache_node(c, &n->DistinctType.type);
+		break;
+	case Ast_OpaqueType:
+		ast_cache_token(c, &n->OpaqueType.token);
+		ast_cache_node(c, &n->OpaqueType.type);
+		break;
+	case Ast_PolyType:
+		ast_cache_token(c, &n->PolyType.token);
+		ast_cache_node(c, &n->PolyType.type);
+		ast_cache_node(c, &n->PolyType.specialization);
+		break;
+	case Ast_ProcType:
+		ast_cache_token(c, &n->ProcType.token);
+		ast_cache_node(c, &n->ProcType.params);
+		ast_cache_node(c, &n->ProcType.results);
+		break;
+	case Ast_PointerType:
+		ast_cache_token(c, &n->PointerType.token);
+		ast_cache_node(c, &n->PointerType.type);
+		break;
+	case Ast_ArrayType:
+		ast_cache_token(c, &n->ArrayType.token);
+		ast_cache_node(c, &n->ArrayType.count);
+		ast_cache_node(c, &n->ArrayType.elem);
+		break;
+	case Ast_DynamicArrayType:
+		ast_cache_token(c, &n->DynamicArrayType.token);
+		ast_cache_node(c, &n->DynamicArrayType.elem);
+		break;
+	case Ast_StructType:
+		ast_cache_token(c, &n->StructType.token);
+		ast_cache_nodes(c, &n->StructType.fields);
+		ast_cache_node(c, &n->StructType.polymorphic_params);
+		ast_cache_node(c, &n->StructType.align);
+		break;
+	case Ast_UnionType:
+		ast_cache_token(c, &n->UnionType.token);
+		ast_cache_nodes(c, &n->UnionType.variants);
+		ast_cache_node(c, &n->UnionType.polymorphic_params);
+		ast_cache_node(c, &n->UnionType.align);
+		break;
+	case Ast_EnumType:
+		ast_cache_token(c, &n->EnumType.token);
+		ast_cache_node(c, &n->EnumType.base_type);
+		ast_cache_nodes(c, &n->EnumType.fields);
+		break;
+	case Ast_BitFieldType:
+		ast_cache_token(c, &n->BitFieldType.token);
+		ast_cache_nodes(c, &n->BitFieldType.fields);
+		ast_cache_node(c, &n->BitFieldType.align);
+		break;
+	case Ast_BitSetType:
+		ast_cache_token(c, &n->BitSetType.token);
+		ast_cache_node(c, &n->BitSetType.elem);
+		ast_cache_node(c, &n->BitSetType.underlying);
+		break;
+	case Ast_MapType:
+		ast_cache_token(c, &n->MapType.token);
+		ast_cache_node(c, &n->MapType.count);
+		ast_cache_node(c, &n->MapType.key);
+		ast_cache_node(c, &n->MapType.value);
+		break;
+	}
+}
+
+
+// NOTE: Called once the file has been parsed (and 'parse_setup_file_decls' has run) without
+// any new errors or warnings since 'prev_diagnostic_count'
+bool ast_cache_save_file(AstFile *f, i64 prev_diagnostic_count) {
+	if (ast_cache_diagnostic_count() != prev_diagnostic_count || f->error_count > 0) {
+		return false;
+	}
+
+	gbAllocator a = heap_allocator();
+	AstCache c = {};
+	c.mode = AstCache_Save;
+	c.file = f;
+	c.ok   = true;
+	array_init(&c.nodes,    a, 0, f->node_count);
+	array_init(&c.groups,   a);
+	array_init(&c.interned, a);
+	array_init(&c.data,     a);
+	map_init(&c.node_map,     a, f->node_count);
+	map_init(&c.group_map,    a);
+	map_init(&c.interned_map, a);
+	defer (array_free(&c.nodes));
+	defer (array_free(&c.groups));
+	defer (array_free(&c.interned));
+	defer (array_free(&c.data));
+	defer (map_destroy(&c.node_map));
+	defer (map_destroy(&c.group_map));
+	defer (map_destroy(&c.interned_map));
+
+	AstCacheHeader h = {};
+	h.magic             = AST_CACHE_MAGIC;
+	h.version           = AST_CACHE_VERSION;
+	h.key               = ast_cache_key(f);
+	h.source_hash       = ast_cache_source_hash(f);
+	h.source_size       = f->tokenizer.end - f->tokenizer.start;
+	h.package_token     = f->package_token;
+	h.package_name      = f->package_name;
+	h.pkg_decl          = f->pkg_decl;
+	h.decls             = f->decls;
+	h.imports           = f->imports;
+	h.line_count        = f->tokenizer.line_count;
+	h.token_count       = f->token_count;
+	h.node_count_parsed = f->node_count;
+	ast_cache_token(&c, &h.package_token);
+	ast_cache_string(&c, &h.package_name);
+	ast_cache_node(&c, &h.pkg_decl);
+	ast_cache_nodes(&c, &h.decls);
+	ast_cache_nodes(&c, &h.imports);
+
+	// NOTE: Visiting a node appends the nodes it refers to which have not been seen yet
+	auto nodes = array_make<Ast>(a, 0, f->node_count);
+	defer (array_free(&nodes));
+	for (isize i = 0; i < c.nodes.count; i++) {
+		Ast n = *c.nodes[i];
+		ast_cache_visit(&c, &n);
+		array_add(&nodes, n);
+	}
+	auto groups = array_make<CommentGroup>(a, 0, c.groups.count);
+	defer (array_free(&groups));
+	for_array(i, c.groups) {
+		CommentGroup g = *c.groups[i];
+		ast_cache_tokens(&c, &g.list);
+		array_add(&groups, g);
+	}
+	auto interned = array_make<String>(a, 0, c.interned.count);
+	defer (array_free(&interned));
+	for_array(i, c.interned) {
+		String s = c.interned[i];
+		s.text = cast(u8 *)(ast_cache__write(&c, s.text, s.len)+1);
+		array_add(&interned, s);
+	}
+	if (!c.ok) {
+		return false;
+	}
+
+	h.node_count     = nodes.count;
+	h.group_count    = groups.count;
+	h.interned_count = interned.count;
+	h.data_size      = c.data.count;
+	h.total_size     = gb_size_of(AstCacheHeader) +
+	                   nodes.count*gb_size_of(Ast) +
+	                   groups.count*gb_size_of(CommentGroup) +
+	                   interned.count*gb_size_of(String) +
+	                   c.data.count;
+
+	// NOTE: Written to a temporary file first so that a build running at the same time
+	// never sees a partially written cache. The name has the process id as well as the file id
+	// as two compilers may write the same file at once.
+	String path = ast_cache_path(a, f);
+	defer (gb_free(a, path.text));
+	char *temp_path = gb_alloc_array(a, char, path.len+64);
+	defer (gb_free(a, temp_path));
+	gb_snprintf(temp_path, path.len+64, "%.*s.%llu.%td.tmp", LIT(path), cast(unsigned long long)ast_cache__process_id(), f->id);
+
+	gbFile file = {};
+	if (gb_file_create(&file, temp_path) != gbFileError_None) {
+		return false;
+	}
+	bool ok = true;
+	ok = ok && gb_file_write(&file, &h, gb_size_of(h));
+	ok = ok && gb_file_write(&file, nodes.data, nodes.count*gb_size_of(Ast));
+	ok = ok && gb_file_write(&file, groups.data, groups.count*gb_size_of(CommentGroup));
+	ok = ok && gb_file_write(&file, interned.data, interned.count*gb_size_of(String));
+	ok = ok && gb_file_write(&file, c.data.data, c.data.count);
+	gb_file_close(&file);
+
+	if (ok) {
+		// NOTE: 'gb_file_move' will not replace an existing file, e.g. one written by a
+		// different build of the compiler
+		char *c_path = alloc_cstring(a, path);
+		defer (gb_free(a, c_path));
+		gb_file_remove(c_path);
+		ok = gb_file_move(temp_path, c_path) != 0;
+	}
+	if (!ok) {
+		gb_file_remove(temp_path);
+	}
+	return ok;
+}
+
+bool ast_cache_load_file(Parser *p, AstFile *f) {
+	gbAllocator a = heap_allocator();
+	String path = ast_cache_path(a, f);
+	defer (gb_free(a, path.text));
+
+	gbFileContents fc = {};
+	isize mapped_size = 0;
+	if (!tokenizer_map_file(path, &fc, &mapped_size)) {
+		mapped_size = 0;
+		char *c_path = alloc_cstring(a, path);
+		defer (gb_free(a, c_path));
+		fc = gb_file_read_contents(a, false, c_path);
+	}
+	if (fc.data == nullptr) {
+		return false;
+	}
+	defer (if (mapped_size > 0) {
+		tokenizer_unmap_file(fc.data, mapped_size);
+	} else {
+		gb_file_free_contents(&fc);
+	});
+
+	if (fc.size < gb_size_of(AstCacheHeader)) {
+		return false;
+	}
+	AstCacheHeader h = *cast(AstCacheHeader *)fc.data;
+	if (h.magic != AST_CACHE_MAGIC ||
+	    h.version != AST_CACHE_VERSION ||
+	    h.total_size != cast(u64)fc.size ||
+	    h.key != ast_cache_key(f) ||
+	    h.source_size != cast(u64)(f->tokenizer.end - f->tokenizer.start) ||
+	    h.source_hash != ast_cache_source_hash(f)) {
+		return false;
+	}
+	u64 size = gb_size_of(AstCacheHeader);
+	size += h.node_count*gb_size_of(Ast);
+	size += h.group_count*gb_size_of(CommentGroup);
+	size += h.interned_count*gb_size_of(String);
+	size += h.data_size;
+	if (size != h.total_size) {
+		return false;
+	}
+
+	u8 *ptr = cast(u8 *)fc.data + gb_size_of(AstCacheHeader);
+	u8 *node_data     = ptr; ptr += h.node_count*gb_size_of(Ast);
+	u8 *group_data    = ptr; ptr += h.group_count*gb_size_of(CommentGroup);
+	u8 *interned_data = ptr; ptr += h.interned_count*gb_size_of(String);
+	u8 *data          = ptr;
+
+	gbAllocator aa = ast_allocator();
+	AstCache c = {};
+	c.mode = AstCache_Load;
+	c.file = f;
+	c.ok   = true;
+	c.loaded_node_count     = cast(isize)h.node_count;
+	c.loaded_group_count    = cast(isize)h.group_count;
+	c.loaded_interned_count = cast(isize)h.interned_count;
+	c.loaded_data_size      = cast(isize)h.data_size;
+	c.loaded_nodes  = gb_alloc_array(aa, Ast, c.loaded_node_count);
+	c.loaded_groups = gb_alloc_array(aa, CommentGroup, c.loaded_group_count);
+	c.loaded_data   = cast(u8 *)gb_alloc(aa, c.loaded_data_size);
+	gb_memmove(c.loaded_nodes,  node_data,  c.loaded_node_count*gb_size_of(Ast));
+	gb_memmove(c.loaded_groups, group_data, c.loaded_group_count*gb_size_of(CommentGroup));
+	gb_memmove(c.loaded_data,   data,       c.loaded_data_size);
+
+	c.loaded_interned = gb_alloc_array(a, String, c.loaded_interned_count);
+	defer (gb_free(a, c.loaded_interned));
+	for (isize i = 0; i < c.loaded_interned_count; i++) {
+		String s = (cast(String *)interned_data)[i];
+		if (!ast_cache__data(&c, cast(uintptr)s.text, s.len, &s.text)) {
+			return false;
+		}
+		c.loaded_interned[i] = string_intern(s);
+	}
+
+	for (isize i = 0; i < c.loaded_node_count; i++) {
+		Ast *n = &c.loaded_nodes[i];
+		if (n->kind <= Ast_Invalid || n->kind >= Ast_COUNT) {
+			return false;
+		}
+		ast_cache_visit(&c, n);
+	}
+	for (isize i = 0; i < c.loaded_group_count; i++) {
+		ast_cache_tokens(&c, &c.loaded_groups[i].list);
+	}
+	ast_cache_token(&c, &h.package_token);
+	ast_cache_string(&c, &h.package_name);
+	ast_cache_node(&c, &h.pkg_decl);
+	ast_cache_nodes(&c, &h.decls);
+	ast_cache_nodes(&c, &h.imports);
+	if (!c.ok) {
+		return false;
+	}
+
+	f->package_token = h.package_token;
+	f->package_name  = h.package_name;
+	f->pkg_decl      = h.pkg_decl;
+	f->decls         = array_make<Ast *>(heap_allocator(), h.decls.count);
+	gb_memmove(f->decls.data, h.decls.data, h.decls.count*gb_size_of(Ast *));
+	for_array(i, h.imports) {
+		array_add(&f->imports, h.imports[i]);
+	}
+	f->tokenizer.line_count = cast(isize)h.line_count;
+	f->token_count          = cast(isize)h.token_count;
+	f->node_count           = cast(isize)h.node_count_parsed;
+	f->is_cached            = true;
+
+	parse_setup_file_decls(p, f, get_file_base_dir(f->tokenizer.fullpath), f->decls);
+	return true;
+}
@@ -0,0 +1,503 @@
+// Micro-benchmarks of parts of the compiler, run with 'odin benchmark <name> [arguments]'
+//
+// They work on the sources as they are on disk, so that the numbers can be compared
+// between builds of the compiler but not between machines.
+
+void benchmark_collect_odin_files(String path, Array<String> *files) {
+	Array<FileInfo> list = {};
+	ReadDirectoryError rd_err = read_directory(path, &list);
+	defer (array_free(&list));
+	if (rd_err != ReadDirectory_None) {
+		return;
+	}
+
+	for_array(i, list) {
+		FileInfo fi = list[i];
+		if (fi.is_dir) {
+			benchmark_collect_odin_files(fi.fullpath, files);
+		} else if (string_ends_with(fi.name, str_lit(".odin"))) {
+			array_add(files, fi.fullpath);
+		}
+	}
+}
+
+f64 benchmark_seconds_since(u64 start) {
+	return cast(f64)(time_stamp_time_now() - start) / cast(f64)time_stamp__freq();
+}
+
+// NOTE: Only the scanning is measured, every file is read (or mapped) beforehand
+// and each iteration restarts its tokenizer from the saved initial state
+int benchmark_tokenizer(String path, isize iterations) {
+	auto files = array_make<String>(heap_allocator(), 0, 256);
+	defer (array_free(&files));
+	benchmark_collect_odin_files(path, &files);
+	if (files.count == 0) {
+		gb_printf_err("No .odin files found in %.*s\n", LIT(path));
+		return 1;
+	}
+
+	auto tokenizers = array_make<Tokenizer>(heap_allocator(), 0, files.count);
+	auto states     = array_make<TokenizerState>(heap_allocator(), 0, files.count);
+	defer (array_free(&tokenizers));
+	defer (array_free(&states));
+
+	i64 bytes = 0;
+	for_array(i, files) {
+		Tokenizer t = {};
+		if (init_tokenizer(&t, files[i]) != TokenizerInit_None) {
+			destroy_tokenizer(&t);
+			continue;
+		}
+		array_add(&tokenizers, t);
+		bytes += t.end - t.start;
+	}
+	for_array(i, tokenizers) {
+		array_add(&states, save_tokenizer_state(&tokenizers[i]));
+	}
+
+	i64 tokens = 0;
+	i64 identifiers = 0;
+	f64 best = 0;
+	for (isize iter = 0; iter < iterations; iter++) {
+		u64 start = time_stamp_time_now();
+		for_array(i, tokenizers) {
+			Tokenizer *t = &tokenizers[i];
+			restore_tokenizer_state(t, &states[i]);
+			for (;;) {
+				Token token = tokenizer_get_token(t);
+				if (iter == 0) {
+					tokens += 1;
+					identifiers += token.kind == Token_Ident;
+				}
+				if (token.kind == Token_EOF || token.kind == Token_Invalid) {
+					break;
+				}
+			}
+		}
+		f64 time = benchmark_seconds_since(start);
+		if (iter == 0 || time < best) {
+			best = time;
+		}
+	}
+
+	for_array(i, tokenizers) {
+		destroy_tokenizer(&tokenizers[i]);
+	}
+
+	gb_printf("Tokenizer benchmark: %.*s\n", LIT(path));
+	gb_printf("Files       - %td\n", tokenizers.count);
+	gb_printf("Bytes       - %lld\n", cast(long long)bytes);
+	gb_printf("Tokens      - %lld\n", cast(long long)tokens);
+	gb_printf("Identifiers - %lld\n", cast(long long)identifiers);
+	gb_printf("Iterations  - %td (best time is used)\n", iterations);
+	gb_printf("Time        - %.3f ms\n", best*1.0e3);
+	gb_printf("MB/s        - %.3f\n", cast(f64)bytes/(1024.0*1024.0)/best);
+	gb_printf("Tokens/s    - %.3f\n", cast(f64)tokens/best);
+	gb_printf("ns/Token    - %.3f\n", 1.0e9*best/cast(f64)tokens);
+	return 0;
+}
+
+// NOTE: The keyword lookup which was used before 'keyword_token_kind', kept to compare against
+TokenKind benchmark_keyword_linear(String const &name) {
+	if (name.len > 1) {
+		for (i32 k = Token__KeywordBegin+1; k < Token__KeywordEnd; k++) {
+			if (name == token_strings[k]) {
+				return cast(TokenKind)k;
+			}
+		}
+	}
+	return Token_Ident;
+}
+
+// NOTE: Every identifier and keyword in the .odin files of the directory, in order
+void benchmark_collect_names(String path, Array<String> *names) {
+	auto files = array_make<String>(heap_allocator(), 0, 256);
+	defer (array_free(&files));
+	benchmark_collect_odin_files(path, &files);
+
+	for_array(i, files) {
+		Tokenizer t = {};
+		if (init_tokenizer(&t, files[i]) == TokenizerInit_None) {
+			for (;;) {
+				Token token = tokenizer_get_token(&t);
+				if (token.kind == Token_Ident || token_is_keyword(token.kind)) {
+					array_add(names, token.string);
+				}
+				if (token.kind == Token_EOF || token.kind == Token_Invalid) {
+					break;
+				}
+			}
+		}
+		// NOTE: The interned strings outlive the tokenizer, so it is not destroyed
+	}
+}
+
+int benchmark_keywords(String path, isize iterations) {
+	auto names = array_make<String>(heap_allocator(), 0, 1<<16);
+	defer (array_free(&names));
+	benchmark_collect_names(path, &names);
+	if (names.count == 0) {
+		gb_printf_err("No identifiers found in %.*s\n", LIT(path));
+		return 1;
+	}
+
+	isize keyword_count = 0;
+	for_array(i, names) {
+		TokenKind a = benchmark_keyword_linear(names[i]);
+		TokenKind b = keyword_token_kind(names[i]);
+		GB_ASSERT_MSG(a == b, "%.*s", LIT(names[i]));
+		keyword_count += a != Token_Ident;
+	}
+
+	f64 best_linear = 0;
+	f64 best_hash = 0;
+	isize found = 0; // NOTE: Checked afterwards so that the loops cannot be removed
+	for (isize iter = 0; iter < iterations; iter++) {
+		u64 start = time_stamp_time_now();
+		for_array(i, names) {
+			found += benchmark_keyword_linear(names[i]) != Token_Ident;
+		}
+		f64 time = benchmark_seconds_since(start);
+		if (iter == 0 || time < best_linear) {
+			best_linear = time;
+		}
+
+		start = time_stamp_time_now();
+		for_array(i, names) {
+			found += keyword_token_kind(names[i]) != Token_Ident;
+		}
+		time = benchmark_seconds_since(start);
+		if (iter == 0 || time < best_hash) {
+			best_hash = time;
+		}
+	}
+
+	GB_ASSERT(found == 2*keyword_count*iterations);
+
+	gb_printf("Keyword benchmark: %.*s\n", LIT(path));
+	gb_printf("Identifiers      - %td (%td keywords)\n", names.count, keyword_count);
+	gb_printf("Iterations       - %td (best time is used)\n", iterations);
+	gb_printf("Linear search    - %.3f ns/identifier\n", 1.0e9*best_linear/cast(f64)names.count);
+	gb_printf("Perfect hash     - %.3f ns/identifier\n", 1.0e9*best_hash/cast(f64)names.count);
+	return 0;
+}
+
+// NOTE: An open addressing index in the style of a "Swiss table", the candidate to replace the
+// chained index of 'Map'. The entries stay dense and in insertion order as in 'Map', and the
+// control byte of every slot is either empty, deleted, or the low 7 bits of the key's hash,
+// probed a group at a time (using SSE2 where available). It is kept here, rather than in
+// 'Map', until it is faster at every size measured below. Only what the benchmark needs is here.
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define BENCHMARK_MAP_USE_SSE2 1
+#else
+#define BENCHMARK_MAP_USE_SSE2 0
+#endif
+
+#define BENCHMARK_MAP_GROUP_WIDTH 16
+#define BENCHMARK_MAP_CTRL_EMPTY  (cast(u8)0x80)
+
+struct BenchmarkOpenMapEntry {
+	HashKey key;
+	isize   value;
+};
+
+struct BenchmarkOpenMap {
+	Array<u8>                    ctrl;       // NOTE: One control byte per slot, a power of two count
+	Array<isize>                 slots;      // NOTE: Index of the entry for each full slot
+	Array<BenchmarkOpenMapEntry> entries;
+};
+
+// NOTE: Pointer and integer keys are used as their own hash, so mix the bits such that both
+// the group index and the control byte depend on all of them
+u64 benchmark_open_map__hash(HashKey const &key) {
+	u64 x = key.key;
+	x ^= x >> 33;
+	x *= 0xff51afd7ed558ccdull;
+	x ^= x >> 33;
+	return x;
+}
+
+u32 benchmark_open_map__group_match(u8 const *group, u8 b) {
+#if BENCHMARK_MAP_USE_SSE2
+	__m128i ctrl = _mm_loadu_si128(cast(__m128i const *)group);
+	return cast(u32)_mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8(cast(char)b)));
+#else
+	u32 mask = 0;
+	for (isize i = 0; i < BENCHMARK_MAP_GROUP_WIDTH; i++) {
+		if (group[i] == b) {
+			mask |= 1u<<i;
+		}
+	}
+	return mask;
+#endif
+}
+
+isize benchmark_open_map__lowest_bit(u32 mask) {
+	GB_ASSERT(mask != 0);
+#if defined(GB_COMPILER_MSVC)
+	unsigned long index = 0;
+	_BitScanForward(&index, mask);
+	return cast(isize)index;
+#else
+	return cast(isize)__builtin_ctz(mask);
+#endif
+}
+
+void benchmark_open_map_init(BenchmarkOpenMap *h, gbAllocator a, isize capacity = 16) {
+	array_init(&h->ctrl,    a);
+	array_init(&h->slots,   a);
+	array_init(&h->entries, a, 0, capacity);
+}
+
+void benchmark_open_map_destroy(BenchmarkOpenMap *h) {
+	array_free(&h->entries);
+	array_free(&h->slots);
+	array_free(&h->ctrl);
+}
+
+isize benchmark_open_map__find(BenchmarkOpenMap *h, HashKey key) {
+	if (h->ctrl.count == 0) {
+		return -1;
+	}
+	u64 hash = benchmark_open_map__hash(key);
+	u8 ctrl_byte = cast(u8)(hash & 0x7f);
+	isize group_mask = h->ctrl.count/BENCHMARK_MAP_GROUP_WIDTH - 1;
+	isize group = cast(isize)(hash >> 7) & group_mask;
+
+	// NOTE: Triangular probing visits every group when the group count is a power of two
+	for (isize step = 1; ; step++) {
+		u8 const *ctrl = h->ctrl.data + group*BENCHMARK_MAP_GROUP_WIDTH;
+		u32 match = benchmark_open_map__group_match(ctrl, ctrl_byte);
+		while (match != 0) {
+			isize index = h->slots[group*BENCHMARK_MAP_GROUP_WIDTH + benchmark_open_map__lowest_bit(match)];
+			if (hash_key_equal(h->entries[index].key, key)) {
+				return index;
+			}
+			match &= match-1;
+		}
+		if (benchmark_open_map__group_match(ctrl, BENCHMARK_MAP_CTRL_EMPTY) != 0) {
+			return -1;
+		}
+		group = (group + step) & group_mask;
+	}
+}
+
+// NOTE: Claims an empty slot for a key which is not yet in the index, there are no deleted
+// slots as nothing is ever removed
+isize benchmark_open_map__claim_slot(BenchmarkOpenMap *h, HashKey key) {
+	u64 hash = benchmark_open_map__hash(key);
+	isize group_mask = h->ctrl.count/BENCHMARK_MAP_GROUP_WIDTH - 1;
+	isize group = cast(isize)(hash >> 7) & group_mask;
+
+	for (isize step = 1; ; step++) {
+		u8 *ctrl = h->ctrl.data + group*BENCHMARK_MAP_GROUP_WIDTH;
+		u32 empty = benchmark_open_map__group_match(ctrl, BENCHMARK_MAP_CTRL_EMPTY);
+		if (empty != 0) {
+			isize i = benchmark_open_map__lowest_bit(empty);
+			ctrl[i] = cast(u8)(hash & 0x7f);
+			return group*BENCHMARK_MAP_GROUP_WIDTH + i;
+		}
+		group = (group + step) & group_mask;
+	}
+}
+
+void benchmark_open_map_rehash(BenchmarkOpenMap *h, isize new_count) {
+	isize min_count = gb_max(new_count, (h->entries.count+1)*8/7 + 1);
+	isize slot_count = BENCHMARK_MAP_GROUP_WIDTH;
+	while (slot_count < min_count) {
+		slot_count <<= 1;
+	}
+
+	array_resize(&h->ctrl,  slot_count);
+	array_resize(&h->slots, slot_count);
+	gb_memset(h->ctrl.data, BENCHMARK_MAP_CTRL_EMPTY, slot_count);
+	for_array(i, h->entries) {
+		isize slot = benchmark_open_map__claim_slot(h, h->entries[i].key);
+		h->slots[slot] = i;
+	}
+}
+
+isize *benchmark_open_map_get(BenchmarkOpenMap *h, HashKey key) {
+	isize index = benchmark_open_map__find(h, key);
+	if (index >= 0) {
+		return &h->entries[index].value;
+	}
+	return nullptr;
+}
+
+void benchmark_open_map_set(BenchmarkOpenMap *h, HashKey key, isize value) {
+	isize index = benchmark_open_map__find(h, key);
+	if (index >= 0) {
+		h->entries[index].value = value;
+		return;
+	}
+	// NOTE: Keep at most 7/8 of the slots full so every probe reaches an empty slot
+	if ((h->entries.count+1)*8 > h->ctrl.count*7) {
+		benchmark_open_map_rehash(h, MAP_ARRAY_GROW_FORMULA(h->entries.count));
+	}
+	BenchmarkOpenMapEntry e = {};
+	e.key = key;
+	e.value = value;
+	array_add(&h->entries, e);
+	isize slot = benchmark_open_map__claim_slot(h, key);
+	h->slots[slot] = h->entries.count-1;
+}
+
+// NOTE: Sets the first 'count' keys, then looks up all '2*count' keys twice, so half of the
+// lookups miss. Returns the number of lookups which hit.
+isize benchmark_map_pass(HashKey const *keys, isize count) {
+	Map<isize> m = {};
+	map_init(&m, heap_allocator());
+	defer (map_destroy(&m));
+	for (isize i = 0; i < count; i++) {
+		map_set(&m, keys[i], i);
+	}
+	isize found = 0;
+	for (isize r = 0; r < 2; r++) {
+		for (isize i = 0; i < 2*count; i++) {
+			found += map_get(&m, keys[i]) != nullptr;
+		}
+	}
+	return found;
+}
+
+isize benchmark_open_map_pass(HashKey const *keys, isize count) {
+	BenchmarkOpenMap m = {};
+	benchmark_open_map_init(&m, heap_allocator());
+	defer (benchmark_open_map_destroy(&m));
+	for (isize i = 0; i < count; i++) {
+		benchmark_open_map_set(&m, keys[i], i);
+	}
+	isize found = 0;
+	for (isize r = 0; r < 2; r++) {
+		for (isize i = 0; i < 2*count; i++) {
+			found += benchmark_open_map_get(&m, keys[i]) != nullptr;
+		}
+	}
+	return found;
+}
+
+// NOTE: Pointer keys are the addresses of the identifiers and string keys are the distinct
+// identifiers themselves, at sizes from those of a small scope to those of the whole program
+int benchmark_map(String path, isize iterations) {
+	auto names = array_make<String>(heap_allocator(), 0, 1<<16);
+	defer (array_free(&names));
+	benchmark_collect_names(path, &names);
+	if (names.count == 0) {
+		gb_printf_err("No identifiers found in %.*s\n", LIT(path));
+		return 1;
+	}
+
+	auto pointer_keys = array_make<HashKey>(heap_allocator(), 0, names.count);
+	auto string_keys  = array_make<HashKey>(heap_allocator(), 0, names.count);
+	defer (array_free(&pointer_keys));
+	defer (array_free(&string_keys));
+	{
+		Map<bool> seen = {};
+		map_init(&seen, heap_allocator());
+		defer (map_destroy(&seen));
+		for_array(i, names) {
+			array_add(&pointer_keys, hash_pointer(&names[i]));
+			HashKey key = hash_string(names[i]);
+			if (map_get(&seen, key) == nullptr) {
+				map_set(&seen, key, true);
+				array_add(&string_keys, key);
+			}
+		}
+	}
+
+	struct KeySet {
+		char const *     name;
+		Array<HashKey> * keys;
+	};
+	KeySet key_sets[] = {
+		{"pointer", &pointer_keys},
+		{"string",  &string_keys},
+	};
+	isize const sizes[] = {16, 64, 256, 1024, 4096, 16384, 65536};
+
+	gb_printf("Map benchmark: %.*s\n", LIT(path));
+	gb_printf("Iterations  - %td (best time is used)\n", iterations);
+	gb_printf("Each pass sets N keys then looks up 2N keys twice, half of which are missing\n");
+	for (isize k = 0; k < gb_count_of(key_sets); k++) {
+		Array<HashKey> keys = *key_sets[k].keys;
+		for (isize s = 0; s < gb_count_of(sizes); s++) {
+			isize count = sizes[s];
+			if (2*count > keys.count) {
+				break;
+			}
+			// NOTE: Small maps are built many times per measurement so the timer resolution does not matter
+			isize repeats = gb_max((1<<18)/count, 1);
+			isize ops = repeats*5*count;
+
+			f64 best_current = 0;
+			f64 best_open = 0;
+			for (isize iter = 0; iter < iterations; iter++) {
+				isize found_current = 0;
+				isize found_open = 0;
+
+				u64 start = time_stamp_time_now();
+				for (isize r = 0; r < repeats; r++) {
+					found_current += benchmark_map_pass(keys.data, count);
+				}
+				f64 time = benchmark_seconds_since(start);
+				if (iter == 0 || time < best_current) {
+					best_current = time;
+				}
+
+				start = time_stamp_time_now();
+				for (isize r = 0; r < repeats; r++) {
+					found_open += benchmark_open_map_pass(keys.data, count);
+				}
+				time = benchmark_seconds_since(start);
+				if (iter == 0 || time < best_open) {
+					best_open = time;
+				}
+
+				GB_ASSERT(found_current == found_open);
+				GB_ASSERT(found_current == repeats*2*count);
+			}
+
+			gb_printf("%s keys, N = %td\n", key_sets[k].name, count);
+			gb_printf("    Current     - %.3f ns/op\n", 1.0e9*best_current/cast(f64)ops);
+			gb_printf("    Open        - %.3f ns/op (%.2fx)\n", 1.0e9*best_open/cast(f64)ops, best_current/best_open);
+		}
+	}
+	return 0;
+}
+
+void benchmark_usage(String argv0) {
+	gb_printf_err("Usage:\n");
+	gb_printf_err("\t%.*s benchmark <name> [directory] [iterations]\n", LIT(argv0));
+	gb_printf_err("Benchmarks:\n");
+	gb_printf_err("\ttokenizer   tokenize every .odin file in the directory (default: core)\n");
+	gb_printf_err("\tkeywords    look up every identifier of the directory as a keyword\n");
+	gb_printf_err("\tmap         compare the hash map with an open addressing candidate, keyed by the identifiers of the directory\n");
+}
+
+int benchmark_main(String argv0, Array<String> args) {
+	if (args.count < 1) {
+		benchmark_usage(argv0);
+		return 1;
+	}
+	String name = args[0];
+	String path = get_fullpath_core(heap_allocator(), str_lit(""));
+	isize iterations = 10;
+	if (args.count >= 2) {
+		path = path_to_full_path(heap_allocator(), args[1]);
+	}
+	if (args.count >= 3) {
+		iterations = cast(isize)gb_max(exact_value_to_i64(exact_value_integer_from_string(args[2])), 1);
+	}
+
+	if (name == "tokenizer") {
+		return benchmark_tokenizer(path, iterations);
+	} else if (name == "keywords") {
+		return benchmark_keywords(path, iterations);
+	} else if (name == "map") {
+		return benchmark_map(path, iterations);
+	}
+	benchmark_usage(argv0);
+	return 1;
+}
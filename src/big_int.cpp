@@ -28,7 +28,7 @@ u64 (__fastcall *unsafe_udiv128)(u64 numhi, u64 numlo, u64 den, u64* rem) = (u64
 #endif
 
 void global_big_int_init(void) {
-	arena_init(&global_big_int_arena, heap_allocator());
+	arena_init(&global_big_int_arena, heap_allocator(), "big int");
 
 #if defined(GB_COMPILER_MSVC) && defined(GB_ARCH_64_BIT)
 	DWORD dummy;
@@ -0,0 +1,459 @@
+// Incremental build cache (-incremental)
+//
+// Next to the output, '<output_base>.odin-cache' records a hash of every package's source
+// files, the hash of each package combined with everything it imports (transitively), and
+// the build settings. When the next build finds all of them unchanged and the object file
+// is still there, type checking and code generation are skipped and the previous object
+// is linked again.
+//
+// NOTE: With a single codegen unit, the whole program is emitted as one LLVM module, so
+// any change upstream of the init package means rebuilding that module. The per package hashes
+// are kept so it is known exactly which packages changed.
+//
+// With more than one codegen unit, each package always goes into the same unit and the hash of
+// the LLVM IR of every unit is recorded as well. A unit whose IR has not changed reuses its
+// previous object file, so a change to the body of a procedure only recompiles the unit of its
+// package (see 'print_llvm_ir'). For that, the members of the module are printed sorted by name
+// and entity ids are kept out of the names (see 'ir_stable_name_id').
+//
+// The settings hash includes the path, size and modification time of the compiler itself, as
+// the output of any two builds of the compiler may differ.
+
+#define BUILD_CACHE_VERSION 2
+
+struct BuildCacheObject {
+	String path;
+	u64    hash;      // NOTE: Of the LLVM IR of the codegen unit, zero until it has been printed
+	u64    prev_hash; // NOTE: Zero if the previous build did not record one
+	bool   reused;
+};
+
+struct BuildCachePackage {
+	AstPackage *pkg;
+	String      path;
+	u64         content_hash; // NOTE: Hash of the package's own files
+	u64         hash;         // NOTE: Hash of the content of the package and all of its imports
+	bool        changed;
+};
+
+struct BuildCache {
+	String                   cache_path;
+	Array<BuildCacheObject>  objects; // NOTE: One per codegen unit
+	u64                      settings_hash;
+	u64                      program_hash;
+	Array<BuildCachePackage> packages;
+	Array<String>            foreign_library_paths; // NOTE: Of the previous build, used when reusing its object
+
+	isize                    changed_count;
+	bool                     is_valid;
+};
+
+gb_global BuildCache *global_build_cache = nullptr; // NOTE: Used by '-show-timings'
+
+
+u64 build_cache__hash(u64 h, void const *data, isize len) {
+	u8 const *bytes = cast(u8 const *)data;
+	for (isize i = 0; i < len; i++) {
+		h = (h ^ cast(u64)bytes[i]) * 0x100000001b3ull;
+	}
+	return h;
+}
+u64 build_cache__hash_string(u64 h, String const &s) {
+	h = build_cache__hash(h, s.text, s.len);
+	return build_cache__hash(h, "", 1); // NOTE: Separator
+}
+u64 build_cache__hash_u64(u64 h, u64 x) {
+	return build_cache__hash(h, &x, gb_size_of(x));
+}
+
+String build_cache__hex(gbAllocator a, u64 x) {
+	char const *digits = "0123456789abcdef";
+	u8 *text = gb_alloc_array(a, u8, 17);
+	for (isize i = 15; i >= 0; i--) {
+		text[i] = digits[x & 0xf];
+		x >>= 4;
+	}
+	text[16] = 0;
+	return make_string(text, 16);
+}
+
+bool build_cache__parse_hex(String s, u64 *x_) {
+	if (s.len != 16) {
+		return false;
+	}
+	u64 x = 0;
+	for (isize i = 0; i < s.len; i++) {
+		u8 c = s[i];
+		u64 d = 0;
+		if ('0' <= c && c <= '9') {
+			d = c - '0';
+		} else if ('a' <= c && c <= 'f') {
+			d = c - 'a' + 10;
+		} else {
+			return false;
+		}
+		x = (x << 4) | d;
+	}
+	*x_ = x;
+	return true;
+}
+
+// NOTE: Empty if the path of the running compiler cannot be found
+String build_cache__compiler_path(gbAllocator a) {
+#if defined(GB_SYSTEM_WINDOWS)
+	wchar_t buf[1024] = {};
+	DWORD len = GetModuleFileNameW(nullptr, buf, gb_count_of(buf));
+	if (len == 0 || len >= gb_count_of(buf)) {
+		return {};
+	}
+	return string16_to_string(a, make_string16(buf, len));
+#elif defined(GB_SYSTEM_OSX)
+	char buf[4096] = {};
+	u32 size = gb_size_of(buf);
+	if (_NSGetExecutablePath(buf, &size) != 0) {
+		return {};
+	}
+	return copy_string(a, make_string_c(buf));
+#else
+	char buf[4096] = {};
+	isize len = readlink("/proc/self/exe", buf, gb_size_of(buf)-1);
+	if (len <= 0) {
+		return {};
+	}
+	return copy_string(a, make_string(cast(u8 *)buf, len));
+#endif
+}
+
+// NOTE: Identifies the build of the compiler without reading all of it
+u64 build_cache__hash_compiler(u64 h) {
+	String path = build_cache__compiler_path(heap_allocator());
+	if (path.len == 0) {
+		return build_cache__hash_string(h, str_lit(__DATE__ " " __TIME__));
+	}
+	defer (gb_free(heap_allocator(), path.text));
+	char *c_path = alloc_cstring(heap_allocator(), path);
+	defer (gb_free(heap_allocator(), c_path));
+
+	h = build_cache__hash_string(h, path);
+	h = build_cache__hash_u64(h, cast(u64)gb_file_last_write_time(c_path));
+	h = build_cache__hash_u64(h, cast(u64)get_file_size(path));
+	return h;
+}
+
+u64 build_cache_settings_hash(void) {
+	BuildContext *bc = &build_context;
+	u64 h = 0xcbf29ce484222325ull;
+	h = build_cache__hash_u64(h, BUILD_CACHE_VERSION);
+	h = build_cache__hash_compiler(h);
+	h = build_cache__hash_string(h, bc->ODIN_VERSION);
+	h = build_cache__hash_string(h, bc->ODIN_ROOT);
+	h = build_cache__hash_string(h, bc->ODIN_OS);
+	h = build_cache__hash_string(h, bc->ODIN_ARCH);
+	h = build_cache__hash_string(h, bc->opt_flags);
+	h = build_cache__hash_string(h, bc->llc_flags);
+	h = build_cache__hash_string(h, cross_compile_target);
+	h = build_cache__hash_u64(h, cast(u64)bc->optimization_level);
+	h = build_cache__hash_u64(h, cast(u64)bc->codegen_units);
+	h = build_cache__hash_u64(h, bc->ODIN_DEBUG);
+	h = build_cache__hash_u64(h, bc->is_dll);
+	h = build_cache__hash_u64(h, bc->no_bounds_check);
+	h = build_cache__hash_u64(h, bc->no_crt);
+	h = build_cache__hash_u64(h, bc->ignore_unknown_attributes);
+	h = build_cache__hash_u64(h, bc->vet);
+	return h;
+}
+
+
+GB_COMPARE_PROC(build_cache__file_cmp) {
+	AstFile *x = *cast(AstFile **)a;
+	AstFile *y = *cast(AstFile **)b;
+	return string_compare(x->fullpath, y->fullpath);
+}
+
+GB_COMPARE_PROC(build_cache__package_cmp) {
+	BuildCachePackage *x = cast(BuildCachePackage *)a;
+	BuildCachePackage *y = cast(BuildCachePackage *)b;
+	return string_compare(x->path, y->path);
+}
+
+u64 build_cache_package_content_hash(AstPackage *pkg) {
+	// NOTE: Files are parsed in any order when multithreaded, so sort them
+	auto files = array_make<AstFile *>(heap_allocator(), pkg->files.count);
+	defer (array_free(&files));
+	for_array(i, pkg->files) {
+		files[i] = pkg->files[i];
+	}
+	gb_sort_array(files.data, files.count, build_cache__file_cmp);
+
+	u64 h = 0xcbf29ce484222325ull;
+	h = build_cache__hash_string(h, pkg->fullpath);
+	for_array(i, files) {
+		AstFile *f = files[i];
+		Tokenizer *t = &f->tokenizer;
+		h = build_cache__hash_string(h, f->fullpath);
+		h = build_cache__hash_u64(h, cast(u64)(t->end - t->start));
+		h = build_cache__hash(h, t->start, t->end - t->start);
+	}
+	return h;
+}
+
+void build_cache__collect_imports(BuildCache *bc, Map<isize> *index_map, isize index, bool *visited) {
+	if (visited[index]) {
+		return;
+	}
+	visited[index] = true;
+
+	AstPackage *pkg = bc->packages[index].pkg;
+	for_array(i, pkg->files) {
+		AstFile *f = pkg->files[i];
+		for_array(j, f->imports) {
+			Ast *node = f->imports[j];
+			if (node->kind != Ast_ImportDecl) {
+				continue;
+			}
+			isize *found = map_get(index_map, hash_string(node->ImportDecl.fullpath));
+			if (found != nullptr) {
+				build_cache__collect_imports(bc, index_map, *found, visited);
+			}
+		}
+	}
+}
+
+void build_cache_init(BuildCache *bc, Parser *p, String output_base) {
+	gbAllocator a = heap_allocator();
+	bc->cache_path = concatenate_strings(a, output_base, str_lit(".odin-cache"));
+	array_init(&bc->objects, a, 0, build_context.codegen_units);
+	for (isize i = 0; i < build_context.codegen_units; i++) {
+		String base = ir_codegen_unit_output_base(output_base, i);
+		BuildCacheObject object = {};
+	#if defined(GB_SYSTEM_WINDOWS)
+		object.path = concatenate_strings(a, base, str_lit(".obj"));
+	#else
+		object.path = concatenate_strings(a, base, str_lit(".o"));
+	#endif
+		array_add(&bc->objects, object);
+	}
+	bc->settings_hash = build_cache_settings_hash();
+	array_init(&bc->foreign_library_paths, a);
+
+	array_init(&bc->packages, a, 0, p->packages.count);
+	for_array(i, p->packages) {
+		AstPackage *pkg = p->packages[i];
+		BuildCachePackage cp = {};
+		cp.pkg          = pkg;
+		cp.path         = pkg->fullpath;
+		cp.content_hash = build_cache_package_content_hash(pkg);
+		array_add(&bc->packages, cp);
+	}
+	gb_sort_array(bc->packages.data, bc->packages.count, build_cache__package_cmp);
+
+	Map<isize> index_map = {};
+	map_init(&index_map, a, bc->packages.count);
+	defer (map_destroy(&index_map));
+	for_array(i, bc->packages) {
+		map_set(&index_map, hash_string(bc->packages[i].path), i);
+	}
+
+	auto visited = array_make<bool>(a, bc->packages.count);
+	defer (array_free(&visited));
+
+	u64 program_hash = build_cache__hash_u64(0xcbf29ce484222325ull, bc->settings_hash);
+	for_array(i, bc->packages) {
+		BuildCachePackage *cp = &bc->packages[i];
+
+		gb_zero_size(visited.data, visited.count*gb_size_of(bool));
+		build_cache__collect_imports(bc, &index_map, i, visited.data);
+
+		u64 h = build_cache__hash_u64(0xcbf29ce484222325ull, cp->content_hash);
+		for_array(j, bc->packages) {
+			if (visited[j] && j != i) {
+				h = build_cache__hash_u64(h, bc->packages[j].content_hash);
+			}
+		}
+		cp->hash = h;
+
+		program_hash = build_cache__hash_string(program_hash, cp->path);
+		program_hash = build_cache__hash_u64(program_hash, cp->hash);
+	}
+	bc->program_hash = program_hash;
+}
+
+// NOTE: Compares against the cache file of the previous build and marks the packages
+// which changed. Returns true if the previous object file can be reused.
+bool build_cache_load(BuildCache *bc) {
+	bc->is_valid = false;
+	bc->changed_count = bc->packages.count;
+	for_array(i, bc->packages) {
+		bc->packages[i].changed = true;
+	}
+
+	char *cache_path = alloc_cstring(heap_allocator(), bc->cache_path);
+	defer (gb_free(heap_allocator(), cache_path));
+
+	gbFileContents fc = gb_file_read_contents(heap_allocator(), true, cache_path);
+	if (fc.data == nullptr) {
+		return false;
+	}
+	defer (gb_file_free_contents(&fc));
+
+	Map<u64> previous = {}; // NOTE: Package path -> hash
+	map_init(&previous, heap_allocator());
+	defer (map_destroy(&previous));
+
+	bool header_ok = false;
+	u64 settings_hash = 0;
+	u64 program_hash = 0;
+
+	String contents = make_string(cast(u8 *)fc.data, fc.size);
+	while (contents.len > 0) {
+		isize end = 0;
+		while (end < contents.len && contents[end] != '\n') {
+			end++;
+		}
+		String line = substring(contents, 0, end);
+		contents = substring(contents, gb_min(end+1, contents.len), contents.len);
+
+		isize space = 0;
+		while (space < line.len && line[space] != ' ') {
+			space++;
+		}
+		String kind = substring(line, 0, space);
+		String rest = substring(line, gb_min(space+1, line.len), line.len);
+
+		if (kind == "odin-build-cache") {
+			header_ok = rest == "2";
+		} else if (kind == "settings") {
+			build_cache__parse_hex(rest, &settings_hash);
+		} else if (kind == "program") {
+			build_cache__parse_hex(rest, &program_hash);
+		} else if (kind == "package" && rest.len > 17) {
+			u64 hash = 0;
+			if (build_cache__parse_hex(substring(rest, 0, 16), &hash)) {
+				String path = substring(rest, 17, rest.len);
+				map_set(&previous, hash_string(path), hash);
+			}
+		} else if (kind == "object" && rest.len > 17) {
+			u64 hash = 0;
+			isize index = cast(isize)u64_from_string(substring(rest, 17, rest.len));
+			if (build_cache__parse_hex(substring(rest, 0, 16), &hash) && 0 <= index && index < bc->objects.count) {
+				bc->objects[index].prev_hash = hash;
+			}
+		} else if (kind == "library" && rest.len > 0) {
+			array_add(&bc->foreign_library_paths, copy_string(heap_allocator(), rest));
+		}
+	}
+
+	if (!header_ok || settings_hash != bc->settings_hash) {
+		// NOTE: Everything is considered changed
+		for_array(i, bc->objects) {
+			bc->objects[i].prev_hash = 0;
+		}
+		return false;
+	}
+
+	bc->changed_count = 0;
+	for_array(i, bc->packages) {
+		BuildCachePackage *cp = &bc->packages[i];
+		u64 *found = map_get(&previous, hash_string(cp->path));
+		cp->changed = found == nullptr || *found != cp->hash;
+		if (cp->changed) {
+			bc->changed_count += 1;
+		}
+	}
+
+	bc->is_valid = program_hash == bc->program_hash &&
+	               previous.entries.count == bc->packages.count;
+	for_array(i, bc->objects) {
+		// NOTE: 'concatenate_strings' null terminates
+		if (!gb_file_exists(cast(char *)bc->objects[i].path.text)) {
+			bc->is_valid = false;
+		}
+	}
+	return bc->is_valid;
+}
+
+// NOTE: Called before any object file is written, as an object which no longer matches the
+// hash recorded for it must never be reused should this build fail
+void build_cache_begin_codegen(BuildCache *bc) {
+	char *cache_path = alloc_cstring(heap_allocator(), bc->cache_path);
+	defer (gb_free(heap_allocator(), cache_path));
+	gb_file_remove(cache_path);
+}
+
+// NOTE: Called by the codegen unit once its LLVM IR has been printed, possibly on another thread.
+// Returns true if the previous object file of the unit can be used instead of compiling it.
+bool build_cache_reuse_object(isize unit_index, u64 ir_hash) {
+	BuildCache *bc = global_build_cache;
+	if (bc == nullptr) {
+		return false;
+	}
+	BuildCacheObject *object = &bc->objects[unit_index];
+	object->hash = ir_hash;
+	object->reused = ir_hash != 0 && ir_hash == object->prev_hash &&
+	                 gb_file_exists(cast(char *)object->path.text);
+	return object->reused;
+}
+
+bool build_cache_object_is_reused(BuildCache *bc, isize unit_index) {
+	return bc != nullptr && bc->objects[unit_index].reused;
+}
+
+// NOTE: Must only be called once the object file has been successfully generated
+void build_cache_save(BuildCache *bc, Array<String> const &foreign_library_paths) {
+	char *cache_path = alloc_cstring(heap_allocator(), bc->cache_path);
+	defer (gb_free(heap_allocator(), cache_path));
+
+	gbFile f = {};
+	if (gb_file_create(&f, cache_path) != gbFileError_None) {
+		return;
+	}
+	defer (gb_file_close(&f));
+
+	gbAllocator a = heap_allocator();
+	String settings = build_cache__hex(a, bc->settings_hash);
+	String program  = build_cache__hex(a, bc->program_hash);
+	defer (gb_free(a, settings.text));
+	defer (gb_free(a, program.text));
+
+	gb_fprintf(&f, "odin-build-cache %d\n", BUILD_CACHE_VERSION);
+	gb_fprintf(&f, "settings %.*s\n", LIT(settings));
+	gb_fprintf(&f, "program %.*s\n", LIT(program));
+	for_array(i, bc->objects) {
+		BuildCacheObject *object = &bc->objects[i];
+		if (object->hash != 0) {
+			String hash = build_cache__hex(a, object->hash);
+			gb_fprintf(&f, "object %.*s %td\n", LIT(hash), i);
+			gb_free(a, hash.text);
+		}
+	}
+	for_array(i, bc->packages) {
+		BuildCachePackage *cp = &bc->packages[i];
+		String hash = build_cache__hex(a, cp->hash);
+		gb_fprintf(&f, "package %.*s %.*s\n", LIT(hash), LIT(cp->path));
+		gb_free(a, hash.text);
+	}
+	for_array(i, foreign_library_paths) {
+		gb_fprintf(&f, "library %.*s\n", LIT(foreign_library_paths[i]));
+	}
+}
+
+void build_cache_print_stats(BuildCache *bc) {
+	gb_printf("Build cache\n");
+	gb_printf("Packages     - %td\n", bc->packages.count);
+	gb_printf("Changed      - %td\n", bc->changed_count);
+	gb_printf("Reused       - %s\n", bc->is_valid ? "true" : "false");
+	if (!bc->is_valid && bc->objects.count > 1) {
+		isize reused = 0;
+		for_array(i, bc->objects) {
+			reused += bc->objects[i].reused;
+		}
+		gb_printf("Objects      - %td of %td reused\n", reused, bc->objects.count);
+	}
+	for_array(i, bc->packages) {
+		BuildCachePackage *cp = &bc->packages[i];
+		if (cp->changed) {
+			gb_printf("\t%.*s\n", LIT(cp->path));
+		}
+	}
+	gb_printf("\n");
+}
@@ -100,7 +100,11 @@ struct BuildContext {
 	bool   generate_docs;
 	i32    optimization_level;
 	bool   show_timings;
+	bool   show_timings_json; // NOTE: Chrome trace events written to '<output>.timings.json'
 	bool   keep_temp_files;
+	bool   incremental;
+	bool   ast_cache;
+	bool   llvm_api; // NOTE: See llvm_api.cpp
 	bool   ignore_unknown_attributes;
 	bool   no_bounds_check;
 	bool   no_output_files;
@@ -110,6 +114,7 @@ struct BuildContext {
 
 	gbAffinity affinity;
 	isize      thread_count;
+	isize      codegen_units; // NOTE: Number of LLVM modules the program is split into
 };
 
 
@@ -503,6 +508,11 @@ void init_build_context(void) {
 	if (bc->thread_count == 0) {
 		bc->thread_count = gb_max(bc->affinity.thread_count, 1);
 	}
+	bc->codegen_units = gb_clamp(bc->codegen_units, 1, 256);
+	if (bc->ODIN_DEBUG) {
+		// NOTE: The debug information is only emitted for a single compile unit
+		bc->codegen_units = 1;
+	}
 
 	bc->ODIN_VENDOR  = str_lit("odin");
 	bc->ODIN_VERSION = ODIN_VERSION;
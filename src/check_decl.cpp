@@ -287,7 +287,7 @@ void check_type_decl(CheckerContext *ctx, Entity *e, Ast *type_expr, Type *def)
 					if (is_blank_ident(name)) {
 						continue;
 					}
-					add_entity(ctx->checker, parent, nullptr, f);
+					add_entity(ctx, parent, nullptr, f);
 				}
 			}
 		}
@@ -313,7 +313,14 @@ void override_entity_in_scope(Entity *original_entity, Entity *new_entity) {
 
 	// GB_ASSERT_MSG(found_entity == original_entity, "%.*s == %.*s", LIT(found_entity->token.string), LIT(new_entity->token.string));
 
+	bool lock = scope_needs_lock(found_scope);
+	if (lock) {
+		gb_mutex_lock(&global_scope_mutex);
+	}
 	map_set(&found_scope->elements, hash_string(original_name), new_entity);
+	if (lock) {
+		gb_mutex_unlock(&global_scope_mutex);
+	}
 }
 
 
@@ -613,7 +620,7 @@ void check_proc_decl(CheckerContext *ctx, Entity *e, DeclInfo *d) {
 
 		GB_ASSERT(pl->body->kind == Ast_BlockStmt);
 		if (!pt->is_polymorphic) {
-			check_procedure_later(ctx->checker, ctx->file, e->token, d, proc_type, pl->body, pl->tags);
+			check_procedure_later(ctx, ctx->file, e->token, d, proc_type, pl->body, pl->tags);
 		}
 	} else if (!is_foreign) {
 		if (e->Procedure.is_export) {
@@ -635,7 +642,9 @@ void check_proc_decl(CheckerContext *ctx, Entity *e, DeclInfo *d) {
 
 	if (ac.deferred_procedure.entity != nullptr) {
 		e->Procedure.deferred_procedure = ac.deferred_procedure;
+		gb_mutex_lock(&ctx->info->entity_mutex);
 		array_add(&ctx->checker->procs_with_deferred_to_check, e);
+		gb_mutex_unlock(&ctx->info->entity_mutex);
 	}
 
 	if (is_foreign) {
@@ -649,6 +658,8 @@ void check_proc_decl(CheckerContext *ctx, Entity *e, DeclInfo *d) {
 		init_entity_foreign_library(ctx, e);
 
 		auto *fp = &ctx->info->foreigns;
+		gb_mutex_lock(&ctx->info->entity_mutex);
+		defer (gb_mutex_unlock(&ctx->info->entity_mutex));
 		HashKey key = hash_string(name);
 		Entity **found = map_get(fp, key);
 		if (found) {
@@ -681,6 +692,8 @@ void check_proc_decl(CheckerContext *ctx, Entity *e, DeclInfo *d) {
 		}
 		if (e->Procedure.link_name.len > 0 || is_export) {
 			auto *fp = &ctx->info->foreigns;
+			gb_mutex_lock(&ctx->info->entity_mutex);
+			defer (gb_mutex_unlock(&ctx->info->entity_mutex));
 			HashKey key = hash_string(name);
 			Entity **found = map_get(fp, key);
 			if (found) {
@@ -758,6 +771,8 @@ void check_var_decl(CheckerContext *ctx, Entity *e, Ast *type_expr, Ast *init_ex
 		}
 
 		auto *fp = &ctx->info->foreigns;
+		gb_mutex_lock(&ctx->info->entity_mutex);
+		defer (gb_mutex_unlock(&ctx->info->entity_mutex));
 		HashKey key = hash_string(name);
 		Entity **found = map_get(fp, key);
 		if (found) {
@@ -894,7 +909,7 @@ void check_proc_group_decl(CheckerContext *ctx, Entity *pg_entity, DeclInfo *d)
 			}
 
 			if (is_invalid) {
-				gb_printf_err("\tprevious procedure at %.*s(%td:%td)\n", LIT(pos.file), pos.line, pos.column);
+				error_line("\tprevious procedure at %.*s(%td:%td)\n", LIT(pos.file), pos.line, pos.column);
 				q->type = t_invalid;
 			}
 		}
@@ -903,9 +918,30 @@ void check_proc_group_decl(CheckerContext *ctx, Entity *pg_entity, DeclInfo *d)
 }
 
 void check_entity_decl(CheckerContext *ctx, Entity *e, DeclInfo *d, Type *named_type) {
+	// NOTE: Global declarations may be reached from procedure bodies which
+	// are being checked in parallel
+	bool is_global = e->scope != nullptr && (e->scope->flags & (ScopeFlag_File|ScopeFlag_Pkg)) != 0;
+	if (e->state == EntityState_Resolved)  {
+		if (is_global) {
+			checker_shared_reached(e);
+		}
+		return;
+	}
+
+	if (is_global) {
+		gb_mutex_lock(&ctx->info->global_mutex);
+	}
+	defer (if (is_global) {
+		gb_mutex_unlock(&ctx->info->global_mutex);
+	});
 	if (e->state == EntityState_Resolved)  {
+		checker_shared_reached(e);
 		return;
 	}
+	// NOTE: Checking a global declaration is recorded apart from the procedure body which
+	// reached it first, as any other body which needs it will share it
+	CheckerShared *shared = is_global ? checker_shared_begin() : nullptr;
+	defer (checker_shared_end(shared, e));
 	String name = e->token.string;
 
 	if (e->type != nullptr || e->state != EntityState_Unresolved) {
@@ -1057,17 +1093,8 @@ void check_proc_body(CheckerContext *ctx_, Token token, DeclInfo *decl, Type *ty
 
 	check_scope_usage(ctx->checker, ctx->scope);
 
-	if (decl->parent != nullptr) {
-		// NOTE(bill): Add the dependencies from the procedure literal (lambda)
-		for_array(i, decl->deps.entries) {
-			Entity *e = decl->deps.entries[i].ptr;
-			ptr_set_add(&decl->parent->deps, e);
-		}
-		for_array(i, decl->type_info_deps.entries) {
-			Type *t = decl->type_info_deps.entries[i].ptr;
-			ptr_set_add(&decl->parent->type_info_deps, t);
-		}
-	}
+	// NOTE: The dependencies of a procedure literal (lambda) are added to its parent's when
+	// the body is merged, see 'check_procedure_bodies'
 }
 
 
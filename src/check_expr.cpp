@@ -230,6 +230,11 @@ bool find_or_generate_polymorphic_procedure(CheckerContext *c, Entity *base_enti
 		return false;
 	}
 
+	// NOTE: Finding and generating the specialization must be atomic with
+	// respect to other procedure bodies being checked at the same time
+	gb_mutex_lock(&c->info->global_mutex);
+	defer (gb_mutex_unlock(&c->info->global_mutex));
+
 
 
 	gbAllocator a = heap_allocator();
@@ -273,7 +278,9 @@ bool find_or_generate_polymorphic_procedure(CheckerContext *c, Entity *base_enti
 	// NOTE(bill): This is slightly memory leaking if the type already exists
 	// Maybe it's better to check with the previous types first?
 	Type *final_proc_type = alloc_type_proc(scope, nullptr, 0, nullptr, 0, false, pt->calling_convention);
-	bool success = check_procedure_type(&nctx, final_proc_type, pt->node, &operands);
+	// NOTE: Checked on a clone so that each body which gets here makes the same definitions,
+	// rather than only the first one to set the identifiers of the original procedure type
+	bool success = check_procedure_type(&nctx, final_proc_type, clone_ast(pt->node), &operands);
 
 	if (!success) {
 		return false;
@@ -286,6 +293,11 @@ bool find_or_generate_polymorphic_procedure(CheckerContext *c, Entity *base_enti
 			Entity *other = procs[i];
 			Type *pt = base_type(other->type);
 			if (are_types_identical(pt, final_proc_type)) {
+				if (checker_shared_find(other) != nullptr) {
+					// NOTE: Generated by another body of the same wave, so only use it once the
+					// type has been generated again below, as the body which generated it did
+					break;
+				}
 				if (poly_proc_data) {
 					poly_proc_data->gen_entity = other;
 				}
@@ -322,6 +334,7 @@ bool find_or_generate_polymorphic_procedure(CheckerContext *c, Entity *base_enti
 				Entity *other = procs[i];
 				Type *pt = base_type(other->type);
 				if (are_types_identical(pt, final_proc_type)) {
+					checker_shared_reached(other);
 					if (poly_proc_data) {
 						poly_proc_data->gen_entity = other;
 					}
@@ -333,6 +346,12 @@ bool find_or_generate_polymorphic_procedure(CheckerContext *c, Entity *base_enti
 
 
 
+	// NOTE: Generating the specialization is recorded apart from the procedure body being
+	// checked, as any other body which needs it will share it
+	CheckerShared *shared = checker_shared_begin();
+	Entity *shared_entity = nullptr;
+	defer (checker_shared_end(shared, shared_entity));
+
 	Ast *proc_lit = clone_ast(old_decl->proc_lit);
 	ast_node(pl, ProcLit, proc_lit);
 	// NOTE(bill): Associate the scope declared above withinth this procedure declaration's type
@@ -361,6 +380,7 @@ bool find_or_generate_polymorphic_procedure(CheckerContext *c, Entity *base_enti
 
 	Entity *entity = alloc_entity_procedure(nullptr, token, final_proc_type, tags);
 	entity->identifier = ident;
+	shared_entity = entity;
 
 	add_entity_and_decl_info(&nctx, ident, entity, d);
 	// NOTE(bill): Set the scope afterwards as this is not real overloading
@@ -402,7 +422,7 @@ bool find_or_generate_polymorphic_procedure(CheckerContext *c, Entity *base_enti
 	}
 
 	// NOTE(bill): Check the newly generated procedure body
-	check_procedure_later(nctx.checker, proc_info);
+	check_procedure_later(&nctx, proc_info);
 
 	return true;
 }
@@ -1777,7 +1797,7 @@ void check_shift(CheckerContext *c, Operand *x, Operand *y, Ast *node) {
 
 		TokenPos pos = ast_token(x->expr).pos;
 		if (x_is_untyped) {
-			ExprInfo *info = check_get_expr_info(&c->checker->info, x->expr);
+			ExprInfo *info = check_get_expr_info(c, x->expr);
 			if (info != nullptr) {
 				info->is_lhs = true;
 			}
@@ -2380,7 +2400,7 @@ void check_binary_expr(CheckerContext *c, Operand *x, Ast *node, bool use_lhs_as
 
 
 void update_expr_type(CheckerContext *c, Ast *e, Type *type, bool final) {
-	ExprInfo *found = check_get_expr_info(&c->checker->info, e);
+	ExprInfo *found = check_get_expr_info(c, e);
 	if (found == nullptr) {
 		return;
 	}
@@ -2419,12 +2439,12 @@ void update_expr_type(CheckerContext *c, Ast *e, Type *type, bool final) {
 
 	if (!final && is_type_untyped(type)) {
 		old.type = base_type(type);
-		check_set_expr_info(&c->checker->info, e, old);
+		check_set_expr_info(c, e, old);
 		return;
 	}
 
 	// We need to remove it and then give it a new one
-	check_remove_expr_info(&c->checker->info, e);
+	check_remove_expr_info(c, e);
 
 	if (old.is_lhs && !is_type_integer(type)) {
 		gbString expr_str = expr_to_string(e);
@@ -2439,7 +2459,7 @@ void update_expr_type(CheckerContext *c, Ast *e, Type *type, bool final) {
 }
 
 void update_expr_value(CheckerContext *c, Ast *e, ExactValue value) {
-	ExprInfo *found = check_get_expr_info(&c->checker->info, e);
+	ExprInfo *found = check_get_expr_info(c, e);
 	if (found) {
 		found->value = value;
 	}
@@ -2618,21 +2638,21 @@ void convert_to_typed(CheckerContext *c, Operand *operand, Type *target_type) {
 				operand->mode = Addressing_Invalid;
 				convert_untyped_error(c, operand, target_type);
 
-				gb_printf_err("Ambiguous type conversion to '%s', which variant did you mean:\n\t", type_str);
+				error_line("Ambiguous type conversion to '%s', which variant did you mean:\n\t", type_str);
 				i32 j = 0;
 				for (i32 i = 0; i < valid_count; i++) {
 					ValidIndexAndScore valid = valids[i];
-					if (j > 0 && valid_count > 2) gb_printf_err(", ");
+					if (j > 0 && valid_count > 2) error_line(", ");
 					if (j == valid_count-1) {
-						if (valid_count == 2) gb_printf_err(" ");
-						gb_printf_err("or ");
+						if (valid_count == 2) error_line(" ");
+						error_line("or ");
 					}
 					gbString str = type_to_string(t->Union.variants[valid.index]);
-					gb_printf_err("'%s'", str);
+					error_line("'%s'", str);
 					gb_string_free(str);
 					j++;
 				}
-				gb_printf_err("\n\n");
+				error_line("\n\n");
 
 				return;
 			} else if (is_type_untyped_undef(operand->type) && type_has_undef(target_type)) {
@@ -2641,20 +2661,20 @@ void convert_to_typed(CheckerContext *c, Operand *operand, Type *target_type) {
 				operand->mode = Addressing_Invalid;
 				convert_untyped_error(c, operand, target_type);
 				if (count > 0) {
-					gb_printf_err("'%s' is a union which only excepts the following types:\n", type_str);
-					gb_printf_err("\t");
+					error_line("'%s' is a union which only excepts the following types:\n", type_str);
+					error_line("\t");
 					for (i32 i = 0; i < count; i++) {
 						Type *v = t->Union.variants[i];
-						if (i > 0 && count > 2) gb_printf_err(", ");
+						if (i > 0 && count > 2) error_line(", ");
 						if (i == count-1) {
-							if (count == 2) gb_printf_err(" ");
-							gb_printf_err("or ");
+							if (count == 2) error_line(" ");
+							error_line("or ");
 						}
 						gbString str = type_to_string(v);
-						gb_printf_err("'%s'", str);
+						error_line("'%s'", str);
 						gb_string_free(str);
 					}
-					gb_printf_err("\n\n");
+					error_line("\n\n");
 
 				}
 				return;
@@ -4859,18 +4879,18 @@ CallArgumentData check_call_arguments(CheckerContext *c, Operand *operand, Type
 			}
 			if (!all_invalid_type) {
 				error(operand->expr, "No procedures or ambiguous call for procedure group '%s' that match with the given arguments", expr_name);
-				gb_printf_err("\tGiven argument types: (");
+				error_line("\tGiven argument types: (");
 				for_array(i, operands) {
 					Operand o = operands[i];
-					if (i > 0) gb_printf_err(", ");
+					if (i > 0) error_line(", ");
 					gbString type = type_to_string(o.type);
 					defer (gb_string_free(type));
-					gb_printf_err("%s", type);
+					error_line("%s", type);
 				}
-				gb_printf_err(")\n");
+				error_line(")\n");
 
 				if (procs.count > 0) {
-					gb_printf_err("Did you mean to use one of the following:\n");
+					error_line("Did you mean to use one of the following:\n");
 				}
 				for_array(i, procs) {
 					Entity *proc = procs[i];
@@ -4898,24 +4918,24 @@ CallArgumentData check_call_arguments(CheckerContext *c, Operand *operand, Type
 						sep = ":=";
 					}
 					// gb_printf_err("\t%.*s %s %s at %.*s(%td:%td) with score %lld\n", LIT(name), sep, pt, LIT(pos.file), pos.line, pos.column, cast(long long)valids[i].score);
-					gb_printf_err("\t%.*s%.*s%.*s %s %s at %.*s(%td:%td)\n", LIT(prefix), LIT(prefix_sep), LIT(name), sep, pt, LIT(pos.file), pos.line, pos.column);
+					error_line("\t%.*s%.*s%.*s %s %s at %.*s(%td:%td)\n", LIT(prefix), LIT(prefix_sep), LIT(name), sep, pt, LIT(pos.file), pos.line, pos.column);
 				}
 				if (procs.count > 0) {
-					gb_printf_err("\n");
+					error_line("\n");
 				}
 			}
 			result_type = t_invalid;
 		} else if (valid_count > 1) {
 			error(operand->expr, "Ambiguous procedure group call '%s' that match with the given arguments", expr_name);
-			gb_printf_err("\tGiven argument types: (");
+			error_line("\tGiven argument types: (");
 			for_array(i, operands) {
 				Operand o = operands[i];
-				if (i > 0) gb_printf_err(", ");
+				if (i > 0) error_line(", ");
 				gbString type = type_to_string(o.type);
 				defer (gb_string_free(type));
-				gb_printf_err("%s", type);
+				error_line("%s", type);
 			}
-			gb_printf_err(")\n");
+			error_line(")\n");
 
 			for (isize i = 0; i < valid_count; i++) {
 				Entity *proc = procs[valids[i].index];
@@ -4933,7 +4953,7 @@ CallArgumentData check_call_arguments(CheckerContext *c, Operand *operand, Type
 				if (proc->kind == Entity_Variable) {
 					sep = ":=";
 				}
-				gb_printf_err("\t%.*s %s %s at %.*s(%td:%td)\n", LIT(name), sep, pt, LIT(pos.file), pos.line, pos.column);
+				error_line("\t%.*s %s %s at %.*s(%td:%td)\n", LIT(name), sep, pt, LIT(pos.file), pos.line, pos.column);
 				// gb_printf_err("\t%.*s %s %s at %.*s(%td:%td) %lld\n", LIT(name), sep, pt, LIT(pos.file), pos.line, pos.column, valids[i].score);
 			}
 			result_type = t_invalid;
@@ -5006,6 +5026,9 @@ CallArgumentError check_polymorphic_record_type(CheckerContext *c, Operand *oper
 	Type *original_type = operand->type;
 	GB_ASSERT(is_type_polymorphic_record(original_type));
 
+	gb_mutex_lock(&c->info->global_mutex);
+	defer (gb_mutex_unlock(&c->info->global_mutex));
+
 	bool show_error = true;
 
 	Array<Operand> operands = {};
@@ -5165,11 +5188,18 @@ CallArgumentError check_polymorphic_record_type(CheckerContext *c, Operand *oper
 
 		Entity *found_entity = find_polymorphic_record_entity(c, original_type, param_count, ordered_operands);
 		if (found_entity) {
+			checker_shared_reached(found_entity);
 			operand->mode = Addressing_Type;
 			operand->type = found_entity->type;
 			return err;
 		}
 
+		// NOTE: Generating the record is recorded apart from the procedure body being checked,
+		// as any other body which needs it will share it
+		CheckerShared *shared = checker_shared_begin();
+		Type *named_type = nullptr;
+		defer (checker_shared_end(shared, named_type != nullptr ? named_type->Named.type_name : nullptr));
+
 		String generated_name = make_string_c(expr_to_string(call));
 
 		CheckerContext ctx = *c;
@@ -5177,7 +5207,7 @@ CallArgumentError check_polymorphic_record_type(CheckerContext *c, Operand *oper
 		ctx.scope = polymorphic_record_parent_scope(original_type);
 		GB_ASSERT(ctx.scope != nullptr);
 
-		Type *named_type = alloc_type_named(generated_name, nullptr, nullptr);
+		named_type = alloc_type_named(generated_name, nullptr, nullptr);
 		Type *bt = base_type(original_type);
 		if (bt->kind == Type_Struct) {
 			Ast *node = clone_ast(bt->Struct.node);
@@ -5648,7 +5678,7 @@ ExprKind check_expr_base_internal(CheckerContext *c, Operand *o, Ast *node, Type
 				return kind;
 			}
 
-			check_procedure_later(ctx.checker, ctx.file, empty_token, decl, type, pl->body, pl->tags);
+			check_procedure_later(&ctx, ctx.file, empty_token, decl, type, pl->body, pl->tags);
 		}
 		check_close_scope(&ctx);
 
@@ -6573,7 +6603,7 @@ ExprKind check_expr_base(CheckerContext *c, Operand *o, Ast *node, Type *type_hi
 	}
 
 	if (type != nullptr && is_type_untyped(type)) {
-		add_untyped(&c->checker->info, node, false, o->mode, type, value);
+		add_untyped(c, node, false, o->mode, type, value);
 	} else {
 		add_type_and_value(&c->checker->info, node, o->mode, type, value);
 	}
@@ -429,7 +429,7 @@ void check_label(CheckerContext *ctx, Ast *label, Ast *parent) {
 	}
 
 	Entity *e = alloc_entity_label(ctx->scope, l->name->Ident.token, t_invalid, label, parent);
-	add_entity(ctx->checker, ctx->scope, l->name, e);
+	add_entity(ctx, ctx->scope, l->name, e);
 	e->parent_proc_decl = ctx->curr_proc_decl;
 
 	if (ok) {
@@ -629,6 +629,10 @@ void check_switch_stmt(CheckerContext *ctx, Ast *node, u32 mod_flags) {
 		x.expr->kind = Ast_Ident;
 		x.expr->Ident.token = token;
 	}
+	if (x.mode != Addressing_Invalid && is_type_string(x.type)) {
+		// NOTE: A switch of constant strings dispatches on their hash, see 'ir_build_string_switch_stmt'
+		add_package_dependency(ctx, "runtime", "default_hash_string");
+	}
 
 	// NOTE(bill): Check for multiple defaults
 	Ast *first_default = nullptr;
@@ -807,11 +811,11 @@ void check_switch_stmt(CheckerContext *ctx, Ast *node, u32 mod_flags) {
 			for_array(i, unhandled) {
 				Entity *f = unhandled[i];
 				if (i > 0)  {
-					gb_printf_err(", ");
+					error_line(", ");
 				}
-				gb_printf_err("%.*s", LIT(f->token.string));
+				error_line("%.*s", LIT(f->token.string));
 			}
-			gb_printf_err("\n");
+			error_line("\n");
 		}
 	}
 }
@@ -998,7 +1002,7 @@ void check_type_switch_stmt(CheckerContext *ctx, Ast *node, u32 mod_flags) {
 			Entity *tag_var = alloc_entity_variable(ctx->scope, lhs->Ident.token, case_type, false, EntityState_Resolved);
 			tag_var->flags |= EntityFlag_Used;
 			tag_var->flags |= EntityFlag_Value;
-			add_entity(ctx->checker, ctx->scope, lhs, tag_var);
+			add_entity(ctx, ctx->scope, lhs, tag_var);
 			add_entity_use(ctx, lhs, tag_var);
 			add_implicit_entity(ctx, stmt, tag_var);
 		}
@@ -1030,13 +1034,13 @@ void check_type_switch_stmt(CheckerContext *ctx, Ast *node, u32 mod_flags) {
 			for_array(i, unhandled) {
 				Type *t = unhandled[i];
 				if (i > 0)  {
-					gb_printf_err(", ");
+					error_line(", ");
 				}
 				gbString s = type_to_string(t);
-				gb_printf_err("%s", s);
+				error_line("%s", s);
 				gb_string_free(s);
 			}
-			gb_printf_err("\n");
+			error_line("\n");
 		}
 	}
 }
@@ -1473,7 +1477,7 @@ void check_stmt_internal(CheckerContext *ctx, Ast *node, u32 flags) {
 					bool is_immutable = false;
 					entity = alloc_entity_variable(ctx->scope, token, type, is_immutable, EntityState_Resolved);
 					entity->flags |= EntityFlag_Value;
-					add_entity_definition(&ctx->checker->info, name, entity);
+					add_entity_definition(ctx, name, entity);
 				} else {
 					TokenPos pos = found->token.pos;
 					error(token,
@@ -1499,7 +1503,7 @@ void check_stmt_internal(CheckerContext *ctx, Ast *node, u32 flags) {
 		}
 
 		for (isize i = 0; i < entity_count; i++) {
-			add_entity(ctx->checker, ctx->scope, entities[i]->identifier, entities[i]);
+			add_entity(ctx, ctx->scope, entities[i]->identifier, entities[i]);
 		}
 
 		check_stmt(ctx, rs->body, new_flags);
@@ -1767,6 +1771,8 @@ void check_stmt_internal(CheckerContext *ctx, Ast *node, u32 flags) {
 					init_entity_foreign_library(ctx, e);
 
 					auto *fp = &ctx->checker->info.foreigns;
+					gb_mutex_lock(&ctx->info->entity_mutex);
+					defer (gb_mutex_unlock(&ctx->info->entity_mutex));
 					HashKey key = hash_string(name);
 					Entity **found = map_get(fp, key);
 					if (found) {
@@ -1795,7 +1801,7 @@ void check_stmt_internal(CheckerContext *ctx, Ast *node, u32 flags) {
 						}
 					}
 				}
-				add_entity(ctx->checker, ctx->scope, e->identifier, e);
+				add_entity(ctx, ctx->scope, e->identifier, e);
 			}
 
 			if (vd->is_using != 0) {
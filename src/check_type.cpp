@@ -22,7 +22,7 @@ void populate_using_array_index(CheckerContext *ctx, Ast *node, AstField *field,
 			tok.pos = ast_token(field->type).pos;
 		}
 		Entity *f = alloc_entity_array_elem(nullptr, tok, t->Array.elem, idx);
-		add_entity(ctx->checker, ctx->scope, nullptr, f);
+		add_entity(ctx, ctx->scope, nullptr, f);
 	}
 }
 
@@ -51,7 +51,7 @@ void populate_using_entity_scope(CheckerContext *ctx, Ast *node, AstField *field
 					error(e->token, "'%.*s' is already declared", LIT(name));
 				}
 			} else {
-				add_entity(ctx->checker, ctx->scope, nullptr, f);
+				add_entity(ctx, ctx->scope, nullptr, f);
 				if (f->flags & EntityFlag_Using) {
 					populate_using_entity_scope(ctx, node, field, f->type);
 				}
@@ -70,7 +70,7 @@ void populate_using_entity_scope(CheckerContext *ctx, Ast *node, AstField *field
 					error(e->token, "'%.*s' is already declared", LIT(name));
 				}
 			} else {
-				add_entity(ctx->checker, ctx->scope, nullptr, f);
+				add_entity(ctx, ctx->scope, nullptr, f);
 			}
 		}
 	} else if (t->kind == Type_Array && t->Array.count <= 4) {
@@ -169,7 +169,7 @@ void check_struct_fields(CheckerContext *ctx, Ast *node, Array<Entity *> *fields
 			Token name_token = name->Ident.token;
 
 			Entity *field = alloc_entity_field(ctx->scope, name_token, type, is_using, field_src_index);
-			add_entity(ctx->checker, ctx->scope, name, field);
+			add_entity(ctx, ctx->scope, name, field);
 			array_add(fields, field);
 
 			field_src_index += 1;
@@ -459,7 +459,7 @@ void check_struct_type(CheckerContext *ctx, Type *struct_type, Ast *node, Array<
 					}
 
 					e->state = EntityState_Resolved;
-					add_entity(ctx->checker, scope, name, e);
+					add_entity(ctx, scope, name, e);
 					array_add(&entities, e);
 				}
 			}
@@ -643,7 +643,7 @@ void check_union_type(CheckerContext *ctx, Type *union_type, Ast *node, Array<Op
 					}
 
 					e->state = EntityState_Resolved;
-					add_entity(ctx->checker, scope, name, e);
+					add_entity(ctx, scope, name, e);
 					array_add(&entities, e);
 				}
 			}
@@ -825,7 +825,7 @@ void check_enum_type(CheckerContext *ctx, Type *enum_type, Type *named_type, Ast
 		if (scope_lookup_current(ctx->scope, name) != nullptr) {
 			error(ident, "'%.*s' is already declared in this enumeration", LIT(name));
 		} else {
-			add_entity(ctx->checker, ctx->scope, nullptr, e);
+			add_entity(ctx, ctx->scope, nullptr, e);
 			array_add(&fields, e);
 			// TODO(bill): Should I add a use for the enum value?
 			add_entity_use(ctx, field, e);
@@ -891,7 +891,7 @@ void check_bit_field_type(CheckerContext *ctx, Type *bit_field_type, Ast *node)
 		    scope_lookup_current(ctx->scope, name) != nullptr) {
 			error(ident, "'%.*s' is already declared in this bit field", LIT(name));
 		} else {
-			add_entity(ctx->checker, ctx->scope, nullptr, e);
+			add_entity(ctx, ctx->scope, nullptr, e);
 			// TODO(bill): Should this entity be "used"?
 			add_entity_use(ctx, field, e);
 
@@ -1624,7 +1624,7 @@ Type *check_get_params(CheckerContext *ctx, Scope *scope, Ast *_params, bool *is
 			}
 			param->state = EntityState_Resolved; // NOTE(bill): This should have be resolved whilst determining it
 
-			add_entity(ctx->checker, scope, name, param);
+			add_entity(ctx, scope, name, param);
 			if (is_using) {
 				add_entity_use(ctx, name, param);
 			}
@@ -1751,7 +1751,7 @@ Type *check_get_results(CheckerContext *ctx, Scope *scope, Ast *_results) {
 				param->flags |= EntityFlag_Result;
 				param->Variable.param_value = param_value;
 				array_add(&variables, param);
-				add_entity(ctx->checker, scope, name, param);
+				add_entity(ctx, scope, name, param);
 				// NOTE(bill): Removes `declared but not used` when using -vet
 				add_entity_use(ctx, name, param);
 			}
@@ -2147,7 +2147,21 @@ Type *make_optional_ok_type(Type *value) {
 
 void init_map_entry_type(Type *type) {
 	GB_ASSERT(type->kind == Type_Map);
-	if (type->Map.entry_type != nullptr) return;
+	// NOTE: The map type may be shared between checker threads, so 'entry_type' is only
+	// read without the lock atomically, and is published once the struct has been filled in
+	if (gb_atomic_ptr_load(cast(gbAtomicPtr *)&type->Map.entry_type) != nullptr) {
+		checker_shared_reached(&type->Map.entry_type);
+		return;
+	}
+
+	gb_mutex_lock(&global_type_mutex);
+	defer (gb_mutex_unlock(&global_type_mutex));
+	if (type->Map.entry_type != nullptr) {
+		checker_shared_reached(&type->Map.entry_type);
+		return;
+	}
+	CheckerShared *shared = checker_shared_begin();
+	defer (checker_shared_end(shared, &type->Map.entry_type));
 
 	// NOTE(bill): The preload types may have not been set yet
 	GB_ASSERT(t_map_key != nullptr);
@@ -2174,14 +2188,27 @@ void init_map_entry_type(Type *type) {
 	entry_type->Struct.fields = fields;
 
 	// type_set_offsets(a, entry_type);
-	type->Map.entry_type = entry_type;
+	gb_mfence();
+	gb_atomic_ptr_store(cast(gbAtomicPtr *)&type->Map.entry_type, entry_type);
 }
 
 void init_map_internal_types(Type *type) {
 	GB_ASSERT(type->kind == Type_Map);
 	init_map_entry_type(type);
-	if (type->Map.internal_type != nullptr) return;
+	if (gb_atomic_ptr_load(cast(gbAtomicPtr *)&type->Map.internal_type) != nullptr) {
+		checker_shared_reached(&type->Map.internal_type);
+		return;
+	}
+
+	gb_mutex_lock(&global_type_mutex);
+	defer (gb_mutex_unlock(&global_type_mutex));
+	if (type->Map.internal_type != nullptr) {
+		checker_shared_reached(&type->Map.internal_type);
+		return;
+	}
 	if (type->Map.generated_struct_type != nullptr) return;
+	CheckerShared *shared = checker_shared_begin();
+	defer (checker_shared_end(shared, &type->Map.internal_type));
 
 	Type *key   = type->Map.key;
 	Type *value = type->Map.value;
@@ -2211,13 +2238,14 @@ void init_map_internal_types(Type *type) {
 	generated_struct_type->Struct.fields = fields;
 
 	type_set_offsets(generated_struct_type);
-	type->Map.generated_struct_type = generated_struct_type;
-	type->Map.internal_type         = generated_struct_type;
+	// NOTE: 'internal_type' is published last as it is checked without holding the lock
 	type->Map.lookup_result_type    = make_optional_ok_type(value);
+	type->Map.generated_struct_type = generated_struct_type;
+	gb_mfence();
+	gb_atomic_ptr_store(cast(gbAtomicPtr *)&type->Map.internal_type, generated_struct_type);
 }
 
-void check_map_type(CheckerContext *ctx, Type *type, Ast *node) {
-	GB_ASSERT(type->kind == Type_Map);
+Type *check_map_type(CheckerContext *ctx, Ast *node) {
 	ast_node(mt, MapType, node);
 
 	Type *key   = check_type(ctx, mt->key);
@@ -2231,10 +2259,10 @@ void check_map_type(CheckerContext *ctx, Type *type, Ast *node) {
 			error(node, "Invalid type of a key for a map, got '%s'", str);
 			gb_string_free(str);
 		}
+		return t_invalid;
 	}
 
-	type->Map.key   = key;
-	type->Map.value = value;
+	Type *type = alloc_type_map(0, key, value);
 
 	if (is_type_string(key)) {
 		add_package_dependency(ctx, "runtime", "default_hash_string");
@@ -2245,6 +2273,7 @@ void check_map_type(CheckerContext *ctx, Type *type, Ast *node) {
 	init_map_internal_types(type);
 
 	// error(node, "'map' types are not yet implemented");
+	return type;
 }
 
 
@@ -2351,8 +2380,8 @@ bool check_type_internal(CheckerContext *ctx, Ast *e, Type **type, Type *named_t
 			t->Generic.entity = e;
 			e->TypeName.is_type_alias = true;
 			e->state = EntityState_Resolved;
-			add_entity(ctx->checker, ps, ident, e);
-			add_entity(ctx->checker, s, ident, e);
+			add_entity(ctx, ps, ident, e);
+			add_entity(ctx, s, ident, e);
 		} else {
 			error(ident, "Invalid use of a polymorphic parameter '$%.*s'", LIT(token.string));
 			*type = t_invalid;
@@ -2501,6 +2530,8 @@ bool check_type_internal(CheckerContext *ctx, Ast *e, Type **type, Type *named_t
 		*type = alloc_type_bit_set();
 		set_base_type(named_type, *type);
 		check_bit_set_type(ctx, *type, named_type, e);
+		*type = bit_set_type_canonical(*type);
+		set_base_type(named_type, *type);
 		return true;
 	case_end;
 
@@ -2523,9 +2554,8 @@ bool check_type_internal(CheckerContext *ctx, Ast *e, Type **type, Type *named_t
 		defer (ctx->in_polymorphic_specialization = ips);
 		ctx->in_polymorphic_specialization = false;
 
-		*type = alloc_type(Type_Map);
+		*type = check_map_type(ctx, e);
 		set_base_type(named_type, *type);
-		check_map_type(ctx, *type, e);
 		return true;
 	case_end;
 
@@ -212,6 +212,110 @@ bool decl_info_has_init(DeclInfo *d) {
 
 
 
+// NOTE: Guards the scopes which every procedure body can reach, as the bodies may be checked in
+// parallel whilst a lazily checked global declaration adds to or overrides an entry in them.
+// It is only taken whilst 'check_procedure_bodies' is running more than one thread.
+gb_global gbMutex global_scope_mutex;
+gb_global bool    global_scope_is_threaded = false;
+
+bool scope_needs_lock(Scope *s) {
+	if (!global_scope_is_threaded) {
+		return false;
+	}
+	return s->parent == nullptr || (s->flags & (ScopeFlag_Pkg|ScopeFlag_File)) != 0;
+}
+
+// NOTE: The CheckerShared created by the current wave, keyed by what each one created, see
+// 'checker_shared_begin'
+gb_global gbMutex              global_shared_mutex;
+gb_global Map<CheckerShared *> global_shared_records; // Key: Entity * | Type field
+
+void checker_record_init(CheckerRecord *r) {
+	array_init(&r->items,          heap_allocator());
+	array_init(&r->procs_to_check, heap_allocator());
+}
+
+void checker_record_destroy(CheckerRecord *r) {
+	array_free(&r->items);
+	array_free(&r->procs_to_check);
+}
+
+void checker_record_add(CheckerRecord *r, CheckerRecordKind kind, Entity *e) {
+	CheckerRecordItem item = {kind};
+	item.entity = e;
+	array_add(&r->items, item);
+}
+
+// NOTE: Called by the body which is about to create something shared, holding whichever lock
+// guards it, and everything up until 'checker_shared_end' is recorded as part of it. Returns
+// nullptr when procedure bodies are not being checked.
+CheckerShared *checker_shared_begin(void) {
+	CheckerRecord *parent = thread_checker_record;
+	if (parent == nullptr) {
+		return nullptr;
+	}
+	CheckerShared *s = gb_alloc_item(heap_allocator(), CheckerShared);
+	checker_record_init(&s->record);
+	s->parent = parent;
+
+	CheckerRecordItem item = {CheckerRecord_Shared};
+	item.shared = s;
+	array_add(&parent->items, item);
+	thread_checker_record = &s->record;
+	return s;
+}
+
+// NOTE: 'key' is what other bodies will find, or nullptr if nothing was created
+void checker_shared_end(CheckerShared *s, void *key) {
+	if (s == nullptr) {
+		return;
+	}
+	GB_ASSERT(thread_checker_record == &s->record);
+	thread_checker_record = s->parent;
+	if (key != nullptr) {
+		gb_mutex_lock(&global_shared_mutex);
+		map_set(&global_shared_records, hash_pointer(key), s);
+		gb_mutex_unlock(&global_shared_mutex);
+	}
+}
+
+// NOTE: Returns what created 'key' if it was created by a body of the current wave
+CheckerShared *checker_shared_find(void *key) {
+	if (thread_checker_record == nullptr) {
+		return nullptr;
+	}
+	gb_mutex_lock(&global_shared_mutex);
+	CheckerShared **found = map_get(&global_shared_records, hash_pointer(key));
+	CheckerShared *s = found != nullptr ? *found : nullptr;
+	gb_mutex_unlock(&global_shared_mutex);
+	return s;
+}
+
+// NOTE: Called by a body which finds something which may have been created by another body
+// of the same wave
+void checker_shared_reached(void *key) {
+	CheckerRecord *r = thread_checker_record;
+	CheckerShared *s = checker_shared_find(key);
+	if (s != nullptr) {
+		CheckerRecordItem item = {CheckerRecord_Shared};
+		item.shared = s;
+		array_add(&r->items, item);
+	}
+}
+
+Entity *scope__get(Scope *s, HashKey key) {
+	bool lock = scope_needs_lock(s);
+	if (lock) {
+		gb_mutex_lock(&global_scope_mutex);
+	}
+	Entity **found = map_get(&s->elements, key);
+	Entity *e = found != nullptr ? *found : nullptr;
+	if (lock) {
+		gb_mutex_unlock(&global_scope_mutex);
+	}
+	return e;
+}
+
 Scope *create_scope(Scope *parent, gbAllocator allocator, isize init_elements_capacity=16) {
 	Scope *s = gb_alloc_item(allocator, Scope);
 	s->parent = parent;
@@ -222,7 +326,14 @@ Scope *create_scope(Scope *parent, gbAllocator allocator, isize init_elements_ca
 	s->delayed_directives.allocator = heap_allocator();
 
 	if (parent != nullptr && parent != builtin_pkg->scope) {
+		bool lock = scope_needs_lock(parent);
+		if (lock) {
+			gb_mutex_lock(&global_scope_mutex);
+		}
 		DLIST_APPEND(parent->first_child, parent->last_child, s);
+		if (lock) {
+			gb_mutex_unlock(&global_scope_mutex);
+		}
 	}
 	return s;
 }
@@ -335,12 +446,7 @@ void check_close_scope(CheckerContext *c) {
 
 
 Entity *scope_lookup_current(Scope *s, String name) {
-	HashKey key = hash_string(name);
-	Entity **found = map_get(&s->elements, key);
-	if (found) {
-		return *found;
-	}
-	return nullptr;
+	return scope__get(s, hash_string(name));
 }
 
 void scope_lookup_parent(Scope *scope, String name, Scope **scope_, Entity **entity_) {
@@ -348,9 +454,8 @@ void scope_lookup_parent(Scope *scope, String name, Scope **scope_, Entity **ent
 	bool gone_thru_package = false;
 	HashKey key = hash_string(name);
 	for (Scope *s = scope; s != nullptr; s = s->parent) {
-		Entity **found = map_get(&s->elements, key);
-		if (found) {
-			Entity *e = *found;
+		Entity *e = scope__get(s, key);
+		if (e != nullptr) {
 			if (gone_thru_proc) {
 				// IMPORTANT TODO(bill): Is this correct?!
 				if (e->kind == Entity_Label) {
@@ -394,6 +499,13 @@ Entity *scope_insert(Scope *s, Entity *entity) {
 		return nullptr;
 	}
 	HashKey key = hash_string(name);
+	bool lock = scope_needs_lock(s);
+	if (lock) {
+		gb_mutex_lock(&global_scope_mutex);
+	}
+	defer (if (lock) {
+		gb_mutex_unlock(&global_scope_mutex);
+	});
 	Entity **found = map_get(&s->elements, key);
 
 	if (found) {
@@ -654,6 +766,12 @@ void init_universal(void) {
 	// NOTE(bill): No need to free these
 	gbAllocator a = heap_allocator();
 
+	init_global_type_mutex();
+	gb_mutex_init(&global_scope_mutex);
+	gb_mutex_init(&global_shared_mutex);
+	map_init(&global_shared_records, heap_allocator());
+	init_canonical_types();
+
 	builtin_pkg = gb_alloc_item(a, AstPackage);
 	builtin_pkg->name = str_lit("builtin");
 	builtin_pkg->kind = Package_Normal;
@@ -719,6 +837,11 @@ void init_universal(void) {
 	t_f64_ptr      = alloc_type_pointer(t_f64);
 	t_u8_slice     = alloc_type_slice(t_u8);
 	t_string_slice = alloc_type_slice(t_string);
+
+	// NOTE: Allocated here rather than on first use so that their ids do not depend on which
+	// procedure body selects them first
+	entity__any_data = alloc_entity_field(nullptr, make_token_ident(str_lit("data")), t_rawptr, false, 0);
+	entity__any_id   = alloc_entity_field(nullptr, make_token_ident(str_lit("id")),   t_typeid, false, 1);
 }
 
 
@@ -734,9 +857,12 @@ void init_checker_info(CheckerInfo *i) {
 	map_init(&i->gen_types,       a);
 	array_init(&i->type_info_types, a);
 	map_init(&i->type_info_map,   a);
+	map_init(&i->type_info_hash_map, a);
 	map_init(&i->files,           a);
 	map_init(&i->packages,        a);
 	array_init(&i->variable_init_order, a);
+	gb_mutex_init(&i->global_mutex);
+	gb_mutex_init(&i->entity_mutex);
 }
 
 void destroy_checker_info(CheckerInfo *i) {
@@ -748,9 +874,12 @@ void destroy_checker_info(CheckerInfo *i) {
 	map_destroy(&i->gen_types);
 	array_free(&i->type_info_types);
 	map_destroy(&i->type_info_map);
+	map_destroy(&i->type_info_hash_map);
 	map_destroy(&i->files);
 	map_destroy(&i->packages);
 	array_free(&i->variable_init_order);
+	gb_mutex_destroy(&i->global_mutex);
+	gb_mutex_destroy(&i->entity_mutex);
 }
 
 CheckerContext make_checker_context(Checker *c) {
@@ -760,6 +889,7 @@ CheckerContext make_checker_context(Checker *c) {
 	ctx.allocator = c->allocator;
 	ctx.scope     = builtin_pkg->scope;
 	ctx.pkg       = builtin_pkg;
+	ctx.untyped   = &c->info.untyped;
 
 	ctx.type_path = new_checker_type_path();
 	ctx.type_level = 0;
@@ -884,18 +1014,32 @@ AstFile *ast_file_of_filename(CheckerInfo *i, String filename) {
 Scope *scope_of_node(Ast *node) {
 	return node->scope;
 }
-ExprInfo *check_get_expr_info(CheckerInfo *i, Ast *expr) {
-	return map_get(&i->untyped, hash_node(expr));
+ExprInfo *check_get_expr_info(CheckerContext *c, Ast *expr) {
+	return map_get(c->untyped, hash_node(expr));
 }
-void check_set_expr_info(CheckerInfo *i, Ast *expr, ExprInfo info) {
-	map_set(&i->untyped, hash_node(expr), info);
+void check_set_expr_info(CheckerContext *c, Ast *expr, ExprInfo info) {
+	map_set(c->untyped, hash_node(expr), info);
 }
-void check_remove_expr_info(CheckerInfo *i, Ast *expr) {
-	map_remove(&i->untyped, hash_node(expr));
+void check_remove_expr_info(CheckerContext *c, Ast *expr) {
+	map_remove(c->untyped, hash_node(expr));
 }
 
 
 
+// NOTE: Finds the entry of a type which is identical to 'type' but is a different pointer
+isize type_info_find_identical(CheckerInfo *info, Type *type, u64 hash) {
+	info->type_info_slow_lookup_count += 1;
+	HashKey key = hash_integer(hash);
+	for (auto *e = multi_map_find_first(&info->type_info_hash_map, key);
+	     e != nullptr;
+	     e = multi_map_find_next(&info->type_info_hash_map, e)) {
+		if (are_types_identical(info->type_info_types[e->value], type)) {
+			return e->value;
+		}
+	}
+	return -1;
+}
+
 isize type_info_index(CheckerInfo *info, Type *type, bool error_on_failure) {
 	type = default_type(type);
 	if (type == t_llvm_bool) {
@@ -909,17 +1053,10 @@ isize type_info_index(CheckerInfo *info, Type *type, bool error_on_failure) {
 		entry_index = *found_entry_index;
 	}
 	if (entry_index < 0) {
-		// NOTE(bill): Do manual search
-		// TODO(bill): This is O(n) and can be very slow
-		for_array(i, info->type_info_map.entries){
-			auto *e = &info->type_info_map.entries[i];
-			Type *prev_type = cast(Type *)e->key.ptr;
-			if (are_types_identical(prev_type, type)) {
-				entry_index = e->value;
-				// NOTE(bill): Add it to the search map
-				map_set(&info->type_info_map, key, entry_index);
-				break;
-			}
+		entry_index = type_info_find_identical(info, type, type_hash_structural(type));
+		if (entry_index >= 0) {
+			// NOTE: Add it to the search map
+			map_set(&info->type_info_map, key, entry_index);
 		}
 	}
 
@@ -930,7 +1067,7 @@ isize type_info_index(CheckerInfo *info, Type *type, bool error_on_failure) {
 }
 
 
-void add_untyped(CheckerInfo *i, Ast *expression, bool lhs, AddressingMode mode, Type *type, ExactValue value) {
+void add_untyped(CheckerContext *c, Ast *expression, bool lhs, AddressingMode mode, Type *type, ExactValue value) {
 	if (expression == nullptr) {
 		return;
 	}
@@ -940,7 +1077,7 @@ void add_untyped(CheckerInfo *i, Ast *expression, bool lhs, AddressingMode mode,
 	if (mode == Addressing_Constant && type == t_invalid) {
 		compiler_error("add_untyped - invalid type: %s", type_to_string(type));
 	}
-	map_set(&i->untyped, hash_node(expression), make_expr_info(mode, type, value, lhs));
+	map_set(c->untyped, hash_node(expression), make_expr_info(mode, type, value, lhs));
 }
 
 void add_type_and_value(CheckerInfo *i, Ast *expr, AddressingMode mode, Type *type, ExactValue value) {
@@ -959,7 +1096,7 @@ void add_type_and_value(CheckerInfo *i, Ast *expr, AddressingMode mode, Type *ty
 	expr->tav.value = value;
 }
 
-void add_entity_definition(CheckerInfo *i, Ast *identifier, Entity *entity) {
+void add_entity_definition(CheckerContext *c, Ast *identifier, Entity *entity) {
 	GB_ASSERT(identifier != nullptr);
 	GB_ASSERT(identifier->kind == Ast_Ident);
 	// if (is_blank_ident(identifier)) {
@@ -973,10 +1110,15 @@ void add_entity_definition(CheckerInfo *i, Ast *identifier, Entity *entity) {
 
 	identifier->Ident.entity = entity;
 	entity->identifier = identifier;
-	array_add(&i->definitions, entity);
+
+	if (thread_checker_record != nullptr) {
+		checker_record_add(thread_checker_record, CheckerRecord_Definition, entity);
+	} else {
+		array_add(&c->info->definitions, entity);
+	}
 }
 
-bool add_entity(Checker *c, Scope *scope, Ast *identifier, Entity *entity) {
+bool add_entity(CheckerContext *c, Scope *scope, Ast *identifier, Entity *entity) {
 	if (scope == nullptr) {
 		return false;
 	}
@@ -1012,7 +1154,7 @@ bool add_entity(Checker *c, Scope *scope, Ast *identifier, Entity *entity) {
 		}
 	}
 	if (identifier != nullptr) {
-		add_entity_definition(&c->info, identifier, entity);
+		add_entity_definition(c, identifier, entity);
 	}
 	return true;
 }
@@ -1025,9 +1167,9 @@ void add_entity_use(CheckerContext *c, Ast *identifier, Entity *entity) {
 		if (identifier->kind != Ast_Ident) {
 			return;
 		}
-		if (entity->identifier == nullptr) {
-			entity->identifier = identifier;
-		}
+		// NOTE: The entities of the package and file scopes are shared between procedure bodies
+		// which may be checked in parallel, so only the first identifier is stored
+		gb_atomic_ptr_compare_exchange(cast(gbAtomicPtr *)&entity->identifier, nullptr, identifier);
 		identifier->Ident.entity = entity;
 
 		String dmsg = entity->deprecated_message;
@@ -1035,7 +1177,7 @@ void add_entity_use(CheckerContext *c, Ast *identifier, Entity *entity) {
 			warning(identifier, "%.*s is deprecated: %.*s", LIT(entity->token.string), LIT(dmsg));
 		}
 	}
-	entity->flags |= EntityFlag_Used;
+	gb_atomic32_fetch_or(cast(gbAtomic32 *)&entity->flags, EntityFlag_Used);
 	add_declaration_dependency(c, entity);
 	if (entity_has_deferred_procedure(entity)) {
 		Entity *deferred = entity->Procedure.deferred_procedure.entity;
@@ -1060,14 +1202,21 @@ void add_entity_and_decl_info(CheckerContext *c, Ast *identifier, Entity *e, Dec
 				scope = pkg->scope;
 			}
 		}
-		add_entity(c->checker, scope, identifier, e);
+		add_entity(c, scope, identifier, e);
 	}
 
-	add_entity_definition(&c->checker->info, identifier, e);
+	add_entity_definition(c, identifier, e);
 	GB_ASSERT(e->decl_info == nullptr);
 	e->decl_info = d;
-	array_add(&c->checker->info.entities, e);
-	e->order_in_src = c->checker->info.entities.count;
+
+	if (thread_checker_record != nullptr) {
+		// NOTE: 'order_in_src' is assigned when the task is merged
+		checker_record_add(thread_checker_record, CheckerRecord_Entity, e);
+	} else {
+		array_add(&c->info->entities, e);
+		e->order_in_src = c->info->entities.count;
+	}
+
 	e->pkg = c->pkg;
 }
 
@@ -1098,6 +1247,16 @@ void add_type_info_type(CheckerContext *c, Type *t) {
 		return;
 	}
 
+	if (thread_checker_record != nullptr) {
+		// NOTE: Checking procedure bodies in parallel, the type info table is
+		// filled in afterwards so that the indices do not depend on thread scheduling
+		CheckerRecordItem item = {CheckerRecord_TypeInfo};
+		item.type_info.decl = c->decl;
+		item.type_info.type = t;
+		array_add(&thread_checker_record->items, item);
+		return;
+	}
+
 	add_type_info_dependency(c->decl, t);
 
 	auto found = map_get(&c->info->type_info_map, hash_type(t));
@@ -1107,22 +1266,17 @@ void add_type_info_type(CheckerContext *c, Type *t) {
 	}
 
 	bool prev = false;
-	isize ti_index = -1;
-	for_array(i, c->info->type_info_map.entries) {
-		auto *e = &c->info->type_info_map.entries[i];
-		Type *prev_type = cast(Type *)e->key.ptr;
-		if (are_types_identical(t, prev_type)) {
-			// Duplicate entry
-			ti_index = e->value;
-			prev = true;
-			break;
-		}
-	}
-	if (ti_index < 0) {
+	u64 hash = type_hash_structural(t);
+	isize ti_index = type_info_find_identical(c->info, t, hash);
+	if (ti_index >= 0) {
+		// Duplicate entry
+		prev = true;
+	} else {
 		// Unique entry
 		// NOTE(bill): map entries grow linearly and in order
 		ti_index = c->info->type_info_types.count;
 		array_add(&c->info->type_info_types, t);
+		multi_map_insert(&c->info->type_info_hash_map, hash_integer(hash), ti_index);
 	}
 	map_set(&c->checker->info.type_info_map, hash_type(t), ti_index);
 
@@ -1254,12 +1408,20 @@ void add_type_info_type(CheckerContext *c, Type *t) {
 	}
 }
 
-void check_procedure_later(Checker *c, ProcInfo info) {
+void check_procedure_later(CheckerContext *c, ProcInfo info) {
 	GB_ASSERT(info.decl != nullptr);
-	array_add(&c->procs_to_check, info);
+	if (thread_checker_record != nullptr) {
+		CheckerRecord *r = thread_checker_record;
+		CheckerRecordItem item = {CheckerRecord_ProcToCheck};
+		item.proc_index = r->procs_to_check.count;
+		array_add(&r->procs_to_check, info);
+		array_add(&r->items, item);
+	} else {
+		array_add(&c->checker->procs_to_check, info);
+	}
 }
 
-void check_procedure_later(Checker *c, AstFile *file, Token token, DeclInfo *decl, Type *type, Ast *body, u64 tags) {
+void check_procedure_later(CheckerContext *c, AstFile *file, Token token, DeclInfo *decl, Type *type, Ast *body, u64 tags) {
 	ProcInfo info = {};
 	info.file  = file;
 	info.token = token;
@@ -1272,8 +1434,7 @@ void check_procedure_later(Checker *c, AstFile *file, Token token, DeclInfo *dec
 
 void add_curr_ast_file(CheckerContext *ctx, AstFile *file) {
 	if (file != nullptr) {
-		TokenPos zero_pos = {};
-		global_error_collector.prev = zero_pos;
+		error_reset_prev_pos();
 		ctx->file  = file;
 		ctx->decl  = file->pkg->decl_info;
 		ctx->scope = file->scope;
@@ -1835,6 +1996,9 @@ void init_mem_allocator(Checker *c) {
 
 	t_allocator = e->type;
 	t_allocator_ptr = alloc_type_pointer(t_allocator);
+
+	entity__dynamic_array_allocator = alloc_entity_field(nullptr, make_token_ident(str_lit("allocator")), t_allocator, false, 3);
+	entity__map_allocator           = alloc_entity_field(nullptr, make_token_ident(str_lit("allocator")), t_allocator, false, 3);
 }
 
 void init_core_context(Checker *c) {
@@ -2276,7 +2440,7 @@ void check_builtin_attributes(CheckerContext *ctx, Entity *e, Array<Ast *> *attr
 			}
 
 			if (name == "builtin") {
-				add_entity(ctx->checker, builtin_pkg->scope, nullptr, e);
+				add_entity(ctx, builtin_pkg->scope, nullptr, e);
 				GB_ASSERT(scope_lookup(builtin_pkg->scope, e->token.string) != nullptr);
 				if (value != nullptr) {
 					error(value, "'builtin' cannot have a field value");
@@ -2957,7 +3121,7 @@ void check_add_import_decl(CheckerContext *ctx, Ast *decl) {
 		                                     id->fullpath, id->import_name.string,
 		                                     scope);
 
-		add_entity(ctx->checker, parent_scope, nullptr, e);
+		add_entity(ctx, parent_scope, nullptr, e);
 		if (id->is_using) {
 			add_entity_use(ctx, nullptr, e);
 		}
@@ -2976,7 +3140,7 @@ void check_add_import_decl(CheckerContext *ctx, Ast *decl) {
 
 			if (is_entity_exported(e)) {
 				Entity *prev = scope_lookup(parent_scope, e->token.string);
-				add_entity(ctx->checker, parent_scope, e->identifier, e);
+				add_entity(ctx, parent_scope, e->identifier, e);
 			}
 		}
 	}
@@ -3027,7 +3191,7 @@ void check_add_foreign_import_decl(CheckerContext *ctx, Ast *decl) {
 
 	Entity *e = alloc_entity_library_name(parent_scope, fl->library_name, t_invalid,
 	                                      fl->fullpaths, library_name);
-	add_entity(ctx->checker, parent_scope, nullptr, e);
+	add_entity(ctx, parent_scope, nullptr, e);
 }
 
 bool collect_checked_packages_from_decl_list(Checker *c, Array<Ast *> const &decls) {
@@ -3404,7 +3568,9 @@ void calculate_global_init_order(Checker *c) {
 	});
 #define TIME_SECTION(str) timings_start_section(&timings, str_lit(str))
 #else
-#define TIME_SECTION(str)
+	TimingsTraceSection trace_section = {"check"};
+	defer (timings_trace_section_end(&trace_section));
+#define TIME_SECTION(str) timings_trace_section_start(&trace_section, str_lit(str))
 #endif
 
 
@@ -3481,15 +3647,19 @@ void calculate_global_init_order(Checker *c) {
 }
 
 
-void check_proc_info(Checker *c, ProcInfo pi) {
+void check_proc_info(Checker *c, ProcInfo pi, CheckProcInfoTask *task = nullptr) {
 	if (pi.type == nullptr) {
 		return;
 	}
+	TIMINGS_TRACE_SCOPE("check procedure", pi.token.string);
 
 	CheckerContext ctx = make_checker_context(c);
 	defer (destroy_checker_context(&ctx));
 	add_curr_ast_file(&ctx, pi.file);
 	ctx.decl = pi.decl;
+	if (task != nullptr) {
+		ctx.untyped = &task->untyped;
+	}
 
 	TypeProc *pt = &pi.type->Proc;
 	String name = pi.token.string;
@@ -3516,14 +3686,179 @@ void check_proc_info(Checker *c, ProcInfo pi) {
 	check_proc_body(&ctx, pi.token, pi.decl, pi.type, pi.body);
 }
 
-GB_THREAD_PROC(check_proc_info_worker_proc) {
-	if (thread == nullptr) return 0;
-	auto *c = cast(Checker *)thread->user_data;
-	isize index = thread->user_index;
-	check_proc_info(c, c->procs_to_check[index]);
+WORKER_TASK_PROC(check_proc_info_worker_proc) {
+	auto *task = cast(CheckProcInfoTask *)data;
+	thread_error_buffer   = &task->errors;
+	thread_checker_record = &task->record;
+	check_proc_info(task->checker, task->proc_info, task);
+	thread_checker_record = nullptr;
+	thread_error_buffer   = nullptr;
 	return 0;
 }
 
+// NOTE: Entities allocated whilst a wave is checked are given their ids again, in the order in
+// which they are merged, so the ids do not depend on which thread allocated them first
+void checker_record_merge(Checker *c, CheckerRecord *r, u64 *entity_id, Array<CheckerShared *> *merged) {
+	CheckerContext ctx = c->init_ctx;
+	for_array(i, r->items) {
+		CheckerRecordItem item = r->items[i];
+		switch (item.kind) {
+		case CheckerRecord_Alloc:
+			*entity_id += 1;
+			item.entity->id = *entity_id;
+			break;
+		case CheckerRecord_Definition:
+			array_add(&c->info.definitions, item.entity);
+			break;
+		case CheckerRecord_Entity:
+			array_add(&c->info.entities, item.entity);
+			item.entity->order_in_src = c->info.entities.count;
+			break;
+		case CheckerRecord_TypeInfo:
+			ctx.decl = item.type_info.decl;
+			add_type_info_type(&ctx, item.type_info.type);
+			break;
+		case CheckerRecord_ProcToCheck:
+			array_add(&c->procs_to_check, r->procs_to_check[item.proc_index]);
+			break;
+		case CheckerRecord_Shared:
+			if (!item.shared->merged) {
+				item.shared->merged = true;
+				array_add(merged, item.shared);
+				checker_record_merge(c, &item.shared->record, entity_id, merged);
+			}
+			break;
+		default:
+			GB_PANIC("Invalid checker record item");
+			break;
+		}
+	}
+}
+
+GB_COMPARE_PROC(entity_id_cmp) {
+	Entity *x = *cast(Entity **)a;
+	Entity *y = *cast(Entity **)b;
+	return x->id < y->id ? -1 : x->id > y->id;
+}
+
+// NOTE: Polymorphic instantiations are appended as they are created, which is in id order when
+// the bodies are checked one at a time
+void checker_sort_generated_entities(Map<Array<Entity *> > *m) {
+	for_array(i, m->entries) {
+		Array<Entity *> *entities = &m->entries[i].value;
+		gb_sort_array(entities->data, entities->count, entity_id_cmp);
+	}
+}
+
+void decl_graph_skip_unchanged_procedures(DeclGraph *g, Checker *c); // NOTE: See decl_graph.cpp
+
+void check_procedure_bodies(Checker *c) {
+	isize thread_count = gb_max(build_context.thread_count, 1);
+
+	ThreadPool thread_pool = {};
+	if (thread_count > 1) {
+		thread_pool_init(&thread_pool, heap_allocator(), thread_count);
+		global_scope_is_threaded = true;
+	}
+	defer (if (thread_count > 1) {
+		thread_pool_destroy(&thread_pool);
+		global_scope_is_threaded = false;
+	});
+
+	// NOTE: Procedures found whilst checking a wave (nested procedures and
+	// polymorphic specializations) make up the next wave. Merging each task's results
+	// in 'procs_to_check' order keeps the final state the same as the serial order.
+	// A single thread goes through the same waves so that any thread count gives the
+	// same output.
+	isize wave_start = 0;
+	while (wave_start < c->procs_to_check.count) {
+		isize wave_end = c->procs_to_check.count;
+		u64 wave_entity_id = cast(u64)gb_atomic64_load(&global_entity_id);
+
+		auto tasks = array_make<CheckProcInfoTask>(heap_allocator(), wave_end-wave_start);
+		defer (array_free(&tasks));
+
+		for_array(i, tasks) {
+			CheckProcInfoTask *task = &tasks[i];
+			task->checker   = c;
+			task->proc_info = c->procs_to_check[wave_start+i];
+			map_init(&task->untyped, heap_allocator());
+			checker_record_init(&task->record);
+			array_init(&task->errors.values, heap_allocator());
+			if (thread_count > 1) {
+				thread_pool_add_task(&thread_pool, check_proc_info_worker_proc, task);
+			} else {
+				check_proc_info_worker_proc(task);
+			}
+		}
+
+		if (thread_count > 1) {
+			thread_pool_wait_to_process(&thread_pool);
+		}
+
+		// NOTE: The diagnostics are printed in source order, whichever thread reported them
+		auto errors = array_make<ErrorValue>(heap_allocator());
+		defer (array_free(&errors));
+		for_array(i, tasks) {
+			Array<ErrorValue> values = tasks[i].errors.values;
+			for_array(j, values) {
+				ErrorValue value = values[j];
+				value.index = errors.count;
+				array_add(&errors, value);
+			}
+			array_free(&tasks[i].errors.values);
+		}
+		if (errors.count > 0) {
+			error_values_print(errors);
+		}
+
+		u64 wave_entity_count = cast(u64)gb_atomic64_load(&global_entity_id) - wave_entity_id;
+		u64 entity_id = wave_entity_id;
+		auto merged = array_make<CheckerShared *>(heap_allocator());
+		defer (array_free(&merged));
+
+		for_array(i, tasks) {
+			CheckProcInfoTask *task = &tasks[i];
+
+			for_array(j, task->untyped.entries) {
+				auto *entry = &task->untyped.entries[j];
+				map_set(&c->info.untyped, entry->key, entry->value);
+			}
+
+			checker_record_merge(c, &task->record, &entity_id, &merged);
+
+			DeclInfo *decl = task->proc_info.decl;
+			if (decl != nullptr && decl->parent != nullptr) {
+				// NOTE: Add the dependencies from the procedure literal (lambda), once
+				// the delayed type info dependencies are known, in merge order
+				for_array(j, decl->deps.entries) {
+					Entity *e = decl->deps.entries[j].ptr;
+					ptr_set_add(&decl->parent->deps, e);
+				}
+				for_array(j, decl->type_info_deps.entries) {
+					Type *t = decl->type_info_deps.entries[j].ptr;
+					ptr_set_add(&decl->parent->type_info_deps, t);
+				}
+			}
+
+			map_destroy(&task->untyped);
+			checker_record_destroy(&task->record);
+		}
+		GB_ASSERT(entity_id-wave_entity_id == wave_entity_count);
+
+		for_array(i, merged) {
+			checker_record_destroy(&merged[i]->record);
+			gb_free(heap_allocator(), merged[i]);
+		}
+		map_clear(&global_shared_records);
+
+		checker_sort_generated_entities(&c->info.gen_procs);
+		checker_sort_generated_entities(&c->info.gen_types);
+
+		wave_start = wave_end;
+	}
+}
+
 
 void check_parsed_files(Checker *c) {
 #if 0
@@ -3535,7 +3870,9 @@ void check_parsed_files(Checker *c) {
 	});
 #define TIME_SECTION(str) timings_start_section(&timings, str_lit(str))
 #else
-#define TIME_SECTION(str)
+	TimingsTraceSection trace_section = {"check"};
+	defer (timings_trace_section_end(&trace_section));
+#define TIME_SECTION(str) timings_trace_section_start(&trace_section, str_lit(str))
 #endif
 
 	TIME_SECTION("map full filepaths to scope");
@@ -3591,13 +3928,14 @@ void check_parsed_files(Checker *c) {
 	CheckerContext prev_context = c->init_ctx;
 	defer (c->init_ctx = prev_context);
 
-	TIME_SECTION("check procedure bodies");
-	// NOTE(bill): Nested procedures bodies will be added to this "queue"
-	for_array(i, c->procs_to_check) {
-		ProcInfo pi = c->procs_to_check[i];
-		check_proc_info(c, pi);
+	if (c->decl_graph != nullptr && build_context.no_output_files) {
+		TIME_SECTION("skip unchanged procedures");
+		decl_graph_skip_unchanged_procedures(c->decl_graph, c);
 	}
 
+	TIME_SECTION("check procedure bodies");
+	check_procedure_bodies(c);
+
 	for_array(i, c->info.files.entries) {
 		AstFile *f = c->info.files.entries[i].value;
 		check_scope_usage(c, f->scope);
@@ -3781,8 +4119,8 @@ void check_parsed_files(Checker *c) {
 			token.pos.column = 1;
 			if (s->pkg->files.count > 0) {
 				AstFile *f = s->pkg->files[0];
-				if (f->tokens.count > 0) {
-					token = f->tokens[0];
+				if (f->package_token.kind == Token_package) {
+					token = f->package_token;
 				}
 			}
 
@@ -351,6 +351,68 @@ struct ProcInfo {
 	Ast *     poly_def_node;
 };
 
+// DelayedTypeInfo records a call to 'add_type_info_type' made whilst checking
+// procedure bodies in parallel, so it can be replayed in a deterministic order
+struct DelayedTypeInfo {
+	DeclInfo *decl;
+	Type *    type;
+};
+
+// CheckerRecord is everything checking a procedure body adds to shared checker state,
+// where the order of addition matters, in the order it was added. The records of a wave
+// are merged in 'procs_to_check' order once every body of it has been checked, so the
+// result is the same whichever threads checked them.
+enum CheckerRecordKind {
+	CheckerRecord_Invalid,
+	CheckerRecord_Alloc,       // An entity was allocated, its id is handed out when merged
+	CheckerRecord_Definition,  // 'info.definitions'
+	CheckerRecord_Entity,      // 'info.entities'
+	CheckerRecord_TypeInfo,    // 'add_type_info_type'
+	CheckerRecord_ProcToCheck, // 'procs_to_check'
+	CheckerRecord_Shared,      // A CheckerShared was created or reached
+};
+
+struct CheckerShared;
+
+struct CheckerRecordItem {
+	CheckerRecordKind kind;
+	union {
+		Entity *        entity;
+		DelayedTypeInfo type_info;
+		isize           proc_index; // Index into 'CheckerRecord.procs_to_check'
+		CheckerShared * shared;
+	};
+};
+
+struct CheckerRecord {
+	Array<CheckerRecordItem> items;
+	Array<ProcInfo>          procs_to_check;
+};
+
+// CheckerShared is a lazily checked global declaration, a polymorphic instantiation, or the
+// internal types of a map, which is created by whichever body reaches it first and is then
+// shared. What creating it added is recorded separately and merged where the first body, in
+// merge order, reached it, which is where checking the bodies one at a time would create it.
+struct CheckerShared {
+	CheckerRecord   record;
+	CheckerRecord * parent; // NOTE: The record of the body which created it
+	bool            merged;
+};
+
+// NOTE: Only set whilst checking a procedure body in 'check_procedure_bodies'
+gb_thread_local CheckerRecord *thread_checker_record = nullptr;
+
+// CheckProcInfoTask is a procedure body checked by 'check_procedure_bodies', possibly on a
+// worker thread
+struct CheckProcInfoTask {
+	Checker *     checker;
+	ProcInfo      proc_info;
+
+	Map<ExprInfo> untyped;
+	CheckerRecord record;
+	ErrorBuffer   errors;
+};
+
 
 
 enum ScopeFlag {
@@ -441,6 +503,8 @@ struct CheckerInfo {
 
 	Array<Type *>         type_info_types;
 	Map<isize>            type_info_map;   // Key: Type *
+	Map<isize>            type_info_hash_map; // Key: type_hash_structural (multi map), Value: index of type_info_types
+	isize                 type_info_slow_lookup_count; // NOTE: Lookups which were not found by pointer
 
 
 	AstPackage *          builtin_package;
@@ -449,6 +513,10 @@ struct CheckerInfo {
 	Entity *              entry_point;
 	PtrSet<Entity *>      minimum_dependency_set;
 	PtrSet<isize>         minimum_dependency_type_info_set;
+
+	// NOTE: Only needed when procedure bodies are checked in parallel
+	gbMutex               global_mutex; // Lazily checked global declarations and polymorphic instantiation
+	gbMutex               entity_mutex; // 'foreigns' and dependencies shared between procedures
 };
 
 struct CheckerContext {
@@ -481,11 +549,16 @@ struct CheckerContext {
 	bool       no_polymorphic_errors;
 	bool       in_polymorphic_specialization;
 	Scope *    polymorphic_scope;
+
+	Map<ExprInfo> *    untyped;   // NOTE: Defaults to '&info->untyped'
 };
 
+struct DeclGraph; // NOTE: See decl_graph.cpp
+
 struct Checker {
 	Parser *    parser;
 	CheckerInfo info;
+	DeclGraph * decl_graph; // NOTE: Only with -incremental
 
 	Array<ProcInfo> procs_to_check;
 	Array<Entity *> procs_with_deferred_to_check;
@@ -531,10 +604,10 @@ void    scope_lookup_parent (Scope *s, String name, Scope **scope_, Entity **ent
 Entity *scope_insert (Scope *s, Entity *entity);
 
 
-ExprInfo *check_get_expr_info     (CheckerInfo *i, Ast *expr);
-void      check_set_expr_info     (CheckerInfo *i, Ast *expr, ExprInfo info);
-void      check_remove_expr_info  (CheckerInfo *i, Ast *expr);
-void      add_untyped             (CheckerInfo *i, Ast *expression, bool lhs, AddressingMode mode, Type *basic_type, ExactValue value);
+ExprInfo *check_get_expr_info     (CheckerContext *c, Ast *expr);
+void      check_set_expr_info     (CheckerContext *c, Ast *expr, ExprInfo info);
+void      check_remove_expr_info  (CheckerContext *c, Ast *expr);
+void      add_untyped             (CheckerContext *c, Ast *expression, bool lhs, AddressingMode mode, Type *basic_type, ExactValue value);
 void      add_type_and_value      (CheckerInfo *i, Ast *expression, AddressingMode mode, Type *type, ExactValue value);
 void      add_entity_use          (CheckerContext *c, Ast *identifier, Entity *entity);
 void      add_implicit_entity     (CheckerContext *c, Ast *node, Entity *e);
@@ -139,6 +139,7 @@ GB_ALLOCATOR_PROC(heap_allocator_proc) {
 #include "unicode.cpp"
 #include "array.cpp"
 #include "string.cpp"
+#include "string_intern.cpp"
 #include "murmurhash3.cpp"
 
 #define for_array(index_, array_) for (isize index_ = 0; index_ < (array_).count; index_++)
@@ -323,6 +324,7 @@ void mul_overflow_u64(u64 x, u64 y, u64 *lo, u64 *hi) {
 #include "ptr_set.cpp"
 #include "string_set.cpp"
 #include "priority_queue.cpp"
+#include "thread_pool.cpp"
 
 
 
@@ -335,58 +337,105 @@ gb_global bool global_module_path_set = false;
 #define ALIGN_DOWN_PTR(p, a) (cast(void *)ALIGN_DOWN(cast(uintptr)(p), (a)))
 #define ALIGN_UP_PTR(p, a)   (cast(void *)ALIGN_UP(cast(uintptr)(p), (a)))
 
-typedef struct Arena {
-	u8 *        ptr;
-	u8 *        end;
-	u8 *        prev;
-	Array<u8 *> blocks;
-	gbAllocator backing;
-	isize       block_size;
-	gbMutex     mutex;
+// NOTE: Each thread bump allocates from its own block of an arena, so the
+// arena's mutex is only taken when a thread needs a new block
+struct ArenaCursor {
+	u8 *         ptr;
+	u8 *         end;
+	ArenaCursor *next;
 
+	isize alloc_count;
 	isize total_used;
+};
+
+typedef struct Arena {
+	char const * name;
+	isize        index;
+	Array<u8 *>  blocks;
+	gbAllocator  backing;
+	isize        block_size;
+	gbMutex      mutex;
+
+	ArenaCursor *cursors; // NOTE: One per thread that has allocated from this arena
+	isize        total_reserved;
 } Arena;
 
 #define ARENA_MIN_ALIGNMENT 16
-#define ARENA_DEFAULT_BLOCK_SIZE (8*1024*1024)
+#define ARENA_DEFAULT_BLOCK_SIZE (1024*1024) // NOTE: Per thread, so kept small
+#define ARENA_MAX_COUNT 16
 
-void arena_init(Arena *arena, gbAllocator backing, isize block_size=ARENA_DEFAULT_BLOCK_SIZE) {
+gb_global Arena *    global_arenas[ARENA_MAX_COUNT] = {};
+gb_global gbAtomic64 global_arena_count = {};
+
+gb_thread_local ArenaCursor *arena_thread_cursors[ARENA_MAX_COUNT] = {};
+
+void arena_init(Arena *arena, gbAllocator backing, char const *name, isize block_size=ARENA_DEFAULT_BLOCK_SIZE) {
+	arena->name = name;
 	arena->backing = backing;
 	arena->block_size = block_size;
 	array_init(&arena->blocks, backing);
 	gb_mutex_init(&arena->mutex);
-}
 
-void arena_grow(Arena *arena, isize min_size) {
-	gb_mutex_lock(&arena->mutex);
-	defer (gb_mutex_unlock(&arena->mutex));
+	arena->index = cast(isize)gb_atomic64_fetch_add(&global_arena_count, 1);
+	GB_ASSERT_MSG(arena->index < ARENA_MAX_COUNT, "Too many arenas, increase ARENA_MAX_COUNT");
+	global_arenas[arena->index] = arena;
+}
 
-	isize size = gb_max(arena->block_size, min_size);
+// NOTE: Must be called with 'arena->mutex' held
+u8 *arena__alloc_block(Arena *arena, isize size) {
 	size = ALIGN_UP(size, ARENA_MIN_ALIGNMENT);
-	void *new_ptr = gb_alloc(arena->backing, size);
-	arena->ptr = cast(u8 *)new_ptr;
-	// gb_zero_size(arena->ptr, size); // NOTE(bill): This should already be zeroed
-	GB_ASSERT(arena->ptr == ALIGN_DOWN_PTR(arena->ptr, ARENA_MIN_ALIGNMENT));
-	arena->end = arena->ptr + size;
-	array_add(&arena->blocks, arena->ptr);
+	// NOTE: Do not ask the backing allocator to clear the block; only the parts
+	// handed out are zeroed, so untouched pages of a thread's block cost nothing
+	u8 *block = cast(u8 *)arena->backing.proc(arena->backing.data, gbAllocation_Alloc, size, ARENA_MIN_ALIGNMENT, nullptr, 0, 0);
+	GB_ASSERT(block != nullptr);
+	GB_ASSERT(block == ALIGN_DOWN_PTR(block, ARENA_MIN_ALIGNMENT));
+	array_add(&arena->blocks, block);
+	arena->total_reserved += size;
+	return block;
+}
+
+ArenaCursor *arena_thread_cursor(Arena *arena) {
+	ArenaCursor *cursor = arena_thread_cursors[arena->index];
+	if (cursor == nullptr) {
+		gb_mutex_lock(&arena->mutex);
+		defer (gb_mutex_unlock(&arena->mutex));
+
+		cursor = gb_alloc_item(arena->backing, ArenaCursor);
+		cursor->next = arena->cursors;
+		arena->cursors = cursor;
+		arena_thread_cursors[arena->index] = cursor;
+	}
+	return cursor;
 }
 
 void *arena_alloc(Arena *arena, isize size, isize alignment) {
-	gb_mutex_lock(&arena->mutex);
-	defer (gb_mutex_unlock(&arena->mutex));
+	ArenaCursor *cursor = arena_thread_cursor(arena);
+	cursor->alloc_count += 1;
+	cursor->total_used += size;
 
-	arena->total_used += size;
+	isize align = gb_max(alignment, ARENA_MIN_ALIGNMENT);
+	void *ptr = nullptr;
 
-	if (size > (arena->end - arena->ptr)) {
-		arena_grow(arena, size);
-		GB_ASSERT(size <= (arena->end - arena->ptr));
+	if (size > arena->block_size/4) {
+		// NOTE: Large allocations get a block to themselves rather than
+		// throwing away the rest of the thread's current block
+		gb_mutex_lock(&arena->mutex);
+		ptr = arena__alloc_block(arena, size);
+		gb_mutex_unlock(&arena->mutex);
+	} else {
+		if (size > (cursor->end - cursor->ptr)) {
+			gb_mutex_lock(&arena->mutex);
+			cursor->ptr = arena__alloc_block(arena, arena->block_size);
+			cursor->end = cursor->ptr + ALIGN_UP(arena->block_size, ARENA_MIN_ALIGNMENT);
+			gb_mutex_unlock(&arena->mutex);
+		}
+		ptr = cursor->ptr;
+		cursor->ptr = cast(u8 *)ALIGN_UP_PTR(cursor->ptr + size, align);
+		if (cursor->ptr > cursor->end) {
+			cursor->ptr = cursor->end;
+		}
 	}
 
-	isize align = gb_max(alignment, ARENA_MIN_ALIGNMENT);
-	void *ptr = arena->ptr;
-	arena->prev = arena->ptr;
-	arena->ptr = cast(u8 *)ALIGN_UP_PTR(arena->ptr + size, align);
-	GB_ASSERT(arena->ptr <= arena->end);
 	GB_ASSERT(ptr == ALIGN_DOWN_PTR(ptr, align));
 	gb_zero_size(ptr, size);
 	return ptr;
@@ -400,8 +449,38 @@ void arena_free_all(Arena *arena) {
 		gb_free(arena->backing, arena->blocks[i]);
 	}
 	array_clear(&arena->blocks);
-	arena->ptr = nullptr;
-	arena->end = nullptr;
+	arena->total_reserved = 0;
+
+	for (ArenaCursor *cursor = arena->cursors; cursor != nullptr; cursor = cursor->next) {
+		cursor->ptr = nullptr;
+		cursor->end = nullptr;
+	}
+}
+
+// NOTE: Only meaningful when no other thread is allocating
+void arena_print_stats(void) {
+	isize count = cast(isize)gb_atomic64_load(&global_arena_count);
+	for (isize i = 0; i < count; i++) {
+		Arena *arena = global_arenas[i];
+
+		gb_mutex_lock(&arena->mutex);
+		isize alloc_count  = 0;
+		isize total_used   = 0;
+		isize thread_count = 0;
+		for (ArenaCursor *cursor = arena->cursors; cursor != nullptr; cursor = cursor->next) {
+			alloc_count  += cursor->alloc_count;
+			total_used   += cursor->total_used;
+			thread_count += 1;
+		}
+		gb_printf("Arena '%s'\n", arena->name);
+		gb_printf("Allocations  - %td\n", alloc_count);
+		gb_printf("Used         - %td KiB\n", total_used/1024);
+		gb_printf("Reserved     - %td KiB\n", arena->total_reserved/1024);
+		gb_printf("Blocks       - %td\n", arena->blocks.count);
+		gb_printf("Threads      - %td\n", thread_count);
+		gb_printf("\n");
+		gb_mutex_unlock(&arena->mutex);
+	}
 }
 
 
@@ -912,16 +991,13 @@ ReadDirectoryError read_directory(String path, Array<FileInfo> *fi) {
 			continue;
 		}
 
-		if (S_ISDIR(dir_stat.st_mode)) {
-			continue;
-		}
-
 		i64 size = dir_stat.st_size;
 
 		FileInfo info = {};
 		info.name = name;
 		info.fullpath = path_to_full_path(a, filepath);
 		info.size = size;
+		info.is_dir = S_ISDIR(dir_stat.st_mode);
 		array_add(fi, info);
 	}
 
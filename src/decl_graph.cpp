@@ -0,0 +1,490 @@
+// Declaration dependency graph (-incremental)
+//
+// Once checked without any errors or warnings, '<output_base>.odin-decls' records every package
+// level declaration with a hash of its source and the declarations and types it depends upon
+// (from 'DeclInfo.deps' and 'DeclInfo.type_info_deps'):
+//
+//	odin-decl-graph <version> <settings hash>
+//	decl <source hash> <key>
+//	dep <key>
+//	type <type>
+//
+// The key of a declaration is the full path of its package (or its file, for those in a file
+// scope) followed by '.' and its name.
+//
+// 'odin check -incremental' compares against the graph of the previous check, and the bodies of
+// the procedures whose source and whose dependencies (transitively) have not changed are not
+// checked again. Their dependencies are taken from the previous graph instead.
+//
+// NOTE: A declaration is considered changed if the source between the start of the file
+// level declaration which holds it and the start of the next one has changed, which includes
+// the comments in between. When a package gains a name, every declaration of that package is
+// considered changed, as the new name may now be found rather than one from the universal scope.
+// The imports and foreign imports of a file are hashed into every declaration of that file, as
+// changing the package or library behind a name changes what its declarations refer to.
+// The types are attributed to declarations as the checker finds them, so they may vary between
+// runs with more than one thread.
+
+#define DECL_GRAPH_VERSION 2
+
+struct DeclGraphNode {
+	String        key;
+	u64           hash;
+	Array<String> deps;
+	Array<String> types;
+	bool          changed;
+	bool          skipped;
+};
+
+struct DeclGraph {
+	String path;
+	u64    settings_hash;
+
+	// NOTE: The previous graph, the strings point into 'prev_contents'
+	gbFileContents       prev_contents;
+	Array<DeclGraphNode> prev_nodes;
+	Map<isize>           prev_map;    // Key: String (key), Value: index into 'prev_nodes'
+	bool                 has_prev;
+
+	// NOTE: The current declarations
+	Array<Entity *>      entities;
+	Map<Entity *>        entity_map;  // Key: String (key)
+	Map<String>          entity_keys; // Key: Entity *
+	Map<u64>             entity_hashes; // Key: Entity *
+	Map<u64>             import_hashes; // Key: AstFile *
+	bool                 collected;
+
+	isize                skipped_count;
+};
+
+gb_global DeclGraph *global_decl_graph = nullptr; // NOTE: Used by '-show-timings'
+
+
+void decl_graph_init(DeclGraph *g, String output_base) {
+	gbAllocator a = heap_allocator();
+	g->path = concatenate_strings(a, output_base, str_lit(".odin-decls"));
+	// NOTE: Includes the build of the compiler, as what the checker reports may differ between
+	// any two of them
+	g->settings_hash = build_cache_settings_hash();
+
+	array_init(&g->prev_nodes, a);
+	map_init(&g->prev_map, a);
+	array_init(&g->entities, a);
+	map_init(&g->entity_map, a);
+	map_init(&g->entity_keys, a);
+	map_init(&g->entity_hashes, a);
+	map_init(&g->import_hashes, a);
+}
+
+void decl_graph_destroy(DeclGraph *g) {
+	for_array(i, g->prev_nodes) {
+		array_free(&g->prev_nodes[i].deps);
+		array_free(&g->prev_nodes[i].types);
+	}
+	array_free(&g->prev_nodes);
+	map_destroy(&g->prev_map);
+	array_free(&g->entities);
+	map_destroy(&g->entity_map);
+	map_destroy(&g->entity_keys);
+	map_destroy(&g->entity_hashes);
+	map_destroy(&g->import_hashes);
+	if (g->prev_contents.data != nullptr) {
+		gb_file_free_contents(&g->prev_contents);
+	}
+}
+
+void decl_graph_load(DeclGraph *g) {
+	char *c_path = alloc_cstring(heap_allocator(), g->path);
+	defer (gb_free(heap_allocator(), c_path));
+
+	g->prev_contents = gb_file_read_contents(heap_allocator(), true, c_path);
+	if (g->prev_contents.data == nullptr) {
+		return;
+	}
+
+	bool header_ok = false;
+	DeclGraphNode *node = nullptr;
+
+	String contents = make_string(cast(u8 *)g->prev_contents.data, g->prev_contents.size);
+	while (contents.len > 0) {
+		isize end = 0;
+		while (end < contents.len && contents[end] != '\n') {
+			end++;
+		}
+		String line = substring(contents, 0, end);
+		contents = substring(contents, gb_min(end+1, contents.len), contents.len);
+
+		isize space = 0;
+		while (space < line.len && line[space] != ' ') {
+			space++;
+		}
+		String kind = substring(line, 0, space);
+		String rest = substring(line, gb_min(space+1, line.len), line.len);
+
+		if (kind == "odin-decl-graph") {
+			u64 settings_hash = 0;
+			header_ok = rest.len == 18 &&
+			            substring(rest, 0, 1) == "2" &&
+			            build_cache__parse_hex(substring(rest, 2, rest.len), &settings_hash) &&
+			            settings_hash == g->settings_hash;
+			if (!header_ok) {
+				break;
+			}
+		} else if (kind == "decl" && rest.len > 17) {
+			DeclGraphNode n = {};
+			if (!build_cache__parse_hex(substring(rest, 0, 16), &n.hash)) {
+				continue;
+			}
+			n.key = substring(rest, 17, rest.len);
+			array_init(&n.deps, heap_allocator());
+			array_init(&n.types, heap_allocator());
+			map_set(&g->prev_map, hash_string(n.key), g->prev_nodes.count);
+			array_add(&g->prev_nodes, n);
+			node = &g->prev_nodes[g->prev_nodes.count-1];
+		} else if (kind == "dep" && node != nullptr) {
+			array_add(&node->deps, rest);
+		} else if (kind == "type" && node != nullptr) {
+			array_add(&node->types, rest);
+		}
+	}
+
+	g->has_prev = header_ok;
+}
+
+
+bool decl_graph_is_tracked(Entity *e) {
+	switch (e->kind) {
+	case Entity_Constant:
+	case Entity_Variable:
+	case Entity_TypeName:
+	case Entity_Procedure:
+	case Entity_ProcGroup:
+		break;
+	default:
+		return false;
+	}
+	return e->decl_info != nullptr && e->token.pos.file.len > 0 && e->token.string != "_";
+}
+
+// NOTE: The start of a file level declaration, including its attributes
+isize decl_graph__decl_start(Ast *decl) {
+	isize start = ast_token(decl).pos.offset;
+	Array<Ast *> attributes = {};
+	if (decl->kind == Ast_ValueDecl) {
+		attributes = decl->ValueDecl.attributes;
+	} else if (decl->kind == Ast_ForeignBlockDecl) {
+		attributes = decl->ForeignBlockDecl.attributes;
+	}
+	for_array(i, attributes) {
+		start = gb_min(start, ast_token(attributes[i]).pos.offset);
+	}
+	return start;
+}
+
+// NOTE: Added rather than chained so that it does not depend upon the order of the scope
+u64 decl_graph__imports_hash(DeclGraph *g, AstFile *f) {
+	u64 *found = map_get(&g->import_hashes, hash_pointer(f));
+	if (found != nullptr) {
+		return *found;
+	}
+
+	u64 hash = 0;
+	for_array(i, f->imports) {
+		Ast *node = f->imports[i];
+		if (node->kind != Ast_ImportDecl) {
+			continue;
+		}
+		AstImportDecl *id = &node->ImportDecl;
+		u64 h = build_cache__hash_u64(0xcbf29ce484222325ull, id->is_using);
+		h = build_cache__hash_string(h, id->fullpath);
+		h = build_cache__hash_string(h, id->import_name.string);
+		hash += h;
+	}
+	if (f->scope != nullptr) {
+		for_array(i, f->scope->elements.entries) {
+			Entity *e = f->scope->elements.entries[i].value;
+			if (e->kind != Entity_LibraryName) {
+				continue;
+			}
+			u64 h = build_cache__hash_string(0xcbf29ce484222325ull, e->token.string);
+			for_array(j, e->LibraryName.paths) {
+				h = build_cache__hash_string(h, e->LibraryName.paths[j]);
+			}
+			hash += h;
+		}
+	}
+	map_set(&g->import_hashes, hash_pointer(f), hash);
+	return hash;
+}
+
+u64 decl_graph_source_hash(DeclGraph *g, CheckerInfo *info, Entity *e) {
+	AstFile **found = map_get(&info->files, hash_string(e->token.pos.file));
+	if (found == nullptr) {
+		return 0;
+	}
+	AstFile *f = *found;
+	Tokenizer *t = &f->tokenizer;
+	isize offset = e->token.pos.offset;
+
+	// NOTE: The file level declarations are in source order
+	isize start = 0;
+	isize end = t->end - t->start;
+	for_array(i, f->decls) {
+		isize decl_start = decl_graph__decl_start(f->decls[i]);
+		if (decl_start <= offset) {
+			start = decl_start;
+		} else {
+			end = decl_start;
+			break;
+		}
+	}
+	u64 h = build_cache__hash_u64(0xcbf29ce484222325ull, e->kind);
+	h = build_cache__hash_u64(h, decl_graph__imports_hash(g, f));
+	return build_cache__hash(h, t->start+start, end-start);
+}
+
+void decl_graph__collect_scope(DeclGraph *g, CheckerInfo *info, Scope *s, String path, Map<bool> *collisions) {
+	for_array(i, s->elements.entries) {
+		Entity *e = s->elements.entries[i].value;
+		if (!decl_graph_is_tracked(e) || map_get(&g->entity_keys, hash_entity(e)) != nullptr) {
+			continue;
+		}
+		String name = e->token.string;
+		isize len = path.len + 1 + name.len;
+		u8 *text = gb_alloc_array(heap_allocator(), u8, len+1);
+		gb_snprintf(cast(char *)text, len+1, "%.*s.%.*s", LIT(path), LIT(name));
+		String key = make_string(text, len);
+		if (map_get(&g->entity_map, hash_string(key)) != nullptr) {
+			// NOTE: Neither of the declarations with the same key is tracked
+			map_set(collisions, hash_string(key), true);
+			continue;
+		}
+
+		array_add(&g->entities, e);
+		map_set(&g->entity_map, hash_string(key), e);
+		map_set(&g->entity_keys, hash_entity(e), key);
+		map_set(&g->entity_hashes, hash_entity(e), decl_graph_source_hash(g, info, e));
+	}
+}
+
+void decl_graph_collect(DeclGraph *g, Checker *c) {
+	if (g->collected) {
+		return;
+	}
+	g->collected = true;
+
+	Map<bool> collisions = {}; // Key: String (key)
+	map_init(&collisions, heap_allocator());
+	defer (map_destroy(&collisions));
+
+	for_array(i, c->parser->packages) {
+		AstPackage *pkg = c->parser->packages[i];
+		if (pkg->scope == nullptr) {
+			continue;
+		}
+		decl_graph__collect_scope(g, &c->info, pkg->scope, pkg->fullpath, &collisions);
+		for_array(j, pkg->files) {
+			AstFile *f = pkg->files[j];
+			if (f->scope != nullptr) {
+				decl_graph__collect_scope(g, &c->info, f->scope, f->fullpath, &collisions);
+			}
+		}
+	}
+
+	isize count = 0;
+	for_array(i, g->entities) {
+		Entity *e = g->entities[i];
+		String key = *map_get(&g->entity_keys, hash_entity(e));
+		if (map_get(&collisions, hash_string(key)) != nullptr) {
+			map_remove(&g->entity_map, hash_string(key));
+			map_remove(&g->entity_keys, hash_entity(e));
+			continue;
+		}
+		g->entities[count++] = e;
+	}
+	array_resize(&g->entities, count);
+}
+
+// NOTE: Called before the procedure bodies are checked, only with 'odin check -incremental'
+void decl_graph_skip_unchanged_procedures(DeclGraph *g, Checker *c) {
+	decl_graph_collect(g, c);
+	if (!g->has_prev || build_context.vet) {
+		// NOTE: -vet reports the imports and variables which no procedure body uses
+		return;
+	}
+
+	// NOTE: Packages which have gained a name, see the note at the top of the file
+	PtrSet<AstPackage *> new_names = {};
+	ptr_set_init(&new_names, heap_allocator());
+	defer (ptr_set_destroy(&new_names));
+	for_array(i, g->entities) {
+		Entity *e = g->entities[i];
+		String key = *map_get(&g->entity_keys, hash_entity(e));
+		if (map_get(&g->prev_map, hash_string(key)) == nullptr) {
+			ptr_set_add(&new_names, e->pkg);
+		}
+	}
+
+	// NOTE: The declarations which changed themselves, then everything which depends on
+	// them in the previous graph
+	auto queue = array_make<isize>(heap_allocator(), 0, g->prev_nodes.count);
+	defer (array_free(&queue));
+	for_array(i, g->prev_nodes) {
+		DeclGraphNode *n = &g->prev_nodes[i];
+		Entity **found = map_get(&g->entity_map, hash_string(n->key));
+		if (found == nullptr) {
+			n->changed = true;
+		} else {
+			Entity *e = *found;
+			u64 hash = *map_get(&g->entity_hashes, hash_entity(e));
+			n->changed = hash != n->hash || ptr_set_exists(&new_names, e->pkg);
+		}
+		if (n->changed) {
+			array_add(&queue, i);
+		}
+	}
+
+	Map<isize> dependents = {}; // NOTE: Multi map, Key: String (key of the dependency)
+	map_init(&dependents, heap_allocator());
+	defer (map_destroy(&dependents));
+	for_array(i, g->prev_nodes) {
+		DeclGraphNode *n = &g->prev_nodes[i];
+		for_array(j, n->deps) {
+			multi_map_insert(&dependents, hash_string(n->deps[j]), i);
+		}
+	}
+	for (isize i = 0; i < queue.count; i++) {
+		DeclGraphNode *n = &g->prev_nodes[queue[i]];
+		auto *entry = multi_map_find_first(&dependents, hash_string(n->key));
+		while (entry != nullptr) {
+			DeclGraphNode *d = &g->prev_nodes[entry->value];
+			if (!d->changed) {
+				d->changed = true;
+				array_add(&queue, entry->value);
+			}
+			entry = multi_map_find_next(&dependents, entry);
+		}
+	}
+
+	// NOTE: 'DeclInfo.entity' is not set for every declaration
+	Map<isize> decl_nodes = {}; // Key: DeclInfo *, Value: index into 'prev_nodes'
+	map_init(&decl_nodes, heap_allocator());
+	defer (map_destroy(&decl_nodes));
+	for_array(i, g->entities) {
+		Entity *e = g->entities[i];
+		String key = *map_get(&g->entity_keys, hash_entity(e));
+		isize *index = map_get(&g->prev_map, hash_string(key));
+		if (index != nullptr) {
+			map_set(&decl_nodes, hash_decl_info(e->decl_info), *index);
+		}
+	}
+
+	isize count = 0;
+	for_array(i, c->procs_to_check) {
+		ProcInfo pi = c->procs_to_check[i];
+		DeclInfo *decl = pi.decl;
+		isize *index = decl != nullptr ? map_get(&decl_nodes, hash_decl_info(decl)) : nullptr;
+		if (pi.generated_from_polymorphic || index == nullptr || g->prev_nodes[*index].changed) {
+			c->procs_to_check[count++] = pi;
+			continue;
+		}
+
+		DeclGraphNode *n = &g->prev_nodes[*index];
+		for_array(j, n->deps) {
+			Entity **dep = map_get(&g->entity_map, hash_string(n->deps[j]));
+			GB_ASSERT(dep != nullptr); // NOTE: Otherwise this would have been changed
+			add_dependency(decl, *dep);
+		}
+		n->skipped = true;
+		g->skipped_count += 1;
+	}
+	array_resize(&c->procs_to_check, count);
+}
+
+GB_COMPARE_PROC(decl_graph__string_cmp) {
+	String const &x = *cast(String const *)a;
+	String const &y = *cast(String const *)b;
+	// NOTE: Not 'string_compare' as that is only meant to be used for equality
+	int cmp = gb_memcompare(x.text, y.text, gb_min(x.len, y.len));
+	if (cmp == 0) {
+		cmp = x.len < y.len ? -1 : x.len > y.len;
+	}
+	return cmp;
+}
+
+// NOTE: Only called when the checker reported no errors or warnings
+void decl_graph_save(DeclGraph *g, Checker *c) {
+	decl_graph_collect(g, c);
+
+	char *c_path = alloc_cstring(heap_allocator(), g->path);
+	defer (gb_free(heap_allocator(), c_path));
+
+	gbFile f = {};
+	if (gb_file_create(&f, c_path) != gbFileError_None) {
+		return;
+	}
+	defer (gb_file_close(&f));
+
+	gbAllocator a = heap_allocator();
+	String settings = build_cache__hex(a, g->settings_hash);
+	defer (gb_free(a, settings.text));
+	gb_fprintf(&f, "odin-decl-graph %d %.*s\n", DECL_GRAPH_VERSION, LIT(settings));
+
+	auto deps = array_make<String>(a, 0, 16);
+	defer (array_free(&deps));
+	// NOTE: Sorted so that the graph does not depend upon the order of checking
+	auto keys = array_make<String>(a, 0, g->entities.count);
+	defer (array_free(&keys));
+	for_array(i, g->entities) {
+		array_add(&keys, *map_get(&g->entity_keys, hash_entity(g->entities[i])));
+	}
+	gb_sort_array(keys.data, keys.count, decl_graph__string_cmp);
+
+	for_array(i, keys) {
+		String key = keys[i];
+		Entity *e = *map_get(&g->entity_map, hash_string(key));
+		String hash = build_cache__hex(a, *map_get(&g->entity_hashes, hash_entity(e)));
+		gb_fprintf(&f, "decl %.*s %.*s\n", LIT(hash), LIT(key));
+		gb_free(a, hash.text);
+
+		DeclInfo *decl = e->decl_info;
+		array_clear(&deps);
+		for_array(j, decl->deps.entries) {
+			String *dep = map_get(&g->entity_keys, hash_entity(decl->deps.entries[j].ptr));
+			if (dep != nullptr) {
+				array_add(&deps, *dep);
+			}
+		}
+		gb_sort_array(deps.data, deps.count, decl_graph__string_cmp);
+		for_array(j, deps) {
+			gb_fprintf(&f, "dep %.*s\n", LIT(deps[j]));
+		}
+
+		array_clear(&deps);
+		isize *index = map_get(&g->prev_map, hash_string(key));
+		if (index != nullptr && g->prev_nodes[*index].skipped) {
+			// NOTE: The types used by the body of a skipped procedure are not known
+			Array<String> types = g->prev_nodes[*index].types;
+			for_array(j, types) {
+				array_add(&deps, types[j]);
+			}
+		}
+		for_array(j, decl->type_info_deps.entries) {
+			Type *t = decl->type_info_deps.entries[j].ptr;
+			array_add(&deps, make_string_c(type_to_string(t)));
+		}
+		gb_sort_array(deps.data, deps.count, decl_graph__string_cmp);
+		for_array(j, deps) {
+			if (j == 0 || deps[j] != deps[j-1]) {
+				gb_fprintf(&f, "type %.*s\n", LIT(deps[j]));
+			}
+		}
+	}
+}
+
+void decl_graph_print_stats(DeclGraph *g) {
+	gb_printf("Declaration graph\n");
+	gb_printf("Declarations - %td\n", g->entities.count);
+	gb_printf("Skipped      - %td procedure bodies\n", g->skipped_count);
+	gb_printf("\n");
+}
@@ -197,17 +197,30 @@ bool entity_has_deferred_procedure(Entity *e) {
 }
 
 
-gb_global u64 global_entity_id = 0;
+gb_global gbAtomic64 global_entity_id = {0};
+
+gb_global Arena global_entity_arena = {};
+
+gbAllocator entity_allocator(void) {
+	Arena *arena = &global_entity_arena;
+	return arena_allocator(arena);
+}
 
 Entity *alloc_entity(EntityKind kind, Scope *scope, Token token, Type *type) {
-	gbAllocator a = heap_allocator();
+	gbAllocator a = entity_allocator();
 	Entity *entity = gb_alloc_item(a, Entity);
 	entity->kind   = kind;
 	entity->state  = EntityState_Unresolved;
 	entity->scope  = scope;
 	entity->token  = token;
 	entity->type   = type;
-	entity->id     = ++global_entity_id;
+	entity->id     = cast(u64)gb_atomic64_fetch_add(&global_entity_id, 1) + 1;
+	if (thread_checker_record != nullptr) {
+		// NOTE: The id is handed out again when the procedure body is merged
+		CheckerRecordItem item = {CheckerRecord_Alloc};
+		item.entity = entity;
+		array_add(&thread_checker_record->items, item);
+	}
 	return entity;
 }
 
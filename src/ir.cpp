@@ -22,6 +22,7 @@ struct irModule {
 	Map<irValue *>        values;              // Key: Entity *
 	Map<irValue *>        members;             // Key: String
 	Map<String>           entity_names;        // Key: Entity * of the typename
+	Map<Entity *>         stable_names;        // Key: String, only with -incremental
 	Map<irDebugInfo *>    debug_info;          // Key: Unique pointer
 	Map<irValue *>        anonymous_proc_lits; // Key: Ast *
 
@@ -180,6 +181,8 @@ gbAllocator ir_allocator(void) {
 		i64          alignment;                                       \
 	})                                                                \
 	IR_INSTR_KIND(ZeroInit, struct { irValue *address; })             \
+	IR_INSTR_KIND(MemZero,  struct { irValue *address; i64 size, align; }) \
+	IR_INSTR_KIND(MemMove,  struct { irValue *dst, *src; i64 size, align; }) \
 	IR_INSTR_KIND(Store,    struct { irValue *address, *value; })     \
 	IR_INSTR_KIND(Load,     struct { Type *type; irValue *address; }) \
 	IR_INSTR_KIND(AtomicFence, struct { BuiltinProcId id; })          \
@@ -239,6 +242,12 @@ gbAllocator ir_allocator(void) {
 		irBlock *true_block;                                          \
 		irBlock *false_block;                                         \
 	})                                                                \
+	IR_INSTR_KIND(Switch, struct {                                    \
+		irValue *        value;                                       \
+		irBlock *        default_block;                               \
+		Array<irValue *> case_values; /* constants */                 \
+		Array<irBlock *> case_blocks;                                 \
+	})                                                                \
 	IR_INSTR_KIND(Return, struct { irValue *value; })                 \
 	IR_INSTR_KIND(Select, struct {                                    \
 		irValue *cond;                                                \
@@ -679,6 +688,33 @@ struct irGen {
 	String   output_base;
 	String   output_name;
 	bool     print_chkstk;
+	i64      byte_count; // NOTE: Bytes of LLVM IR printed over every codegen unit
+};
+
+// NOTE: With '-codegen-units:N', the procedures are split between N LLVM modules which are
+// printed and compiled concurrently. Every module declares what it uses from the others.
+struct irCodegenUnit {
+	irGen *          ir;
+	isize            index;
+	String           output_base;
+	gbFile           output_file;
+
+	Array<irValue *> members;    // NOTE: Every member of the module, sorted by name with -incremental
+	Array<irValue *> procs;      // NOTE: Every procedure with a body, in member order
+	isize            proc_begin; // NOTE: 'procs[proc_begin..proc_end]' are defined in this unit
+	isize            proc_end;
+
+	// NOTE: Constants needing their own global are only created whilst printing, so each
+	// unit keeps private ones rather than adding to the module which is shared between threads
+	Array<irValue *> globals;
+	i32              global_index;
+
+	i64              byte_count;
+	u64              ir_hash; // NOTE: Only with -incremental, see build_cache.cpp
+
+	// NOTE: With -llvm-api, the module is printed into memory and compiled straight after
+	Array<u8>        llvm_ir;
+	bool             failed;
 };
 
 
@@ -991,6 +1027,25 @@ irValue *ir_instr_zero_init(irProcedure *p, irValue *address) {
 	return v;
 }
 
+irValue *ir_instr_mem_zero(irProcedure *p, irValue *address, i64 size, i64 align) {
+	irValue *v = ir_alloc_instr(p, irInstr_MemZero);
+	irInstr *i = &v->Instr;
+	i->MemZero.address = address;
+	i->MemZero.size    = size;
+	i->MemZero.align   = align;
+	return v;
+}
+
+irValue *ir_instr_mem_move(irProcedure *p, irValue *dst, irValue *src, i64 size, i64 align) {
+	irValue *v = ir_alloc_instr(p, irInstr_MemMove);
+	irInstr *i = &v->Instr;
+	i->MemMove.dst   = dst;
+	i->MemMove.src   = src;
+	i->MemMove.size  = size;
+	i->MemMove.align = align;
+	return v;
+}
+
 irValue *ir_instr_store(irProcedure *p, irValue *address, irValue *value) {
 	irValue *v = ir_alloc_instr(p, irInstr_Store);
 	irInstr *i = &v->Instr;
@@ -1179,6 +1234,16 @@ irValue *ir_instr_if(irProcedure *p, irValue *cond, irBlock *true_block, irBlock
 	return v;
 }
 
+irValue *ir_instr_switch(irProcedure *p, irValue *value, irBlock *default_block, Array<irValue *> case_values, Array<irBlock *> case_blocks) {
+	irValue *v = ir_alloc_instr(p, irInstr_Switch);
+	irInstr *i = &v->Instr;
+	i->Switch.value         = value;
+	i->Switch.default_block = default_block;
+	i->Switch.case_values   = case_values;
+	i->Switch.case_blocks   = case_blocks;
+	return v;
+}
+
 
 irValue *ir_instr_phi(irProcedure *p, Array<irValue *> edges, Type *type) {
 	irValue *v = ir_alloc_instr(p, irInstr_Phi);
@@ -1434,7 +1499,7 @@ irDefer ir_add_defer_instr(irProcedure *proc, isize scope_index, irValue *instr)
 
 
 
-irValue *ir_add_module_constant(irModule *m, Type *type, ExactValue value) {
+irValue *ir_add_module_constant(irModule *m, Type *type, ExactValue value, irCodegenUnit *unit=nullptr) {
 	gbAllocator a = ir_allocator();
 
 	if (is_type_slice(type)) {
@@ -1446,20 +1511,31 @@ irValue *ir_add_module_constant(irModule *m, Type *type, ExactValue value) {
 		}
 		Type *elem = base_type(type)->Slice.elem;
 		Type *t = alloc_type_array(elem, count);
-		irValue *backing_array = ir_add_module_constant(m, t, value);
+		irValue *backing_array = ir_add_module_constant(m, t, value, unit);
 
 
-		isize max_len = 7+8+1;
+		isize max_len = 7+8+1+8+1;
 		u8 *str = cast(u8 *)gb_alloc_array(a, u8, max_len);
-		isize len = gb_snprintf(cast(char *)str, max_len, "csba$%x", m->global_array_index);
-		m->global_array_index++;
+		isize len = 0;
+		if (unit != nullptr) {
+			len = gb_snprintf(cast(char *)str, max_len, "csba$%x$%x", cast(i32)unit->index, unit->global_index);
+			unit->global_index++;
+		} else {
+			len = gb_snprintf(cast(char *)str, max_len, "csba$%x", m->global_array_index);
+			m->global_array_index++;
+		}
 
 		String name = make_string(str, len-1);
 
 		Entity *e = alloc_entity_constant(nullptr, make_token_ident(name), t, value);
 		irValue *g = ir_value_global(e, backing_array);
-		ir_module_add_value(m, e, g);
-		map_set(&m->members, hash_string(name), g);
+		if (unit != nullptr) {
+			g->Global.is_private = true;
+			array_add(&unit->globals, g);
+		} else {
+			ir_module_add_value(m, e, g);
+			map_set(&m->members, hash_string(name), g);
+		}
 
 		return ir_value_constant_slice(type, g, count);
 	}
@@ -1467,11 +1543,17 @@ irValue *ir_add_module_constant(irModule *m, Type *type, ExactValue value) {
 	return ir_value_constant(type, value);
 }
 
-irValue *ir_add_global_string_array(irModule *m, String string) {
-	isize max_len = 6+8+1;
+irValue *ir_add_global_string_array(irModule *m, String string, irCodegenUnit *unit=nullptr) {
+	isize max_len = 6+8+1+8+1;
 	u8 *str = cast(u8 *)gb_alloc_array(ir_allocator(), u8, max_len);
-	isize len = gb_snprintf(cast(char *)str, max_len, "str$%x", m->global_string_index);
-	m->global_string_index++;
+	isize len = 0;
+	if (unit != nullptr) {
+		len = gb_snprintf(cast(char *)str, max_len, "str$%x$%x", cast(i32)unit->index, unit->global_index);
+		unit->global_index++;
+	} else {
+		len = gb_snprintf(cast(char *)str, max_len, "str$%x", m->global_string_index);
+		m->global_string_index++;
+	}
 
 	String name = make_string(str, len-1);
 	Token token = {Token_String};
@@ -1479,13 +1561,17 @@ irValue *ir_add_global_string_array(irModule *m, String string) {
 	Type *type = alloc_type_array(t_u8, string.len+1);
 	ExactValue ev = exact_value_string(string);
 	Entity *entity = alloc_entity_constant(nullptr, token, type, ev);
-	irValue *g = ir_value_global(entity, ir_add_module_constant(m, type, ev));
+	irValue *g = ir_value_global(entity, ir_add_module_constant(m, type, ev, unit));
 	g->Global.is_private      = true;
 	g->Global.is_unnamed_addr = true;
 	// g->Global.is_constant = true;
 
-	ir_module_add_value(m, entity, g);
-	map_set(&m->members, hash_string(name), g);
+	if (unit != nullptr) {
+		array_add(&unit->globals, g);
+	} else {
+		ir_module_add_value(m, entity, g);
+		map_set(&m->members, hash_string(name), g);
+	}
 
 	return g;
 }
@@ -2683,6 +2769,12 @@ irValue *ir_emit_runtime_call(irProcedure *proc,                            char
 irValue *ir_emit_package_call(irProcedure *proc, char const *package_name_, char const *name_, Array<irValue *> args, Ast *expr = nullptr, ProcInlining inlining = ProcInlining_none);
 
 
+// NOTE: Values larger than this are zeroed and copied with 'llvm.memset' and 'llvm.memmove'
+// rather than as first-class aggregates, which LLVM splits into a load and store for every element
+bool ir_is_large_value(Type *t) {
+	return type_size_of(t) > build_context.max_align;
+}
+
 irValue *ir_emit_store(irProcedure *p, irValue *address, irValue *value) {
 	Type *a = type_deref(ir_type(address));
 
@@ -2695,6 +2787,17 @@ irValue *ir_emit_store(irProcedure *p, irValue *address, irValue *value) {
 	if (!is_type_untyped(b)) {
 		GB_ASSERT_MSG(are_types_identical(core_type(a), core_type(b)), "%s %s", type_to_string(a), type_to_string(b));
 	}
+
+	// NOTE: A large value which has just been loaded is copied straight from its address, as
+	// nothing can have written to that memory in between. The two may overlap (e.g. 'a[i] = a[j]'
+	// or through pointers), hence 'llvm.memmove'
+	if (value->kind == irValue_Instr && value->Instr.kind == irInstr_Load &&
+	    ir_is_large_value(a) && p->curr_block != nullptr &&
+	    ir_get_last_instr(p->curr_block) == &value->Instr) {
+		irValue *dst = ir_emit_conv(p, address, t_rawptr);
+		irValue *src = ir_emit_conv(p, value->Instr.Load.address, t_rawptr);
+		return ir_emit(p, ir_instr_mem_move(p, dst, src, type_size_of(a), type_align_of(a)));
+	}
 	return ir_emit(p, ir_instr_store(p, address, value));
 }
 irValue *ir_emit_load(irProcedure *p, irValue *address) {
@@ -2738,18 +2841,13 @@ void ir_value_set_debug_location(irProcedure *proc, irValue *v) {
 }
 
 void ir_emit_zero_init(irProcedure *p, irValue *address, Ast *expr) {
-	gbAllocator a = ir_allocator();
 	Type *t = type_deref(ir_type(address));
-	isize sz = type_size_of(t);
-	if (!(gb_is_power_of_two(sz) && sz <= build_context.max_align)) {
-		// TODO(bill): Is this a good idea?
-		auto args = array_make<irValue *>(a, 2);
-		args[0] = ir_emit_conv(p, address, t_rawptr);
-		args[1] = ir_const_int(type_size_of(t));
-		AstPackage *pkg = get_core_package(p->module->info, str_lit("mem"));
-		if (p->entity != nullptr && p->entity->token.string != "zero" && p->entity->pkg != pkg) {
-			irValue *v = ir_emit_package_call(p, "mem", "zero", args, expr, ProcInlining_no_inline);
-		}
+	i64 sz = type_size_of(t);
+	if (sz > 0 && (ir_is_large_value(t) || !gb_is_power_of_two(sz))) {
+		// NOTE: Unlike a store of 'zeroinitializer', this zeroes the padding too
+		irValue *ptr = ir_emit_conv(p, address, t_rawptr);
+		ir_emit(p, ir_instr_mem_zero(p, ptr, sz, type_align_of(t)));
+		return;
 	}
 	ir_emit(p, ir_instr_zero_init(p, address));
 }
@@ -3057,6 +3155,29 @@ void ir_emit_if(irProcedure *proc, irValue *cond, irBlock *true_block, irBlock *
 	ir_start_block(proc, nullptr);
 }
 
+void ir_emit_switch(irProcedure *proc, irValue *value, irBlock *default_block, Array<irValue *> case_values, Array<irBlock *> case_blocks) {
+	irBlock *b = proc->curr_block;
+	if (b == nullptr) {
+		return;
+	}
+	ir_emit(proc, ir_instr_switch(proc, value, default_block, case_values, case_blocks));
+	ir_add_edge(b, default_block);
+	for_array(i, case_blocks) {
+		// NOTE: Many values may go to the same block, but there is only one edge
+		bool found = false;
+		for_array(j, b->succs) {
+			if (b->succs[j] == case_blocks[i]) {
+				found = true;
+				break;
+			}
+		}
+		if (!found) {
+			ir_add_edge(b, case_blocks[i]);
+		}
+	}
+	ir_start_block(proc, nullptr);
+}
+
 
 
 
@@ -5283,6 +5404,30 @@ void ir_emit_dynamic_array_bounds_check(irProcedure *proc, Token token, irValue
 //
 ////////////////////////////////////////////////////////////////
 
+u64 build_cache__hash(u64 h, void const *data, isize len); // NOTE: See build_cache.cpp
+
+// NOTE: Entity ids depend on the order in which everything was checked, so with -incremental the
+// suffix of a name is derived from 'seed' instead, which keeps the LLVM IR of an unchanged codegen
+// unit the same between builds. A clash with another entity's name bumps the suffix.
+u64 ir_stable_name_id(irModule *m, Entity *e, String prefix, u64 seed) {
+	for (u64 id = seed & 0xffffffffull; ; id++) {
+		gbString str = gb_string_make_length(heap_allocator(), prefix.text, prefix.len);
+		str = gb_string_append_fmt(str, "-%llu", cast(unsigned long long)id);
+		String name = copy_string(ir_allocator(), make_string(cast(u8 *)str, gb_string_length(str)));
+		gb_string_free(str);
+
+		HashKey key = hash_string(name);
+		Entity **found = map_get(&m->stable_names, key);
+		if (found == nullptr) {
+			map_set(&m->stable_names, key, e);
+			return id;
+		}
+		if (*found == e) {
+			return id;
+		}
+	}
+}
+
 String ir_mangle_name(irGen *s, Entity *e) {
 	irModule *m = &s->module;
 	CheckerInfo *info = m->info;
@@ -5311,7 +5456,14 @@ String ir_mangle_name(irGen *s, Entity *e) {
 	if (require_suffix_id) {
 		char *str = cast(char *)new_name + new_name_len-1;
 		isize len = max_len-new_name_len;
-		isize extra = gb_snprintf(str, len, "-%llu", cast(unsigned long long)e->id);
+		u64 id = e->id;
+		if (build_context.incremental) {
+			gbString ts = type_to_string(e->type);
+			u64 seed = build_cache__hash(0xcbf29ce484222325ull, ts, gb_string_length(ts));
+			gb_string_free(ts);
+			id = ir_stable_name_id(m, e, make_string(new_name, new_name_len-1), seed);
+		}
+		isize extra = gb_snprintf(str, len, "-%llu", cast(unsigned long long)id);
 		new_name_len += extra-1;
 	}
 
@@ -5338,7 +5490,14 @@ void ir_mangle_add_sub_type_name(irModule *m, Entity *field, String parent) {
 	if (require_suffix_id) {
 		char *str = cast(char *)new_name + new_name_len-1;
 		isize len = max_len-new_name_len;
-		isize extra = gb_snprintf(str, len, "-%llu", cast(unsigned long long)field->id);
+		u64 id = field->id;
+		if (build_context.incremental) {
+			gbString ts = type_to_string(field->type);
+			u64 seed = build_cache__hash(0xcbf29ce484222325ull, ts, gb_string_length(ts));
+			gb_string_free(ts);
+			id = ir_stable_name_id(m, field, make_string(new_name, new_name_len-1), seed);
+		}
+		isize extra = gb_snprintf(str, len, "-%llu", cast(unsigned long long)id);
 		new_name_len += extra-1;
 	}
 
@@ -7548,10 +7707,15 @@ void ir_build_constant_value_decl(irProcedure *proc, AstValueDecl *vd) {
 			String ts_name = e->token.string;
 
 			irModule *m = proc->module;
-			isize name_len = proc->name.len + 1 + ts_name.len + 1 + 10 + 1;
-			u8 *name_text = gb_alloc_array(ir_allocator(), u8, name_len);
-			i32 guid = cast(i32)m->members.entries.count;
-			name_len = gb_snprintf(cast(char *)name_text, name_len, "%.*s.%.*s-%d", LIT(proc->name), LIT(ts_name), guid);
+			isize max_len = proc->name.len + 1 + ts_name.len + 1 + 20 + 1;
+			u8 *name_text = gb_alloc_array(ir_allocator(), u8, max_len);
+			u64 guid = cast(u64)m->members.entries.count;
+			if (build_context.incremental) {
+				// NOTE: The member count depends on everything generated before this procedure
+				isize prefix_len = gb_snprintf(cast(char *)name_text, max_len, "%.*s.%.*s", LIT(proc->name), LIT(ts_name));
+				guid = ir_stable_name_id(m, e, make_string(name_text, prefix_len-1), 0);
+			}
+			isize name_len = gb_snprintf(cast(char *)name_text, max_len, "%.*s.%.*s-%llu", LIT(proc->name), LIT(ts_name), cast(unsigned long long)guid);
 
 			String name = make_string(name_text, name_len-1);
 
@@ -7595,6 +7759,7 @@ void ir_build_constant_value_decl(irProcedure *proc, AstValueDecl *vd) {
 
 				value->Proc.tags = pl->tags;
 				value->Proc.inlining = pl->inlining;
+				value->Proc.is_foreign = e->Procedure.is_foreign;
 
 				ir_module_add_value(proc->module, e, value);
 				ir_build_proc(value, proc);
@@ -7819,17 +7984,39 @@ void ir_build_range_string(irProcedure *proc, irValue *expr, Type *val_type,
 
 
 	irValue *str_elem = ir_emit_ptr_offset(proc, ir_string_elem(proc, expr), offset);
+	irValue *rune_ = ir_add_local_generated(proc, t_rune, false);
+	irValue *len_  = ir_add_local_generated(proc, t_int, false);
+
+	// NOTE: ASCII is decoded inline, only the multi-byte sequences call 'string_decode_rune'
+	irBlock *ascii  = ir_new_block(proc, nullptr, "for.string.ascii");
+	irBlock *decode = ir_new_block(proc, nullptr, "for.string.decode");
+	irBlock *next   = ir_new_block(proc, nullptr, "for.string.next");
+
+	irValue *first = ir_emit_load(proc, str_elem);
+	ir_emit_if(proc, ir_emit_comp(proc, Token_Lt, first, ir_const_u8(0x80)), ascii, decode);
+
+	ir_start_block(proc, ascii);
+	ir_emit_store(proc, rune_, ir_emit_conv(proc, first, t_rune));
+	ir_emit_store(proc, len_, v_one);
+	ir_emit_jump(proc, next);
+
+	ir_start_block(proc, decode);
 	irValue *str_len  = ir_emit_arith(proc, Token_Sub, count, offset, t_int);
 	auto args = array_make<irValue *>(ir_allocator(), 1);
 	args[0] = ir_emit_string(proc, str_elem, str_len);
 	irValue *rune_and_len = ir_emit_runtime_call(proc, "string_decode_rune", args);
-	irValue *len  = ir_emit_struct_ev(proc, rune_and_len, 1);
+	ir_emit_store(proc, rune_, ir_emit_struct_ev(proc, rune_and_len, 0));
+	ir_emit_store(proc, len_,  ir_emit_struct_ev(proc, rune_and_len, 1));
+	ir_emit_jump(proc, next);
+
+	ir_start_block(proc, next);
+	irValue *len = ir_emit_load(proc, len_);
 	ir_emit_store(proc, offset_, ir_emit_arith(proc, Token_Add, offset, len, t_int));
 
 
 	idx = offset;
 	if (val_type != nullptr) {
-		val = ir_emit_struct_ev(proc, rune_and_len, 0);
+		val = ir_emit_load(proc, rune_);
 	}
 
 	if (val_)  *val_  = val;
@@ -7968,6 +8155,333 @@ void ir_type_case_body(irProcedure *proc, Ast *label, Ast *clause, irBlock *body
 }
 
 
+// NOTE: The integer type of a switch tag which can be lowered to an 'irInstr_Switch', otherwise nullptr
+Type *ir_switch_instr_type(Type *t) {
+	t = core_type(t);
+	if (t->kind == Type_Enum) {
+		t = core_type(t->Enum.base_type);
+	}
+	if (!is_type_integer(t) || type_size_of(t) > 8 || is_type_different_to_arch_endianness(t)) {
+		return nullptr;
+	}
+	return t;
+}
+
+bool ir_is_constant_switch_case(Ast *expr) {
+	return expr->tav.mode == Addressing_Constant && expr->tav.value.kind == ExactValue_Integer;
+}
+
+// NOTE: Whether every case of the switch is an integer (or enum) constant or a range of them
+bool ir_is_constant_switch_stmt(AstSwitchStmt *ss, irValue *tag) {
+	if (ss->tag == nullptr || ir_switch_instr_type(ir_type(tag)) == nullptr) {
+		return false;
+	}
+	ast_node(body, BlockStmt, ss->body);
+	isize value_count = 0;
+	for_array(i, body->stmts) {
+		ast_node(cc, CaseClause, body->stmts[i]);
+		for_array(j, cc->list) {
+			Ast *expr = unparen_expr(cc->list[j]);
+			if (is_ast_range(expr)) {
+				ast_node(ie, BinaryExpr, expr);
+				if (ie->op.kind != Token_Ellipsis || !ir_is_constant_switch_case(ie->left) || !ir_is_constant_switch_case(ie->right)) {
+					return false;
+				}
+			} else if (!ir_is_constant_switch_case(expr)) {
+				return false;
+			}
+			value_count += 1;
+		}
+	}
+	return value_count > 0;
+}
+
+// NOTE: Ranges with more values than this are compared against rather than put in the switch
+#define IR_SWITCH_MAX_RANGE_VALUES 256
+
+struct irSwitchRange {
+	u64      lo, hi;
+	irBlock *body;
+};
+
+bool ir_switch_value_lt(u64 a, u64 b, bool is_unsigned) {
+	if (is_unsigned) {
+		return a < b;
+	}
+	return cast(i64)a < cast(i64)b;
+}
+
+u64 ir_switch_value(ExactValue v, bool is_unsigned) {
+	if (is_unsigned) {
+		return big_int_to_u64(&v.value_integer);
+	}
+	return cast(u64)big_int_to_i64(&v.value_integer);
+}
+
+// NOTE: The body block of every clause of a switch which is not lowered to a chain of
+// comparisons, returns the block of the default clause (or 'done')
+irBlock *ir_new_switch_case_bodies(irProcedure *proc, AstSwitchStmt *ss, Array<irBlock *> *bodies, irBlock *done) {
+	ast_node(body, BlockStmt, ss->body);
+	irBlock *default_block = done;
+	for_array(i, body->stmts) {
+		Ast *clause = body->stmts[i];
+		ast_node(cc, CaseClause, clause);
+		if (cc->list.count == 0) {
+			default_block = ir_new_block(proc, clause, "switch.dflt.body");
+			array_add(bodies, default_block);
+		} else {
+			array_add(bodies, ir_new_block(proc, clause, "switch.case.body"));
+		}
+	}
+	return default_block;
+}
+
+void ir_build_switch_case_bodies(irProcedure *proc, AstSwitchStmt *ss, Array<irBlock *> bodies, irBlock *done) {
+	ast_node(body, BlockStmt, ss->body);
+	for_array(i, body->stmts) {
+		ast_node(cc, CaseClause, body->stmts[i]);
+		irBlock *fall = i+1 < bodies.count ? bodies[i+1] : done;
+
+		ir_start_block(proc, bodies[i]);
+		ir_push_target_list(proc, ss->label, done, nullptr, fall);
+		ir_open_scope(proc);
+		ir_build_stmt_list(proc, cc->stmts);
+		ir_close_scope(proc, irDeferExit_Default, bodies[i]);
+		ir_pop_target_list(proc);
+
+		ir_emit_jump(proc, done);
+	}
+	ir_start_block(proc, done);
+}
+
+// NOTE: A switch whose cases are all constants is lowered to an LLVM 'switch', so that LLVM
+// can use a jump table or a binary search rather than the chain of comparisons of a general
+// switch. Ranges are expanded into their values, unless they are large; those are compared
+// against in the default block of the switch, before the default case.
+void ir_build_constant_switch_stmt(irProcedure *proc, AstSwitchStmt *ss, irValue *tag, irBlock *done) {
+	ast_node(body, BlockStmt, ss->body);
+	Type *tag_type = ir_type(tag);
+	bool is_unsigned = is_type_unsigned(ir_switch_instr_type(tag_type));
+	isize case_count = body->stmts.count;
+
+	auto bodies = array_make<irBlock *>(heap_allocator(), 0, case_count);
+	defer (array_free(&bodies));
+	irBlock *default_block = ir_new_switch_case_bodies(proc, ss, &bodies, done);
+
+	auto case_values = array_make<irValue *>(heap_allocator(), 0, case_count);
+	auto case_blocks = array_make<irBlock *>(heap_allocator(), 0, case_count);
+	auto ranges = array_make<irSwitchRange>(heap_allocator(), 0, 0);
+	defer (array_free(&ranges));
+
+	// NOTE: A value belongs to the first case which has it, as with the comparison chain,
+	// as overlapping ranges are allowed
+	Map<bool> seen = {}; // Key: u64
+	map_init(&seen, heap_allocator());
+	defer (map_destroy(&seen));
+
+	for_array(i, body->stmts) {
+		ast_node(cc, CaseClause, body->stmts[i]);
+		for_array(j, cc->list) {
+			Ast *expr = unparen_expr(cc->list[j]);
+			u64 lo = 0, hi = 0;
+			if (is_ast_range(expr)) {
+				ast_node(ie, BinaryExpr, expr);
+				lo = ir_switch_value(ie->left->tav.value,  is_unsigned);
+				hi = ir_switch_value(ie->right->tav.value, is_unsigned);
+				if (ir_switch_value_lt(hi, lo, is_unsigned)) {
+					continue;
+				}
+				if (hi-lo >= IR_SWITCH_MAX_RANGE_VALUES) {
+					irSwitchRange r = {lo, hi, bodies[i]};
+					array_add(&ranges, r);
+					continue;
+				}
+			} else {
+				lo = hi = ir_switch_value(expr->tav.value, is_unsigned);
+			}
+
+			for (u64 v = lo; ; v++) {
+				bool found = map_get(&seen, hash_integer(v)) != nullptr;
+				for_array(k, ranges) {
+					found |= !ir_switch_value_lt(v, ranges[k].lo, is_unsigned) && !ir_switch_value_lt(ranges[k].hi, v, is_unsigned);
+				}
+				if (!found) {
+					map_set(&seen, hash_integer(v), true);
+					ExactValue value = is_unsigned ? exact_value_u64(v) : exact_value_i64(cast(i64)v);
+					array_add(&case_values, ir_value_constant(tag_type, value));
+					array_add(&case_blocks, bodies[i]);
+				}
+				if (v == hi) {
+					break;
+				}
+			}
+		}
+	}
+
+	if (ranges.count == 0) {
+		ir_emit_switch(proc, tag, default_block, case_values, case_blocks);
+	} else {
+		irBlock *range_block = ir_new_block(proc, nullptr, "switch.range");
+		ir_emit_switch(proc, tag, range_block, case_values, case_blocks);
+		ir_start_block(proc, range_block);
+		for_array(i, ranges) {
+			irSwitchRange r = ranges[i];
+			irValue *lo = ir_value_constant(tag_type, is_unsigned ? exact_value_u64(r.lo) : exact_value_i64(cast(i64)r.lo));
+			irValue *hi = ir_value_constant(tag_type, is_unsigned ? exact_value_u64(r.hi) : exact_value_i64(cast(i64)r.hi));
+			irValue *cond_lo = ir_emit_comp(proc, Token_LtEq, lo, tag);
+			irValue *cond_hi = ir_emit_comp(proc, Token_LtEq, tag, hi);
+			irValue *cond = ir_emit_arith(proc, Token_And, cond_lo, cond_hi, t_bool);
+			irBlock *next = ir_new_block(proc, nullptr, "switch.range.next");
+			ir_emit_if(proc, cond, r.body, next);
+			ir_start_block(proc, next);
+		}
+		ir_emit_jump(proc, default_block);
+	}
+
+	ir_build_switch_case_bodies(proc, ss, bodies, done);
+}
+
+// NOTE: Whether every case of the switch is a constant string
+bool ir_is_string_switch_stmt(AstSwitchStmt *ss, irValue *tag) {
+	if (ss->tag == nullptr || !is_type_string(ir_type(tag))) {
+		return false;
+	}
+	ast_node(body, BlockStmt, ss->body);
+	isize value_count = 0;
+	for_array(i, body->stmts) {
+		ast_node(cc, CaseClause, body->stmts[i]);
+		for_array(j, cc->list) {
+			Ast *expr = unparen_expr(cc->list[j]);
+			if (is_ast_range(expr) || expr->tav.mode != Addressing_Constant || expr->tav.value.kind != ExactValue_String) {
+				return false;
+			}
+			value_count += 1;
+		}
+	}
+	return value_count > 0;
+}
+
+struct irStringSwitchCase {
+	String   value;
+	u64      hash;
+	irBlock *body;
+	isize    index;
+};
+
+GB_COMPARE_PROC(ir_string_switch_case_cmp) {
+	irStringSwitchCase const *x = cast(irStringSwitchCase const *)a;
+	irStringSwitchCase const *y = cast(irStringSwitchCase const *)b;
+	if (x->value.len != y->value.len) {
+		return x->value.len < y->value.len ? -1 : +1;
+	}
+	if (x->hash != y->hash) {
+		return x->hash < y->hash ? -1 : +1;
+	}
+	return x->index < y->index ? -1 : x->index > y->index;
+}
+
+// NOTE: Compares against each case in turn, ending in 'default_block'
+void ir_emit_string_switch_compares(irProcedure *proc, irValue *str, Array<irStringSwitchCase> cases, irBlock *default_block) {
+	for_array(i, cases) {
+		irBlock *next = default_block;
+		if (i+1 < cases.count) {
+			next = ir_new_block(proc, nullptr, "switch.str.next");
+		}
+		irValue *cond = ir_emit_comp(proc, Token_CmpEq, str, ir_const_string(cases[i].value));
+		ir_emit_if(proc, cond, cases[i].body, next);
+		if (i+1 < cases.count) {
+			ir_start_block(proc, next);
+		}
+	}
+}
+
+// NOTE: A switch whose cases are all constant strings first switches on the length of the
+// string and then, when there is more than one case of that length, on its hash (the same as
+// 'default_hash_string' and computed for the cases here, as with 'ir_gen_map_key'). Only then is
+// the string compared against the case (or the few cases) with that length and hash.
+void ir_build_string_switch_stmt(irProcedure *proc, AstSwitchStmt *ss, irValue *tag, irBlock *done) {
+	ast_node(body, BlockStmt, ss->body);
+
+	auto bodies = array_make<irBlock *>(heap_allocator(), 0, body->stmts.count);
+	defer (array_free(&bodies));
+	irBlock *default_block = ir_new_switch_case_bodies(proc, ss, &bodies, done);
+
+	auto cases = array_make<irStringSwitchCase>(heap_allocator(), 0, body->stmts.count);
+	defer (array_free(&cases));
+	Map<bool> seen = {}; // Key: String
+	map_init(&seen, heap_allocator());
+	defer (map_destroy(&seen));
+	for_array(i, body->stmts) {
+		ast_node(cc, CaseClause, body->stmts[i]);
+		for_array(j, cc->list) {
+			String value = unparen_expr(cc->list[j])->tav.value.value_string;
+			if (map_get(&seen, hash_string(value)) != nullptr) {
+				continue;
+			}
+			map_set(&seen, hash_string(value), true);
+			irStringSwitchCase c = {value, fnv64a(value.text, value.len), bodies[i], cases.count};
+			array_add(&cases, c);
+		}
+	}
+	gb_sort_array(cases.data, cases.count, ir_string_switch_case_cmp);
+
+	irValue *str = ir_emit_conv(proc, tag, t_string);
+	irValue *len = ir_string_len(proc, str);
+
+	auto len_values = array_make<irValue *>(heap_allocator(), 0, cases.count);
+	auto len_blocks = array_make<irBlock *>(heap_allocator(), 0, cases.count);
+	for_array(i, cases) {
+		if (i == 0 || cases[i].value.len != cases[i-1].value.len) {
+			array_add(&len_values, ir_const_int(cases[i].value.len));
+			array_add(&len_blocks, ir_new_block(proc, nullptr, "switch.str.len"));
+		}
+	}
+	ir_emit_switch(proc, len, default_block, len_values, len_blocks);
+
+	isize lo = 0;
+	for_array(k, len_blocks) {
+		isize hi = lo+1;
+		while (hi < cases.count && cases[hi].value.len == cases[lo].value.len) {
+			hi++;
+		}
+		ir_start_block(proc, len_blocks[k]);
+		if (hi-lo == 1) {
+			ir_emit_string_switch_compares(proc, str, array_slice(cases, lo, hi), default_block);
+			lo = hi;
+			continue;
+		}
+
+		auto args = array_make<irValue *>(ir_allocator(), 1);
+		args[0] = str;
+		irValue *hash = ir_emit_runtime_call(proc, "default_hash_string", args);
+
+		auto hash_values = array_make<irValue *>(heap_allocator(), 0, hi-lo);
+		auto hash_blocks = array_make<irBlock *>(heap_allocator(), 0, hi-lo);
+		for (isize i = lo; i < hi; i++) {
+			if (i == lo || cases[i].hash != cases[i-1].hash) {
+				array_add(&hash_values, ir_value_constant(t_u64, exact_value_u64(cases[i].hash)));
+				array_add(&hash_blocks, ir_new_block(proc, nullptr, "switch.str.hash"));
+			}
+		}
+		ir_emit_switch(proc, hash, default_block, hash_values, hash_blocks);
+
+		// NOTE: Almost always a single case for each hash
+		isize hash_lo = lo;
+		for_array(j, hash_blocks) {
+			isize hash_hi = hash_lo+1;
+			while (hash_hi < hi && cases[hash_hi].hash == cases[hash_lo].hash) {
+				hash_hi++;
+			}
+			ir_start_block(proc, hash_blocks[j]);
+			ir_emit_string_switch_compares(proc, str, array_slice(cases, hash_lo, hash_hi), default_block);
+			hash_lo = hash_hi;
+		}
+		lo = hi;
+	}
+
+	ir_build_switch_case_bodies(proc, ss, bodies, done);
+}
+
 void ir_build_stmt_internal(irProcedure *proc, Ast *node) {
 	switch (node->kind) {
 	case_ast_node(bs, EmptyStmt, node);
@@ -8006,7 +8520,12 @@ void ir_build_stmt_internal(irProcedure *proc, Ast *node) {
 					{
 						gbString str = gb_string_make_length(heap_allocator(), proc->name.text, proc->name.len);
 						str = gb_string_appendc(str, "-");
-						str = gb_string_append_fmt(str, ".%.*s-%llu", LIT(name), cast(long long)e->id);
+						str = gb_string_append_fmt(str, ".%.*s", LIT(name));
+						u64 id = e->id;
+						if (build_context.incremental) {
+							id = ir_stable_name_id(m, e, make_string(cast(u8 *)str, gb_string_length(str)), 0);
+						}
+						str = gb_string_append_fmt(str, "-%llu", cast(long long)id);
 						mangled_name.text = cast(u8 *)str;
 						mangled_name.len = gb_string_length(str);
 					}
@@ -8483,6 +9002,15 @@ void ir_build_stmt_internal(irProcedure *proc, Ast *node) {
 		}
 		irBlock *done = ir_new_block(proc, node, "switch.done"); // NOTE(bill): Append later
 
+		if (ir_is_constant_switch_stmt(ss, tag)) {
+			ir_build_constant_switch_stmt(proc, ss, tag, done);
+			break;
+		}
+		if (ir_is_string_switch_stmt(ss, tag)) {
+			ir_build_string_switch_stmt(proc, ss, tag, done);
+			break;
+		}
+
 		ast_node(body, BlockStmt, ss->body);
 
 		Array<Ast *> default_stmts = {};
@@ -8939,6 +9467,7 @@ void ir_insert_code_before_proc(irProcedure* proc, irProcedure *parent) {
 
 void ir_build_proc(irValue *value, irProcedure *parent) {
 	irProcedure *proc = &value->Proc;
+	TIMINGS_TRACE_SCOPE("ir gen procedure", proc->name);
 
 	proc->parent = parent;
 
@@ -9043,6 +9572,7 @@ void ir_init_module(irModule *m, Checker *c) {
 	map_init(&m->members,                 heap_allocator());
 	map_init(&m->debug_info,              heap_allocator());
 	map_init(&m->entity_names,            heap_allocator());
+	map_init(&m->stable_names,            heap_allocator());
 	map_init(&m->anonymous_proc_lits,     heap_allocator());
 	array_init(&m->procs,                 heap_allocator());
 	array_init(&m->procs_to_generate,     heap_allocator());
@@ -9162,6 +9692,7 @@ void ir_destroy_module(irModule *m) {
 	map_destroy(&m->values);
 	map_destroy(&m->members);
 	map_destroy(&m->entity_names);
+	map_destroy(&m->stable_names);
 	map_destroy(&m->anonymous_proc_lits);
 	map_destroy(&m->debug_info);
 	map_destroy(&m->const_strings);
@@ -9181,6 +9712,36 @@ void ir_destroy_module(irModule *m) {
 ////////////////////////////////////////////////////////////////
 
 
+void ir_gen_output_paths(String init_fullpath, String *output_name_, String *output_base_) {
+	String output_name = {};
+	String output_base = {};
+	if (build_context.out_filepath.len == 0) {
+		output_name = remove_directory_from_path(init_fullpath);
+		output_name = remove_extension_from_path(output_name);
+		output_base = output_name;
+	} else {
+		output_name = build_context.out_filepath;
+		isize pos = string_extension_position(output_name);
+		if (pos < 0) {
+			output_base = output_name;
+		} else {
+			output_base = substring(output_name, 0, pos);
+		}
+	}
+	*output_name_ = output_name;
+	*output_base_ = path_to_full_path(heap_allocator(), output_base);
+}
+
+// NOTE: With a single codegen unit, the intermediate files are named after the output
+String ir_codegen_unit_output_base(String output_base, isize unit_index) {
+	if (build_context.codegen_units <= 1) {
+		return output_base;
+	}
+	char buf[32] = {};
+	isize len = gb_snprintf(buf, gb_size_of(buf), "-%td", unit_index);
+	return concatenate_strings(heap_allocator(), output_base, make_string(cast(u8 *)buf, len-1));
+}
+
 bool ir_gen_init(irGen *s, Checker *c) {
 	if (global_error_collector.count != 0) {
 		return false;
@@ -9191,28 +9752,18 @@ bool ir_gen_init(irGen *s, Checker *c) {
 		return false;
 	}
 
-	arena_init(&global_ir_arena, heap_allocator());
+	arena_init(&global_ir_arena, heap_allocator(), "ir");
 
 	ir_init_module(&s->module, c);
 	// s->module.generate_debug_info = false;
 
-	String init_fullpath = c->parser->init_fullpath;
+	ir_gen_output_paths(c->parser->init_fullpath, &s->output_name, &s->output_base);
+	gbAllocator ha = heap_allocator();
 
-	if (build_context.out_filepath.len == 0) {
-		s->output_name = remove_directory_from_path(init_fullpath);
-		s->output_name = remove_extension_from_path(s->output_name);
-		s->output_base = s->output_name;
-	} else {
-		s->output_name = build_context.out_filepath;
-		isize pos = string_extension_position(s->output_name);
-		if (pos < 0) {
-			s->output_base = s->output_name;
-		} else {
-			s->output_base = substring(s->output_name, 0, pos);
-		}
+	if (build_context.codegen_units > 1 || build_context.llvm_api) {
+		// NOTE: Each codegen unit creates its own file when printed
+		return true;
 	}
-	gbAllocator ha = heap_allocator();
-	s->output_base = path_to_full_path(ha, s->output_base);
 
 	gbString output_file_path = gb_string_make_length(ha, s->output_base.text, s->output_base.len);
 	output_file_path = gb_string_appendc(output_file_path, ".ll");
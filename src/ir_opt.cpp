@@ -1,96 +1,127 @@
 // Optimizations for the IR code
 
-void ir_opt_add_operands(Array<irValue *> *ops, irInstr *i) {
+// NOTE: Every operand slot of an instruction, so that the operands can also be replaced
+void ir_opt_add_operand_refs(Array<irValue **> *refs, irInstr *i) {
+#define IR_OPT_ADD_REF(x) do { if ((x) != nullptr) array_add(refs, &(x)); } while (0)
 	switch (i->kind) {
 	case irInstr_Comment:
 		break;
 	case irInstr_Local:
 		break;
 	case irInstr_ZeroInit:
-		array_add(ops, i->ZeroInit.address);
+		IR_OPT_ADD_REF(i->ZeroInit.address);
+		break;
+	case irInstr_MemZero:
+		IR_OPT_ADD_REF(i->MemZero.address);
+		break;
+	case irInstr_MemMove:
+		IR_OPT_ADD_REF(i->MemMove.dst);
+		IR_OPT_ADD_REF(i->MemMove.src);
 		break;
 	case irInstr_Store:
-		array_add(ops, i->Store.address);
-		array_add(ops, i->Store.value);
+		IR_OPT_ADD_REF(i->Store.address);
+		IR_OPT_ADD_REF(i->Store.value);
 		break;
 	case irInstr_Load:
-		array_add(ops, i->Load.address);
+		IR_OPT_ADD_REF(i->Load.address);
+		break;
+	case irInstr_AtomicFence:
+		break;
+	case irInstr_AtomicStore:
+		IR_OPT_ADD_REF(i->AtomicStore.address);
+		IR_OPT_ADD_REF(i->AtomicStore.value);
+		break;
+	case irInstr_AtomicLoad:
+		IR_OPT_ADD_REF(i->AtomicLoad.address);
+		break;
+	case irInstr_AtomicRmw:
+		IR_OPT_ADD_REF(i->AtomicRmw.address);
+		IR_OPT_ADD_REF(i->AtomicRmw.value);
+		break;
+	case irInstr_AtomicCxchg:
+		IR_OPT_ADD_REF(i->AtomicCxchg.address);
+		IR_OPT_ADD_REF(i->AtomicCxchg.old_value);
+		IR_OPT_ADD_REF(i->AtomicCxchg.new_value);
 		break;
 	case irInstr_ArrayElementPtr:
-		array_add(ops, i->ArrayElementPtr.address);
-		array_add(ops, i->ArrayElementPtr.elem_index);
+		IR_OPT_ADD_REF(i->ArrayElementPtr.address);
+		IR_OPT_ADD_REF(i->ArrayElementPtr.elem_index);
 		break;
 	case irInstr_StructElementPtr:
-		array_add(ops, i->StructElementPtr.address);
+		IR_OPT_ADD_REF(i->StructElementPtr.address);
 		break;
 	case irInstr_PtrOffset:
-		array_add(ops, i->PtrOffset.address);
-		array_add(ops, i->PtrOffset.offset);
+		IR_OPT_ADD_REF(i->PtrOffset.address);
+		IR_OPT_ADD_REF(i->PtrOffset.offset);
 		break;
 	case irInstr_StructExtractValue:
-		array_add(ops, i->StructExtractValue.address);
+		IR_OPT_ADD_REF(i->StructExtractValue.address);
+		break;
+	case irInstr_UnionTagPtr:
+		IR_OPT_ADD_REF(i->UnionTagPtr.address);
+		break;
+	case irInstr_UnionTagValue:
+		IR_OPT_ADD_REF(i->UnionTagValue.address);
 		break;
 	case irInstr_Conv:
-		array_add(ops, i->Conv.value);
+		IR_OPT_ADD_REF(i->Conv.value);
 		break;
 	case irInstr_Jump:
 		break;
 	case irInstr_If:
-		array_add(ops, i->If.cond);
+		IR_OPT_ADD_REF(i->If.cond);
+		break;
+	case irInstr_Switch:
+		IR_OPT_ADD_REF(i->Switch.value);
 		break;
 	case irInstr_Return:
-		if (i->Return.value != nullptr) {
-			array_add(ops, i->Return.value);
-		}
+		IR_OPT_ADD_REF(i->Return.value);
 		break;
 	case irInstr_Select:
-		array_add(ops, i->Select.cond);
+		IR_OPT_ADD_REF(i->Select.cond);
+		IR_OPT_ADD_REF(i->Select.true_value);
+		IR_OPT_ADD_REF(i->Select.false_value);
 		break;
 	case irInstr_Phi:
 		for_array(j, i->Phi.edges) {
-			array_add(ops, i->Phi.edges[j]);
+			IR_OPT_ADD_REF(i->Phi.edges[j]);
 		}
 		break;
 	case irInstr_Unreachable:
 		break;
 	case irInstr_UnaryOp:
-		array_add(ops, i->UnaryOp.expr);
+		IR_OPT_ADD_REF(i->UnaryOp.expr);
 		break;
 	case irInstr_BinaryOp:
-		array_add(ops, i->BinaryOp.left);
-		array_add(ops, i->BinaryOp.right);
+		IR_OPT_ADD_REF(i->BinaryOp.left);
+		IR_OPT_ADD_REF(i->BinaryOp.right);
 		break;
 	case irInstr_Call:
-		array_add(ops, i->Call.value);
+		IR_OPT_ADD_REF(i->Call.value);
+		IR_OPT_ADD_REF(i->Call.return_ptr);
 		for_array(j, i->Call.args) {
-			array_add(ops, i->Call.args[j]);
-		}
-		break;
-	// case irInstr_VectorExtractElement:
-		// array_add(ops, i->VectorExtractElement.vector);
-		// array_add(ops, i->VectorExtractElement.index);
-		// break;
-	// case irInstr_VectorInsertElement:
-		// array_add(ops, i->VectorInsertElement.vector);
-		// array_add(ops, i->VectorInsertElement.elem);
-		// array_add(ops, i->VectorInsertElement.index);
-		// break;
-	// case irInstr_VectorShuffle:
-		// array_add(ops, i->VectorShuffle.vector);
-		// break;
+			IR_OPT_ADD_REF(i->Call.args[j]);
+		}
+		IR_OPT_ADD_REF(i->Call.context_ptr);
+		break;
 	case irInstr_StartupRuntime:
 		break;
-
-	#if 0
-	case irInstr_BoundsCheck:
-		array_add(ops, i->BoundsCheck.index);
-		array_add(ops, i->BoundsCheck.len);
+	case irInstr_DebugDeclare:
+		IR_OPT_ADD_REF(i->DebugDeclare.value);
 		break;
-	case irInstr_SliceBoundsCheck:
-		array_add(ops, i->SliceBoundsCheck.low);
-		array_add(ops, i->SliceBoundsCheck.high);
+	default:
+		GB_PANIC("Unhandled instruction kind %.*s", LIT(ir_instr_strings[i->kind]));
 		break;
-	#endif
+	}
+#undef IR_OPT_ADD_REF
+}
+
+void ir_opt_add_operands(Array<irValue *> *ops, irInstr *i) {
+	auto refs = array_make<irValue **>(heap_allocator(), 0, 16);
+	defer (array_free(&refs));
+	ir_opt_add_operand_refs(&refs, i);
+	for_array(j, refs) {
+		array_add(ops, *refs[j]);
 	}
 }
 
@@ -306,48 +337,6 @@ void ir_opt_build_referrers(irProcedure *proc) {
 
 
 
-// State of Lengauer-Tarjan algorithm
-// Based on this paper: http://jgaa.info/accepted/2006/GeorgiadisTarjanWerneck2006.10.1.pdf
-typedef struct irLTState {
-	isize count;
-	// NOTE(bill): These are arrays
-	irBlock **sdom;     // Semidominator
-	irBlock **parent;   // Parent in DFS traversal of CFG
-	irBlock **ancestor;
-} irLTState;
-
-// §2.2 - bottom of page
-void ir_lt_link(irLTState *lt, irBlock *p, irBlock *q) {
-	lt->ancestor[q->index] = p;
-}
-
-i32 ir_lt_depth_first_search(irLTState *lt, irBlock *p, i32 i, irBlock **preorder) {
-	preorder[i] = p;
-	p->dom.pre = i++;
-	lt->sdom[p->index] = p;
-	ir_lt_link(lt, nullptr, p);
-	for_array(index, p->succs) {
-		irBlock *q = p->succs[index];
-		if (lt->sdom[q->index] == nullptr) {
-			lt->parent[q->index] = p;
-			i = ir_lt_depth_first_search(lt, q, i, preorder);
-		}
-	}
-	return i;
-}
-
-irBlock *ir_lt_eval(irLTState *lt, irBlock *v) {
-	irBlock *u = v;
-	for (;
-	     lt->ancestor[v->index] != nullptr;
-	     v = lt->ancestor[v->index]) {
-		if (lt->sdom[v->index]->dom.pre < lt->sdom[u->index]->dom.pre) {
-			u = v;
-		}
-	}
-	return u;
-}
-
 typedef struct irDomPrePost {
 	i32 pre, post;
 } irDomPrePost;
@@ -366,96 +355,1153 @@ irDomPrePost ir_opt_number_dom_tree(irBlock *v, i32 pre, i32 post) {
 	return result;
 }
 
+irBlock *ir_opt_dom_intersect(Array<irBlock *> const &idoms, Array<i32> const &post_order, irBlock *a, irBlock *b) {
+	while (a != b) {
+		while (post_order[a->index] < post_order[b->index]) {
+			a = idoms[a->index];
+		}
+		while (post_order[b->index] < post_order[a->index]) {
+			b = idoms[b->index];
+		}
+	}
+	return a;
+}
 
 // NOTE(bill): Requires `ir_opt_blocks` to be called before this
 void ir_opt_build_dom_tree(irProcedure *proc) {
-	// Based on this paper: http://jgaa.info/accepted/2006/GeorgiadisTarjanWerneck2006.10.1.pdf
+	// Based on "A Simple, Fast Dominance Algorithm" by Cooper, Harvey, and Kennedy
+	gbAllocator a = heap_allocator();
+	isize n = proc->blocks.count;
+	irBlock *root = proc->blocks[0];
 
-	gbTempArenaMemory tmp = gb_temp_arena_memory_begin(&proc->module->tmp_arena);
+	auto idoms      = array_make<irBlock *>(a, n);
+	auto post_order = array_make<i32>(a, n);
+	auto postorder  = array_make<irBlock *>(a, 0, n); // NOTE: Blocks in postorder
+	defer (array_free(&idoms));
+	defer (array_free(&post_order));
+	defer (array_free(&postorder));
+
+	// NOTE: Iterative depth first search, as procedures can have a lot of blocks
+	struct irDomFrame {
+		irBlock *block;
+		isize    succ_index;
+	};
+	auto stack = array_make<irDomFrame>(a, 0, n);
+	defer (array_free(&stack));
+	for_array(i, post_order) {
+		post_order[i] = -1;
+	}
+	post_order[root->index] = 0; // NOTE: Marks as visited
+	array_add(&stack, irDomFrame{root, 0});
+	while (stack.count > 0) {
+		irDomFrame *frame = &stack[stack.count-1];
+		irBlock *b = frame->block;
+		if (frame->succ_index < b->succs.count) {
+			irBlock *succ = b->succs[frame->succ_index++];
+			if (post_order[succ->index] < 0) {
+				post_order[succ->index] = 0;
+				array_add(&stack, irDomFrame{succ, 0});
+			}
+			continue;
+		}
+		post_order[b->index] = cast(i32)postorder.count;
+		array_add(&postorder, b);
+		array_pop(&stack);
+	}
+	GB_ASSERT_MSG(postorder.count == n, "Unreachable blocks in %.*s", LIT(proc->name));
 
-	i32 n = cast(i32)proc->blocks.count;
-	irBlock **buf = gb_alloc_array(proc->module->tmp_allocator, irBlock *, 5*n);
+	idoms[root->index] = root;
+	bool changed = true;
+	while (changed) {
+		changed = false;
+		// NOTE: Reverse postorder, skipping the root
+		for (isize i = postorder.count-2; i >= 0; i--) {
+			irBlock *b = postorder[i];
+			irBlock *new_idom = nullptr;
+			for_array(j, b->preds) {
+				irBlock *p = b->preds[j];
+				if (idoms[p->index] == nullptr) {
+					continue;
+				}
+				if (new_idom == nullptr) {
+					new_idom = p;
+				} else {
+					new_idom = ir_opt_dom_intersect(idoms, post_order, p, new_idom);
+				}
+			}
+			if (idoms[b->index] != new_idom) {
+				idoms[b->index] = new_idom;
+				changed = true;
+			}
+		}
+	}
 
-	irLTState lt = {0};
-	lt.count    = n;
-	lt.sdom     = &buf[0*n];
-	lt.parent   = &buf[1*n];
-	lt.ancestor = &buf[2*n];
+	for_array(i, proc->blocks) {
+		irBlock *b = proc->blocks[i];
+		if (b->dom.children.data == nullptr) {
+			// NOTE: Allocated once per block, then cleared and reused whenever the tree is rebuilt
+			array_init(&b->dom.children, heap_allocator());
+		}
+		array_clear(&b->dom.children);
+	}
+	// NOTE: Children in the order of the blocks
+	for_array(i, proc->blocks) {
+		irBlock *b = proc->blocks[i];
+		if (b == root) {
+			b->dom.idom = nullptr;
+		} else {
+			b->dom.idom = idoms[b->index];
+			array_add(&b->dom.idom->dom.children, b);
+		}
+	}
 
-	irBlock **preorder = &buf[3*n];
-	irBlock **buckets  = &buf[4*n];
-	irBlock *root = proc->blocks[0];
+	ir_opt_number_dom_tree(root, 0, 0);
+}
+
+// NOTE: Requires `ir_opt_build_dom_tree`, indexed by the block index
+Array<Array<irBlock *> > ir_opt_dominance_frontiers(irProcedure *proc) {
+	auto frontiers = array_make<Array<irBlock *> >(heap_allocator(), proc->blocks.count);
+	for_array(i, frontiers) {
+		array_init(&frontiers[i], heap_allocator());
+	}
+	for_array(i, proc->blocks) {
+		irBlock *b = proc->blocks[i];
+		if (b->preds.count < 2) {
+			continue;
+		}
+		for_array(j, b->preds) {
+			for (irBlock *runner = b->preds[j]; runner != b->dom.idom; runner = runner->dom.idom) {
+				Array<irBlock *> *df = &frontiers[runner->index];
+				if (df->count > 0 && (*df)[df->count-1] == b) {
+					break;
+				}
+				array_add(df, b);
+			}
+		}
+	}
+	return frontiers;
+}
 
-	// Step 1 - number vertices
-	i32 pre_num = ir_lt_depth_first_search(&lt, root, 0, preorder);
-	gb_memmove(buckets, preorder, n*gb_size_of(preorder[0]));
 
-	for (i32 i = n-1; i > 0; i--) {
-		irBlock *w = preorder[i];
+// mem2reg promotes the locals whose address is only ever loaded from, stored to, or zeroed
+// to SSA values, inserting phi nodes on the dominance frontiers of the stores (Cytron et al.)
+
+struct irMem2RegVar {
+	irValue *        local;
+	Type *           type;
+	bool             escapes;
+	Array<irBlock *> def_blocks;
+	Array<irValue *> stack; // NOTE: Reaching definitions whilst renaming
+};
+
+struct irMem2RegPhi {
+	irValue *phi;
+	isize    var_index;
+};
+
+struct irMem2Reg {
+	irProcedure *               proc;
+	Array<irMem2RegVar>         vars;
+	Map<isize>                  var_indices;  // Key: irValue * of the Local
+	Array<Array<irMem2RegPhi> > block_phis;   // NOTE: Indexed by the block index
+	Array<irValue *>            phis;
+	Map<irValue *>              replacements; // Key: irValue * of a removed Load or Phi
+	PtrSet<irValue *>           removed;
+	Array<isize>                undo;         // NOTE: Variables pushed to whilst renaming
+};
+
+bool ir_opt_is_promotable_type(Type *t) {
+	// NOTE: Larger values are better left in memory
+	i64 size = type_size_of(t);
+	return 0 < size && size <= 2*build_context.word_size;
+}
 
-		// Step 3 - Implicitly define idom for nodes
-		for (irBlock *v = buckets[i]; v != w; v = buckets[v->dom.pre]) {
-			irBlock *u = ir_lt_eval(&lt, v);
-			if (lt.sdom[u->index]->dom.pre < i) {
-				v->dom.idom = u;
-			} else {
-				v->dom.idom = w;
+isize ir_opt_mem2reg_var_index(irMem2Reg *s, irValue *address) {
+	if (address == nullptr || address->kind != irValue_Instr || address->Instr.kind != irInstr_Local) {
+		return -1;
+	}
+	isize *found = map_get(&s->var_indices, hash_pointer(address));
+	if (found == nullptr) {
+		return -1;
+	}
+	return *found;
+}
+
+irValue *ir_opt_mem2reg_resolve(irMem2Reg *s, irValue *v) {
+	for (;;) {
+		irValue **found = map_get(&s->replacements, hash_pointer(v));
+		if (found == nullptr) {
+			return v;
+		}
+		v = *found;
+	}
+}
+
+irValue *ir_opt_mem2reg_current(irMem2Reg *s, isize var_index) {
+	irMem2RegVar *var = &s->vars[var_index];
+	if (var->stack.count == 0) {
+		// NOTE: Read before any store on this path
+		return ir_value_undef(var->type);
+	}
+	return var->stack[var->stack.count-1];
+}
+
+void ir_opt_mem2reg_push(irMem2Reg *s, isize var_index, irValue *value) {
+	array_add(&s->vars[var_index].stack, value);
+	array_add(&s->undo, var_index);
+}
+
+void ir_opt_mem2reg_rename(irMem2Reg *s, irBlock *b) {
+	isize undo_count = s->undo.count;
+
+	auto *phis = &s->block_phis[b->index];
+	for_array(i, *phis) {
+		irMem2RegPhi *p = &(*phis)[i];
+		ir_opt_mem2reg_push(s, p->var_index, p->phi);
+	}
+
+	for_array(i, b->instrs) {
+		irValue *v = b->instrs[i];
+		irInstr *instr = &v->Instr;
+		isize var_index = -1;
+		switch (instr->kind) {
+		case irInstr_Local:
+			if (ir_opt_mem2reg_var_index(s, v) >= 0) {
+				ptr_set_add(&s->removed, v);
+			}
+			break;
+		case irInstr_Load:
+			var_index = ir_opt_mem2reg_var_index(s, instr->Load.address);
+			if (var_index >= 0) {
+				map_set(&s->replacements, hash_pointer(v), ir_opt_mem2reg_current(s, var_index));
+				ptr_set_add(&s->removed, v);
+			}
+			break;
+		case irInstr_Store:
+			var_index = ir_opt_mem2reg_var_index(s, instr->Store.address);
+			if (var_index >= 0) {
+				ir_opt_mem2reg_push(s, var_index, ir_opt_mem2reg_resolve(s, instr->Store.value));
+				ptr_set_add(&s->removed, v);
+			}
+			break;
+		case irInstr_ZeroInit:
+			var_index = ir_opt_mem2reg_var_index(s, instr->ZeroInit.address);
+			if (var_index >= 0) {
+				ir_opt_mem2reg_push(s, var_index, ir_value_nil(s->vars[var_index].type));
+				ptr_set_add(&s->removed, v);
 			}
+			break;
 		}
+	}
 
-		// Step 2 - Compute all sdoms
-		lt.sdom[w->index] = lt.parent[w->index];
-		for_array(pred_index, w->preds) {
-			irBlock *v = w->preds[pred_index];
-			irBlock *u = ir_lt_eval(&lt, v);
-			if (lt.sdom[u->index]->dom.pre < lt.sdom[w->index]->dom.pre) {
-				lt.sdom[w->index] = lt.sdom[u->index];
+	for_array(i, b->succs) {
+		irBlock *succ = b->succs[i];
+		auto *succ_phis = &s->block_phis[succ->index];
+		for_array(j, *succ_phis) {
+			irMem2RegPhi *p = &(*succ_phis)[j];
+			irValue *value = ir_opt_mem2reg_current(s, p->var_index);
+			for_array(k, succ->preds) {
+				if (succ->preds[k] == b) {
+					p->phi->Instr.Phi.edges[k] = value;
+				}
 			}
 		}
+	}
+
+	for_array(i, b->dom.children) {
+		ir_opt_mem2reg_rename(s, b->dom.children[i]);
+	}
 
-		ir_lt_link(&lt, lt.parent[w->index], w);
+	while (s->undo.count > undo_count) {
+		isize var_index = array_pop(&s->undo);
+		array_pop(&s->vars[var_index].stack);
+	}
+}
 
-		if (lt.parent[w->index] == lt.sdom[w->index]) {
-			w->dom.idom = lt.parent[w->index];
-		} else {
-			buckets[i] = buckets[lt.sdom[w->index]->dom.pre];
-			buckets[lt.sdom[w->index]->dom.pre] = w;
+// NOTE: Removes the phis which have a single incoming value (other than themselves),
+// and then the phis which are never used
+void ir_opt_mem2reg_simplify_phis(irMem2Reg *s) {
+	bool changed = true;
+	while (changed) {
+		changed = false;
+		for_array(i, s->phis) {
+			irValue *phi = s->phis[i];
+			if (ptr_set_exists(&s->removed, phi)) {
+				continue;
+			}
+			irValue *same = nullptr;
+			bool is_trivial = true;
+			for_array(j, phi->Instr.Phi.edges) {
+				irValue *edge = ir_opt_mem2reg_resolve(s, phi->Instr.Phi.edges[j]);
+				if (edge == phi || edge == same) {
+					continue;
+				}
+				if (same != nullptr) {
+					is_trivial = false;
+					break;
+				}
+				same = edge;
+			}
+			if (!is_trivial) {
+				continue;
+			}
+			if (same == nullptr) {
+				same = ir_value_undef(phi->Instr.Phi.type);
+			}
+			map_set(&s->replacements, hash_pointer(phi), same);
+			ptr_set_add(&s->removed, phi);
+			changed = true;
+		}
+	}
+
+	Map<isize> use_counts = {}; // Key: irValue * of a phi
+	map_init(&use_counts, heap_allocator(), s->phis.count);
+	defer (map_destroy(&use_counts));
+	for_array(i, s->phis) {
+		map_set(&use_counts, hash_pointer(s->phis[i]), cast(isize)0);
+	}
+
+	auto refs = array_make<irValue **>(heap_allocator(), 0, 16);
+	defer (array_free(&refs));
+	auto count_uses = [&](irValue *v) {
+		array_clear(&refs);
+		ir_opt_add_operand_refs(&refs, &v->Instr);
+		for_array(k, refs) {
+			irValue *op = ir_opt_mem2reg_resolve(s, *refs[k]);
+			isize *uses = map_get(&use_counts, hash_pointer(op));
+			if (uses != nullptr && op != v) {
+				*uses += 1;
+			}
+		}
+	};
+	for_array(i, s->proc->blocks) {
+		irBlock *b = s->proc->blocks[i];
+		for_array(j, b->instrs) {
+			irValue *v = b->instrs[j];
+			if (!ptr_set_exists(&s->removed, v)) {
+				count_uses(v);
+			}
+		}
+	}
+	for_array(i, s->phis) {
+		irValue *phi = s->phis[i];
+		if (!ptr_set_exists(&s->removed, phi)) {
+			count_uses(phi);
+		}
+	}
+
+	auto dead = array_make<irValue *>(heap_allocator(), 0, s->phis.count);
+	defer (array_free(&dead));
+	for_array(i, s->phis) {
+		irValue *phi = s->phis[i];
+		if (!ptr_set_exists(&s->removed, phi) && *map_get(&use_counts, hash_pointer(phi)) == 0) {
+			array_add(&dead, phi);
+		}
+	}
+	while (dead.count > 0) {
+		irValue *phi = array_pop(&dead);
+		ptr_set_add(&s->removed, phi);
+		for_array(j, phi->Instr.Phi.edges) {
+			irValue *edge = ir_opt_mem2reg_resolve(s, phi->Instr.Phi.edges[j]);
+			isize *uses = map_get(&use_counts, hash_pointer(edge));
+			if (uses == nullptr || edge == phi || ptr_set_exists(&s->removed, edge)) {
+				continue;
+			}
+			*uses -= 1;
+			if (*uses == 0) {
+				array_add(&dead, edge);
+			}
+		}
+	}
+}
+
+void ir_opt_mem2reg(irProcedure *proc) {
+	gbAllocator a = heap_allocator();
+
+	irMem2Reg s = {};
+	s.proc = proc;
+	array_init(&s.vars, a);
+	map_init(&s.var_indices, a);
+	defer ({
+		for_array(i, s.vars) {
+			array_free(&s.vars[i].def_blocks);
+			array_free(&s.vars[i].stack);
+		}
+		array_free(&s.vars);
+		map_destroy(&s.var_indices);
+	});
+
+	for_array(i, proc->blocks) {
+		irBlock *b = proc->blocks[i];
+		for_array(j, b->instrs) {
+			irValue *v = b->instrs[j];
+			if (v->Instr.kind != irInstr_Local) {
+				continue;
+			}
+			Type *type = v->Instr.Local.entity->type;
+			if (!ir_opt_is_promotable_type(type)) {
+				continue;
+			}
+			irMem2RegVar var = {};
+			var.local = v;
+			var.type  = type;
+			array_init(&var.def_blocks, a);
+			array_init(&var.stack, a);
+			map_set(&s.var_indices, hash_pointer(v), s.vars.count);
+			array_add(&s.vars, var);
+		}
+	}
+	if (s.vars.count == 0) {
+		return;
+	}
+
+	// NOTE: Any use other than being the address of a load, store, or zeroing means the
+	// address escapes and the local must stay in memory
+	auto refs = array_make<irValue **>(a, 0, 16);
+	defer (array_free(&refs));
+	for_array(i, proc->blocks) {
+		irBlock *b = proc->blocks[i];
+		for_array(j, b->instrs) {
+			irInstr *instr = &b->instrs[j]->Instr;
+			array_clear(&refs);
+			ir_opt_add_operand_refs(&refs, instr);
+			for_array(k, refs) {
+				irValue **ref = refs[k];
+				isize var_index = ir_opt_mem2reg_var_index(&s, *ref);
+				if (var_index < 0) {
+					continue;
+				}
+				irMem2RegVar *var = &s.vars[var_index];
+				bool is_def = false;
+				if (instr->kind == irInstr_Load && ref == &instr->Load.address) {
+					if (are_types_identical(instr->Load.type, var->type)) {
+						continue;
+					}
+				} else if (instr->kind == irInstr_Store && ref == &instr->Store.address) {
+					is_def = are_types_identical(ir_type(instr->Store.value), var->type);
+				} else if (instr->kind == irInstr_ZeroInit && ref == &instr->ZeroInit.address) {
+					is_def = true;
+				}
+				if (!is_def) {
+					var->escapes = true;
+				} else if (var->def_blocks.count == 0 || var->def_blocks[var->def_blocks.count-1] != b) {
+					array_add(&var->def_blocks, b);
+				}
+			}
+		}
+	}
+
+	{
+		isize count = 0;
+		map_clear(&s.var_indices);
+		for_array(i, s.vars) {
+			irMem2RegVar var = s.vars[i];
+			if (var.escapes) {
+				array_free(&var.def_blocks);
+				array_free(&var.stack);
+				continue;
+			}
+			map_set(&s.var_indices, hash_pointer(var.local), count);
+			s.vars[count++] = var;
+		}
+		s.vars.count = count;
+	}
+	if (s.vars.count == 0) {
+		return;
+	}
+
+	ir_opt_build_dom_tree(proc);
+	auto frontiers = ir_opt_dominance_frontiers(proc);
+	defer ({
+		for_array(i, frontiers) {
+			array_free(&frontiers[i]);
+		}
+		array_free(&frontiers);
+	});
+
+	isize block_count = proc->blocks.count;
+	array_init(&s.block_phis, a, block_count);
+	for_array(i, s.block_phis) {
+		array_init(&s.block_phis[i], a);
+	}
+	array_init(&s.phis, a);
+	map_init(&s.replacements, a);
+	ptr_set_init(&s.removed, a);
+	array_init(&s.undo, a);
+	defer ({
+		for_array(i, s.block_phis) {
+			array_free(&s.block_phis[i]);
+		}
+		array_free(&s.block_phis);
+		array_free(&s.phis);
+		map_destroy(&s.replacements);
+		ptr_set_destroy(&s.removed);
+		array_free(&s.undo);
+	});
+
+	// NOTE: Place the phis, the last variable placed or queued is kept per block
+	auto has_phi  = array_make<isize>(a, block_count);
+	auto queued   = array_make<isize>(a, block_count);
+	auto worklist = array_make<irBlock *>(a, 0, block_count);
+	defer (array_free(&has_phi));
+	defer (array_free(&queued));
+	defer (array_free(&worklist));
+	for (isize i = 0; i < block_count; i++) {
+		has_phi[i] = -1;
+		queued[i]  = -1;
+	}
+	for_array(var_index, s.vars) {
+		irMem2RegVar *var = &s.vars[var_index];
+		for_array(i, var->def_blocks) {
+			irBlock *d = var->def_blocks[i];
+			if (queued[d->index] != var_index) {
+				queued[d->index] = var_index;
+				array_add(&worklist, d);
+			}
+		}
+		while (worklist.count > 0) {
+			irBlock *d = array_pop(&worklist);
+			Array<irBlock *> *df = &frontiers[d->index];
+			for_array(i, *df) {
+				irBlock *f = (*df)[i];
+				if (has_phi[f->index] == var_index) {
+					continue;
+				}
+				has_phi[f->index] = var_index;
+
+				auto edges = array_make<irValue *>(ir_allocator(), f->preds.count);
+				irValue *phi = ir_instr_phi(proc, edges, var->type);
+				phi->Instr.block = f;
+				irMem2RegPhi p = {phi, var_index};
+				array_add(&s.block_phis[f->index], p);
+				array_add(&s.phis, phi);
+
+				if (queued[f->index] != var_index) {
+					queued[f->index] = var_index;
+					array_add(&worklist, f);
+				}
+			}
 		}
 	}
 
-	// The rest of Step 3
-	for (irBlock *v = buckets[0]; v != root; v = buckets[v->dom.pre]) {
-		v->dom.idom = root;
+	ir_opt_mem2reg_rename(&s, proc->blocks[0]);
+	ir_opt_mem2reg_simplify_phis(&s);
+
+	// NOTE: Replace the uses of the removed loads and phis, and put the phis which are
+	// still needed at the start of their blocks
+	auto instrs = array_make<irValue *>(a, 0, 64);
+	defer (array_free(&instrs));
+	for_array(i, proc->blocks) {
+		irBlock *b = proc->blocks[i];
+		array_clear(&instrs);
+		auto *phis = &s.block_phis[b->index];
+		for_array(j, *phis) {
+			irValue *phi = (*phis)[j].phi;
+			if (!ptr_set_exists(&s.removed, phi)) {
+				array_add(&instrs, phi);
+			}
+		}
+		for_array(j, b->instrs) {
+			irValue *v = b->instrs[j];
+			if (!ptr_set_exists(&s.removed, v)) {
+				array_add(&instrs, v);
+			}
+		}
+
+		array_clear(&b->instrs);
+		for_array(j, instrs) {
+			irValue *v = instrs[j];
+			array_clear(&refs);
+			ir_opt_add_operand_refs(&refs, &v->Instr);
+			for_array(k, refs) {
+				*refs[k] = ir_opt_mem2reg_resolve(&s, *refs[k]);
+			}
+			array_add(&b->instrs, v);
+		}
+
+		isize local_count = 0;
+		for_array(j, b->locals) {
+			irValue *local = b->locals[j];
+			if (!ptr_set_exists(&s.removed, local)) {
+				b->locals[local_count++] = local;
+			}
+		}
+		b->locals.count = local_count;
+	}
+}
+
+
+////////////////////////////////////////////////////////////////
+//
+// @Bounds Check Elimination
+//
+////////////////////////////////////////////////////////////////
+
+// NOTE: Runs after 'ir_opt_mem2reg', so that the index variables of loops are phis
+
+#define IR_OPT_BCE_MAX_DEPTH 8
+
+struct irBoundsCheck {
+	irValue *call;
+	irBlock *block;
+	isize    index; // Within the block
+	bool     is_slice;
+};
+
+struct irBoundsCheckElim {
+	irValue *       bounds_check_proc;
+	irValue *       slice_check_proc;
+	PtrSet<irValue *> invariant_params; // Only ever loaded from
+	Array<irBoundsCheck> checks;
+	Map<isize>        check_keys; // Key: ir_opt_bce_check_key, multiple
+	PtrSet<irValue *> removed;
+};
+
+bool ir_opt_bce_const(irValue *v, i64 *value) {
+	if (v != nullptr && v->kind == irValue_Constant && v->Constant.value.kind == ExactValue_Integer) {
+		*value = exact_value_to_i64(v->Constant.value);
+		return true;
 	}
+	return false;
+}
 
-	// Step 4 - Explicitly define idom for nodes (in preorder)
-	for (isize i = 1; i < n; i++) {
-		irBlock *w = preorder[i];
-		if (w == root) {
-			w->dom.idom = nullptr;
+// NOTE: Whether both values are known to be equal wherever both of them are defined
+bool ir_opt_bce_same(irBoundsCheckElim *s, irValue *a, irValue *b, isize depth=IR_OPT_BCE_MAX_DEPTH) {
+	if (a == b) {
+		return true;
+	}
+	i64 x = 0, y = 0;
+	if (ir_opt_bce_const(a, &x) && ir_opt_bce_const(b, &y)) {
+		return x == y;
+	}
+	if (depth <= 0 || a->kind != irValue_Instr || b->kind != irValue_Instr) {
+		return false;
+	}
+	irInstr *i = &a->Instr;
+	irInstr *j = &b->Instr;
+	if (i->kind != j->kind) {
+		return false;
+	}
+	switch (i->kind) {
+	case irInstr_Load:
+		// NOTE: A parameter passed as a pointer is a copy made by the caller, so it only
+		// changes if the procedure itself stores to it
+		return i->Load.address == j->Load.address && ptr_set_exists(&s->invariant_params, i->Load.address) &&
+		       are_types_identical(i->Load.type, j->Load.type);
+	case irInstr_StructExtractValue:
+		return i->StructExtractValue.index == j->StructExtractValue.index &&
+		       ir_opt_bce_same(s, i->StructExtractValue.address, j->StructExtractValue.address, depth-1);
+	case irInstr_Conv:
+		return i->Conv.kind == j->Conv.kind && are_types_identical(i->Conv.to, j->Conv.to) &&
+		       ir_opt_bce_same(s, i->Conv.value, j->Conv.value, depth-1);
+	case irInstr_BinaryOp:
+		return i->BinaryOp.op == j->BinaryOp.op && are_types_identical(i->BinaryOp.type, j->BinaryOp.type) &&
+		       ir_opt_bce_same(s, i->BinaryOp.left,  j->BinaryOp.left,  depth-1) &&
+		       ir_opt_bce_same(s, i->BinaryOp.right, j->BinaryOp.right, depth-1);
+	}
+	return false;
+}
+
+// NOTE: A key for the values 'ir_opt_bce_same' treats as equal, equal values have equal keys
+u64 ir_opt_bce_value_key(irBoundsCheckElim *s, irValue *v, isize depth=IR_OPT_BCE_MAX_DEPTH) {
+	i64 c = 0;
+	if (ir_opt_bce_const(v, &c)) {
+		return cast(u64)c * 0x9e3779b97f4a7c15ull;
+	}
+	if (depth > 0 && v->kind == irValue_Instr) {
+		irInstr *i = &v->Instr;
+		switch (i->kind) {
+		case irInstr_Load:
+			if (ptr_set_exists(&s->invariant_params, i->Load.address)) {
+				return hash_pointer(i->Load.address).key;
+			}
+			break;
+		case irInstr_StructExtractValue:
+			return ir_opt_bce_value_key(s, i->StructExtractValue.address, depth-1)*31 + i->StructExtractValue.index;
+		case irInstr_Conv:
+			return ir_opt_bce_value_key(s, i->Conv.value, depth-1)*31 + i->Conv.kind;
+		case irInstr_BinaryOp:
+			return (ir_opt_bce_value_key(s, i->BinaryOp.left,  depth-1)*31 +
+			        ir_opt_bce_value_key(s, i->BinaryOp.right, depth-1))*31 + i->BinaryOp.op;
+		}
+	}
+	return hash_pointer(v).key;
+}
+
+u64 ir_opt_bce_check_key(irBoundsCheckElim *s, irBoundsCheck const &check) {
+	auto const &args = check.call->Instr.Call.args;
+	u64 key = check.is_slice;
+	for (isize i = 3; i < args.count; i++) {
+		key = key*31 + ir_opt_bce_value_key(s, args[i]);
+	}
+	return key;
+}
+
+i64 ir_opt_bce_type_max(Type *t) {
+	i64 bits = 8*type_size_of(t);
+	if (bits >= 64) {
+		return I64_MAX;
+	}
+	return (1ll << (bits-1)) - 1;
+}
+
+// NOTE: A comparison 'left op right' which holds on entry to a block, 'op' is '<' or '<='
+struct irBoundsCheckCond {
+	TokenKind op;
+	irValue * left;
+	irValue * right;
+};
+
+TokenKind ir_opt_bce_negate_comparison(TokenKind op) {
+	switch (op) {
+	case Token_Lt:   return Token_GtEq;
+	case Token_LtEq: return Token_Gt;
+	case Token_Gt:   return Token_LtEq;
+	case Token_GtEq: return Token_Lt;
+	}
+	return Token_Invalid;
+}
+
+// NOTE: Walks up the dominator tree from '*iter', returning the next signed integer comparison
+// whose conditional branch has to be taken to reach the block
+bool ir_opt_bce_next_cond(irBlock **iter, irBoundsCheckCond *cond_) {
+	while ((*iter)->dom.idom != nullptr) {
+		irBlock *b = *iter;
+		irBlock *parent = b->dom.idom;
+		*iter = parent;
+
+		irInstr *last = ir_get_last_instr(parent);
+		if (last == nullptr || last->kind != irInstr_If || b->preds.count != 1) {
+			continue;
+		}
+		irValue *cond = last->If.cond;
+		// NOTE: Skip the conversions between 'bool' and the 'i1' of LLVM
+		while (cond->kind == irValue_Instr && cond->Instr.kind == irInstr_Conv &&
+		       is_type_boolean(cond->Instr.Conv.from) && is_type_boolean(cond->Instr.Conv.to)) {
+			cond = cond->Instr.Conv.value;
+		}
+		if (last->If.true_block == last->If.false_block ||
+		    cond->kind != irValue_Instr || cond->Instr.kind != irInstr_BinaryOp) {
+			continue;
+		}
+		irInstr *cmp = &cond->Instr;
+		Type *t = ir_type(cmp->BinaryOp.left);
+		if (!is_type_integer(t) || is_type_unsigned(t)) {
+			continue;
+		}
+		TokenKind op = cmp->BinaryOp.op;
+		if (b == last->If.false_block) {
+			op = ir_opt_bce_negate_comparison(op);
+		} else if (b != last->If.true_block) {
+			continue;
+		}
+		switch (op) {
+		case Token_Lt:
+		case Token_LtEq:
+			*cond_ = {op, cmp->BinaryOp.left, cmp->BinaryOp.right};
+			return true;
+		case Token_Gt:
+			*cond_ = {Token_Lt, cmp->BinaryOp.right, cmp->BinaryOp.left};
+			return true;
+		case Token_GtEq:
+			*cond_ = {Token_LtEq, cmp->BinaryOp.right, cmp->BinaryOp.left};
+			return true;
+		}
+	}
+	return false;
+}
+
+bool ir_opt_bce_max_value(irBoundsCheckElim *s, irValue *v, irBlock *block, i64 *max, isize depth=IR_OPT_BCE_MAX_DEPTH);
+
+// NOTE: Whether 'v' is 'base + c' for a constant 'c' which is not negative
+bool ir_opt_bce_is_increment_of(irValue *v, irValue *base, i64 *c) {
+	if (v->kind != irValue_Instr || v->Instr.kind != irInstr_BinaryOp || v->Instr.BinaryOp.op != Token_Add) {
+		return false;
+	}
+	irValue *left  = v->Instr.BinaryOp.left;
+	irValue *right = v->Instr.BinaryOp.right;
+	if (left == base && ir_opt_bce_const(right, c)) {
+		return *c >= 0;
+	}
+	if (right == base && ir_opt_bce_const(left, c)) {
+		return *c >= 0;
+	}
+	return false;
+}
+
+bool ir_opt_bce_is_signed_integer(irValue *v) {
+	Type *t = ir_type(v);
+	return is_type_integer(t) && !is_type_unsigned(t);
+}
+
+// NOTE: The smallest value that 'v' can have within 'block'. The additions have to be shown not
+// to overflow, an induction variable which wraps around would be negative.
+bool ir_opt_bce_min_value(irBoundsCheckElim *s, irValue *v, irBlock *block, i64 *min, isize depth=IR_OPT_BCE_MAX_DEPTH) {
+	if (ir_opt_bce_const(v, min)) {
+		return true;
+	}
+	if (depth <= 0 || v->kind != irValue_Instr || !ir_opt_bce_is_signed_integer(v)) {
+		return false;
+	}
+	irInstr *i = &v->Instr;
+	i64 type_max = ir_opt_bce_type_max(ir_type(v));
+	switch (i->kind) {
+	case irInstr_StructExtractValue: {
+		// NOTE: The length and capacity of a slice, string, or dynamic array are never negative
+		Type *t = core_type(ir_type(i->StructExtractValue.address));
+		i32 index = i->StructExtractValue.index;
+		if ((is_type_string(t) && index == 1) ||
+		    (t->kind == Type_Slice && index == 1) ||
+		    (t->kind == Type_DynamicArray && (index == 1 || index == 2))) {
+			*min = 0;
+			return true;
+		}
+		return false;
+	}
+
+	case irInstr_BinaryOp: {
+		if (i->BinaryOp.op != Token_Add) {
+			return false;
+		}
+		i64 c = 0;
+		irValue *other = nullptr;
+		if (ir_opt_bce_const(i->BinaryOp.right, &c)) {
+			other = i->BinaryOp.left;
+		} else if (ir_opt_bce_const(i->BinaryOp.left, &c)) {
+			other = i->BinaryOp.right;
 		} else {
-			// Weird tree relationships here!
+			return false;
+		}
+		i64 lo = 0, hi = 0;
+		if (c < 0 ||
+		    !ir_opt_bce_max_value(s, other, block, &hi, depth-1) || hi > type_max - c ||
+		    !ir_opt_bce_min_value(s, other, block, &lo, depth-1)) {
+			return false;
+		}
+		*min = lo + c;
+		return true;
+	}
+
+	case irInstr_Phi: {
+		irBlock *phi_block = i->block;
+		if (phi_block == nullptr || phi_block->preds.count != i->Phi.edges.count) {
+			return false;
+		}
+		bool found = false;
+		for_array(k, i->Phi.edges) {
+			irValue *edge = i->Phi.edges[k];
+			irBlock *pred = phi_block->preds[k];
+			// NOTE: An increment cannot lower the value as long as it does not overflow, which
+			// the comparisons that guard the edge into the phi have to show
+			i64 c = 0, hi = 0;
+			if (ir_opt_bce_is_increment_of(edge, v, &c) &&
+			    ir_opt_bce_max_value(s, v, pred, &hi, depth-1) && hi <= type_max - c) {
+				continue;
+			}
+			i64 m = 0;
+			if (!ir_opt_bce_min_value(s, edge, pred, &m, depth-1)) {
+				return false;
+			}
+			if (!found || m < *min) {
+				*min = m;
+			}
+			found = true;
+		}
+		return found;
+	}
+	}
+	return false;
+}
 
-			if (w->dom.idom != lt.sdom[w->index]) {
-				w->dom.idom = w->dom.idom->dom.idom;
+// NOTE: The largest value that 'v' can have within 'block'
+bool ir_opt_bce_max_value(irBoundsCheckElim *s, irValue *v, irBlock *block, i64 *max, isize depth) {
+	if (ir_opt_bce_const(v, max)) {
+		return true;
+	}
+	if (depth <= 0 || v->kind != irValue_Instr || !ir_opt_bce_is_signed_integer(v)) {
+		return false;
+	}
+	irInstr *i = &v->Instr;
+	i64 type_max = ir_opt_bce_type_max(ir_type(v));
+
+	bool found = false;
+	irBlock *iter = block;
+	irBoundsCheckCond cond = {};
+	while (ir_opt_bce_next_cond(&iter, &cond)) {
+		if (!ir_opt_bce_same(s, cond.left, v)) {
+			continue;
+		}
+		i64 bound = type_max;
+		i64 u = 0;
+		if (cond.op == Token_Lt) {
+			if (ir_opt_bce_const(cond.right, &u)) {
+				if (u == I64_MIN) {
+					continue;
+				}
+				bound = u - 1;
+			} else {
+				bound = type_max - 1; // NOTE: v < right <= type_max
+			}
+		} else if (ir_opt_bce_const(cond.right, &u)) {
+			bound = u;
+		} else if (cond.right->kind == irValue_Instr && cond.right->Instr.kind == irInstr_BinaryOp &&
+		           cond.right->Instr.BinaryOp.op == Token_Sub) {
+			// NOTE: v <= x - k, which does not wrap around when x is not negative
+			irValue *x = cond.right->Instr.BinaryOp.left;
+			i64 k = 0, m = 0;
+			if (ir_opt_bce_const(cond.right->Instr.BinaryOp.right, &k) && k >= 1 &&
+			    ir_opt_bce_min_value(s, x, block, &m, depth-1) && m >= 0) {
+				bound = type_max - k;
 			}
+		}
+		if (!found || bound < *max) {
+			*max = bound;
+		}
+		found = true;
+	}
+	if (found && *max < type_max) {
+		return true;
+	}
+
+	switch (i->kind) {
+	case irInstr_BinaryOp: {
+		if (i->BinaryOp.op != Token_Add) {
+			return false;
+		}
+		i64 c = 0;
+		irValue *other = nullptr;
+		if (ir_opt_bce_const(i->BinaryOp.right, &c)) {
+			other = i->BinaryOp.left;
+		} else if (ir_opt_bce_const(i->BinaryOp.left, &c)) {
+			other = i->BinaryOp.right;
+		} else {
+			return false;
+		}
+		i64 hi = 0;
+		if (c < 0 || !ir_opt_bce_max_value(s, other, block, &hi, depth-1) || hi > type_max - c) {
+			return false;
+		}
+		*max = hi + c;
+		return true;
+	}
 
-			// Calculate children relation as inverse of idom
-			if (w->dom.idom->dom.children.data == nullptr) {
-				// TODO(bill): Is this good enough for memory allocations?
-				array_init(&w->dom.idom->dom.children, heap_allocator());
+	case irInstr_Phi: {
+		irBlock *phi_block = i->block;
+		if (phi_block == nullptr || phi_block->preds.count != i->Phi.edges.count) {
+			return false;
+		}
+		for_array(k, i->Phi.edges) {
+			i64 m = 0;
+			if (!ir_opt_bce_max_value(s, i->Phi.edges[k], phi_block->preds[k], &m, depth-1)) {
+				return false;
+			}
+			if (k == 0 || m > *max) {
+				*max = m;
 			}
-			array_add(&w->dom.idom->dom.children, w);
 		}
+		return i->Phi.edges.count > 0;
+	}
 	}
+	return false;
+}
 
-	ir_opt_number_dom_tree(root, 0, 0);
+// NOTE: Whether 'index < len' holds given that the comparison 'left op right' holds
+bool ir_opt_bce_cond_implies(irBoundsCheckElim *s, irBoundsCheckCond const &cond, irValue *index, irValue *len) {
+	if (!ir_opt_bce_same(s, cond.left, index)) {
+		return false;
+	}
+	irValue *right = cond.right;
+	i64 upper = 0, n = 0;
+	bool is_const = ir_opt_bce_const(right, &upper) && ir_opt_bce_const(len, &n);
+	if (cond.op == Token_Lt) {
+		// NOTE: index < upper <= len
+		return ir_opt_bce_same(s, right, len) || (is_const && upper <= n);
+	}
+	// NOTE: index <= upper < len, e.g. 'for i in 0..len(x)-1'
+	if (is_const) {
+		return upper < n;
+	}
+	if (right->kind == irValue_Instr && right->Instr.kind == irInstr_BinaryOp && right->Instr.BinaryOp.op == Token_Sub) {
+		i64 c = 0;
+		return ir_opt_bce_const(right->Instr.BinaryOp.right, &c) && c >= 1 &&
+		       ir_opt_bce_same(s, right->Instr.BinaryOp.left, len);
+	}
+	return false;
+}
 
-	gb_temp_arena_memory_end(tmp);
+// NOTE: Whether a conditional branch which dominates the block proves 'index < len'
+bool ir_opt_bce_dominating_cond(irBoundsCheckElim *s, irBlock *block, irValue *index, irValue *len) {
+	irBlock *iter = block;
+	irBoundsCheckCond cond = {};
+	while (ir_opt_bce_next_cond(&iter, &cond)) {
+		if (ir_opt_bce_cond_implies(s, cond, index, len)) {
+			return true;
+		}
+	}
+	return false;
 }
 
-void ir_opt_mem2reg(irProcedure *proc) {
-	// TODO(bill): ir_opt_mem2reg
+bool ir_opt_bce_dominates(irBoundsCheck const &a, irBoundsCheck const &b) {
+	if (a.block == b.block) {
+		return a.index < b.index;
+	}
+	return a.block->dom.pre < b.block->dom.pre && b.block->dom.post < a.block->dom.post;
+}
+
+bool ir_opt_bce_is_redundant(irBoundsCheckElim *s, isize check_index) {
+	irBoundsCheck check = s->checks[check_index];
+	auto const &args = check.call->Instr.Call.args;
+
+	// NOTE: The same check has already been done on every path to this one, only the earlier
+	// checks with the same key can be the same
+	auto *entry = multi_map_find_first(&s->check_keys, hash_integer(ir_opt_bce_check_key(s, check)));
+	for (; entry != nullptr; entry = multi_map_find_next(&s->check_keys, entry)) {
+		irBoundsCheck prev = s->checks[entry->value];
+		if (prev.is_slice != check.is_slice || !ir_opt_bce_dominates(prev, check)) {
+			continue;
+		}
+		auto const &prev_args = prev.call->Instr.Call.args;
+		bool same = true;
+		for (isize j = 3; j < args.count && same; j++) {
+			same = ir_opt_bce_same(s, prev_args[j], args[j]);
+		}
+		if (same) {
+			return true;
+		}
+	}
+
+	irBlock *block = check.block;
+	i64 min = 0;
+	if (!check.is_slice) {
+		// NOTE: bounds_check_error(file, line, column, index, len)
+		irValue *index = args[3];
+		irValue *len   = args[4];
+		i64 c = 0, n = 0;
+		if (ir_opt_bce_const(index, &c) && ir_opt_bce_const(len, &n)) {
+			return 0 <= c && c < n;
+		}
+		if (!ir_opt_bce_min_value(s, index, block, &min) || min < 0) {
+			return false;
+		}
+		return ir_opt_bce_dominating_cond(s, block, index, len);
+	}
+
+	// NOTE: slice_expr_error(file, line, column, lo, hi, len), e.g. 'x[:]'
+	irValue *lo  = args[3];
+	irValue *hi  = args[4];
+	irValue *len = args[5];
+	i64 l = 0, h = 0, n = 0;
+	if (!ir_opt_bce_min_value(s, lo, block, &l) || l < 0) {
+		return false;
+	}
+	bool lo_le_hi = ir_opt_bce_same(s, lo, hi) ||
+	                (ir_opt_bce_const(lo, &l) && ir_opt_bce_const(hi, &h) && l <= h) ||
+	                (ir_opt_bce_const(lo, &l) && l == 0 && ir_opt_bce_min_value(s, hi, block, &h) && h >= 0);
+	bool hi_le_len = ir_opt_bce_same(s, hi, len) ||
+	                 (ir_opt_bce_const(hi, &h) && ir_opt_bce_const(len, &n) && h <= n);
+	return lo_le_hi && hi_le_len;
+}
+
+irValue *ir_opt_bce_runtime_proc(irModule *m, char const *name) {
+	AstPackage *pkg = m->info->runtime_package;
+	Entity *e = scope_lookup_current(pkg->scope, make_string_c(cast(char *)name));
+	if (e == nullptr) {
+		return nullptr;
+	}
+	irValue **found = map_get(&m->values, hash_entity(e));
+	return found ? *found : nullptr;
+}
+
+void ir_opt_bounds_check_elim(irProcedure *proc) {
+	irBoundsCheckElim s = {};
+	s.bounds_check_proc = ir_opt_bce_runtime_proc(proc->module, "bounds_check_error");
+	s.slice_check_proc  = ir_opt_bce_runtime_proc(proc->module, "slice_expr_error");
+	if (s.bounds_check_proc == nullptr && s.slice_check_proc == nullptr) {
+		return;
+	}
+
+	gbAllocator a = heap_allocator();
+	array_init(&s.checks, a);
+	defer (array_free(&s.checks));
+	for_array(i, proc->blocks) {
+		irBlock *b = proc->blocks[i];
+		for_array(j, b->instrs) {
+			irValue *v = b->instrs[j];
+			if (v->Instr.kind != irInstr_Call) {
+				continue;
+			}
+			irValue *callee = v->Instr.Call.value;
+			if (callee == s.bounds_check_proc && v->Instr.Call.args.count == 5) {
+				array_add(&s.checks, irBoundsCheck{v, b, j, false});
+			} else if (callee == s.slice_check_proc && v->Instr.Call.args.count == 6) {
+				array_add(&s.checks, irBoundsCheck{v, b, j, true});
+			}
+		}
+	}
+	if (s.checks.count == 0) {
+		return;
+	}
+
+	ptr_set_init(&s.invariant_params, a);
+	defer (ptr_set_destroy(&s.invariant_params));
+	for_array(i, proc->params) {
+		// NOTE: A parameter passed as a pointer is added as the first load from it
+		irValue *v = proc->params[i];
+		if (v->kind != irValue_Instr || v->Instr.kind != irInstr_Load) {
+			continue;
+		}
+		irValue *p = v->Instr.Load.address;
+		if (p->kind == irValue_Param && p->Param.kind == irParamPass_Pointer) {
+			ptr_set_add(&s.invariant_params, p);
+		}
+	}
+	if (s.invariant_params.entries.count > 0) {
+		auto refs = array_make<irValue **>(a, 0, 16);
+		defer (array_free(&refs));
+		for_array(i, proc->blocks) {
+			irBlock *b = proc->blocks[i];
+			for_array(j, b->instrs) {
+				irInstr *instr = &b->instrs[j]->Instr;
+				array_clear(&refs);
+				ir_opt_add_operand_refs(&refs, instr);
+				for_array(k, refs) {
+					irValue **ref = refs[k];
+					if (instr->kind == irInstr_Load && ref == &instr->Load.address) {
+						continue;
+					}
+					ptr_set_remove(&s.invariant_params, *ref);
+				}
+			}
+		}
+	}
+
+	ir_opt_build_dom_tree(proc);
+
+	ptr_set_init(&s.removed, a);
+	defer (ptr_set_destroy(&s.removed));
+	map_init(&s.check_keys, a);
+	defer (map_destroy(&s.check_keys));
+	for_array(i, s.checks) {
+		if (ir_opt_bce_is_redundant(&s, i)) {
+			ptr_set_add(&s.removed, s.checks[i].call);
+		}
+		multi_map_insert(&s.check_keys, hash_integer(ir_opt_bce_check_key(&s, s.checks[i])), i);
+	}
+	if (s.removed.entries.count == 0) {
+		return;
+	}
+
+	for_array(i, proc->blocks) {
+		irBlock *b = proc->blocks[i];
+		isize count = 0;
+		for_array(j, b->instrs) {
+			irValue *v = b->instrs[j];
+			if (!ptr_set_exists(&s.removed, v)) {
+				b->instrs[count++] = v;
+			}
+		}
+		b->instrs.count = count;
+	}
 }
 
 
@@ -468,11 +1514,13 @@ void ir_opt_tree(irGen *s) {
 		if (proc->blocks.count == 0) { // Prototype/external procedure
 			continue;
 		}
+		TIMINGS_TRACE_SCOPE("ir opt procedure", proc->name);
 
 		ir_opt_blocks(proc);
+		ir_opt_mem2reg(proc);
+		ir_opt_bounds_check_elim(proc);
 	#if 0
 		ir_opt_build_referrers(proc);
-		ir_opt_build_dom_tree(proc);
 
 		// TODO(bill): ir optimization
 		// [ ] cse (common-subexpression) elim
@@ -481,11 +1529,8 @@ void ir_opt_tree(irGen *s) {
 		// [ ] dead store/load elim
 		// [ ] phi elim
 		// [ ] short circuit elim
-		// [ ] bounds check elim
-		// [ ] lift/mem2reg
-		// [ ] lift/mem2reg
-
-		ir_opt_mem2reg(proc);
+		// [x] bounds check elim
+		// [x] lift/mem2reg
 	#endif
 
 		GB_ASSERT(proc->blocks.count > 0);
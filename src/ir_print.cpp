@@ -1,9 +1,14 @@
 #define IR_FILE_BUFFER_BUF_LEN (4096)
 
+
 struct irFileBuffer {
 	gbVirtualMemory vm;
 	isize           offset;
 	gbFile *        output;
+	irCodegenUnit * unit; // NOTE: Only set when there is more than one codegen unit
+	Array<u8> *     memory; // NOTE: Printed into this rather than 'output' with -llvm-api
+	u64 *           hash;   // NOTE: Of everything printed, only set with -incremental
+	i64             byte_count;
 	char            buf[IR_FILE_BUFFER_BUF_LEN];
 };
 
@@ -12,30 +17,50 @@ void ir_file_buffer_init(irFileBuffer *f, gbFile *output) {
 	f->vm = gb_vm_alloc(nullptr, size);
 	f->offset = 0;
 	f->output = output;
+	f->unit   = nullptr;
+	f->memory = nullptr;
+	f->hash   = nullptr;
+}
+
+void ir_file_buffer_flush(irFileBuffer *f, void const *data, isize len) {
+	if (f->hash != nullptr) {
+		*f->hash = build_cache__hash(*f->hash, data, len);
+	}
+	if (f->memory == nullptr) {
+		gb_file_write(f->output, data, len);
+		return;
+	}
+	Array<u8> *m = f->memory;
+	if (m->count+len > m->capacity) {
+		array_reserve(m, gb_max(2*m->capacity, m->count+len));
+	}
+	gb_memmove(m->data+m->count, data, len);
+	m->count += len;
 }
 
 void ir_file_buffer_destroy(irFileBuffer *f) {
 	if (f->offset > 0) {
 		// NOTE(bill): finish writing buffered data
-		gb_file_write(f->output, f->vm.data, f->offset);
+		ir_file_buffer_flush(f, f->vm.data, f->offset);
 	}
 
 	gb_vm_free(f->vm);
 }
 
 void ir_file_buffer_write(irFileBuffer *f, void const *data, isize len) {
+	f->byte_count += len;
 	if (len > f->vm.size) {
 		//NOTE(thebirk): Flush the vm data before we print this directly
 		//               otherwise we get out of order printing which is no good
-		gb_file_write(f->output, f->vm.data, f->offset);
+		ir_file_buffer_flush(f, f->vm.data, f->offset);
 		f->offset = 0;
 
-		gb_file_write(f->output, data, len);
+		ir_file_buffer_flush(f, data, len);
 		return;
 	}
 
 	if ((f->vm.size - f->offset) < len) {
-		gb_file_write(f->output, f->vm.data, f->offset);
+		ir_file_buffer_flush(f, f->vm.data, f->offset);
 		f->offset = 0;
 	}
 	u8 *cursor = cast(u8 *)f->vm.data + f->offset;
@@ -117,6 +142,26 @@ bool ir_valid_char(u8 c) {
 	return false;
 }
 
+void ir_print_escaped_chars(irFileBuffer *f, String str, bool is_path) {
+	char const hex_table[] = "0123456789ABCDEF";
+	isize run_start = 0;
+	for (isize i = 0; i < str.len; i++) {
+		u8 c = str[i];
+		if (ir_valid_char(c) || (is_path && c == ':')) {
+			continue;
+		}
+		ir_write_string(f, substring(str, run_start, i));
+		run_start = i+1;
+		if (is_path && c == '\\') {
+			ir_write_byte(f, '/');
+		} else {
+			u8 escaped[3] = {'\\', cast(u8)hex_table[c >> 4], cast(u8)hex_table[c & 0x0f]};
+			ir_file_write(f, escaped, 3);
+		}
+	}
+	ir_write_string(f, substring(str, run_start, str.len));
+}
+
 void ir_print_escape_string(irFileBuffer *f, String name, bool print_quotes, bool prefix_with_dot) {
 	isize extra = 0;
 	for (isize i = 0; i < name.len; i++) {
@@ -131,42 +176,18 @@ void ir_print_escape_string(irFileBuffer *f, String name, bool print_quotes, boo
 		return;
 	}
 
-	char const hex_table[] = "0123456789ABCDEF";
-	isize buf_len = name.len + extra + 2 + 1;
-
-	gbTempArenaMemory tmp = gb_temp_arena_memory_begin(&string_buffer_arena);
-
-	u8 *buf = gb_alloc_array(string_buffer_allocator, u8, buf_len);
-
-	isize j = 0;
-
+	// NOTE: Written straight into the file buffer, without a temporary buffer, as
+	// codegen units may be printed concurrently
 	if (print_quotes) {
-		buf[j++] = '"';
+		ir_write_byte(f, '"');
 	}
-
 	if (prefix_with_dot) {
-		buf[j++] = '.';
-	}
-
-	for (isize i = 0; i < name.len; i++) {
-		u8 c = name[i];
-		if (ir_valid_char(c)) {
-			buf[j++] = c;
-		} else {
-			buf[j] = '\\';
-			buf[j+1] = hex_table[c >> 4];
-			buf[j+2] = hex_table[c & 0x0f];
-			j += 3;
-		}
+		ir_write_byte(f, '.');
 	}
-
+	ir_print_escaped_chars(f, name, false);
 	if (print_quotes) {
-		buf[j++] = '"';
+		ir_write_byte(f, '"');
 	}
-
-	ir_file_write(f, buf, j);
-
-	gb_temp_arena_memory_end(tmp);
 }
 
 
@@ -184,33 +205,7 @@ void ir_print_escape_path(irFileBuffer *f, String path) {
 		return;
 	}
 
-
-	char hex_table[] = "0123456789ABCDEF";
-	isize buf_len = path.len + extra + 2 + 1;
-
-	gbTempArenaMemory tmp = gb_temp_arena_memory_begin(&string_buffer_arena);
-
-	u8 *buf = gb_alloc_array(string_buffer_allocator, u8, buf_len);
-
-	isize j = 0;
-
-	for (isize i = 0; i < path.len; i++) {
-		u8 c = path[i];
-		if (ir_valid_char(c) || c == ':') {
-			buf[j++] = c;
-		} else if (c == '\\') {
-			buf[j++] = '/';
-		} else {
-			buf[j] = '\\';
-			buf[j+1] = hex_table[c >> 4];
-			buf[j+2] = hex_table[c & 0x0f];
-			j += 3;
-		}
-	}
-
-	ir_file_write(f, buf, j);
-
-	gb_temp_arena_memory_end(tmp);
+	ir_print_escaped_chars(f, path, true);
 }
 
 
@@ -668,7 +663,7 @@ void ir_print_exact_value(irFileBuffer *f, irModule *m, ExactValue value, Type *
 		} else if (is_type_cstring(t)) {
 			// HACK NOTE(bill): This is a hack but it works because strings are created at the very end
 			// of the .ll file
-			irValue *str_array = ir_add_global_string_array(m, str);
+			irValue *str_array = ir_add_global_string_array(m, str, f->unit);
 			ir_write_str_lit(f, "getelementptr inbounds (");
 			ir_print_type(f, m, str_array->Global.entity->type);
 			ir_write_str_lit(f, ", ");
@@ -681,7 +676,7 @@ void ir_print_exact_value(irFileBuffer *f, irModule *m, ExactValue value, Type *
 		} else {
 			// HACK NOTE(bill): This is a hack but it works because strings are created at the very end
 			// of the .ll file
-			irValue *str_array = ir_add_global_string_array(m, str);
+			irValue *str_array = ir_add_global_string_array(m, str, f->unit);
 			ir_write_str_lit(f, "{i8* getelementptr inbounds (");
 			ir_print_type(f, m, str_array->Global.entity->type);
 			ir_write_str_lit(f, ", ");
@@ -775,7 +770,7 @@ void ir_print_exact_value(irFileBuffer *f, irModule *m, ExactValue value, Type *
 	case ExactValue_Compound: {
 		type = base_type(type);
 		if (is_type_slice(type)) {
-			irValue *s = ir_add_module_constant(m, type, value);
+			irValue *s = ir_add_module_constant(m, type, value, f->unit);
 			ir_print_value(f, m, s, type);
 		} else if (is_type_array(type)) {
 			ast_node(cl, CompoundLit, value.value_compound);
@@ -803,9 +798,6 @@ void ir_print_exact_value(irFileBuffer *f, irModule *m, ExactValue value, Type *
 
 			ir_write_byte(f, ']');
 		} else if (is_type_struct(type)) {
-			gbTempArenaMemory tmp = gb_temp_arena_memory_begin(&m->tmp_arena);
-			defer (gb_temp_arena_memory_end(tmp));
-
 			ast_node(cl, CompoundLit, value.value_compound);
 
 			if (cl->elems.count == 0) {
@@ -816,8 +808,11 @@ void ir_print_exact_value(irFileBuffer *f, irModule *m, ExactValue value, Type *
 			String tstr = make_string_c(type_to_string(original_type));
 
 			isize value_count = type->Struct.fields.count;
-			ExactValue *values = gb_alloc_array(m->tmp_allocator, ExactValue, value_count);
-			bool *visited = gb_alloc_array(m->tmp_allocator, bool, value_count);
+			// NOTE: Not the module's temporary arena, as codegen units may be printed concurrently
+			ExactValue *values = gb_alloc_array(heap_allocator(), ExactValue, value_count);
+			bool *visited = gb_alloc_array(heap_allocator(), bool, value_count);
+			defer (gb_free(heap_allocator(), values));
+			defer (gb_free(heap_allocator(), visited));
 
 			if (cl->elems.count > 0) {
 				if (cl->elems[0]->kind == Ast_FieldValue) {
@@ -1109,7 +1104,35 @@ void ir_print_instr(irFileBuffer *f, irModule *m, irValue *value) {
 		ir_print_exact_value(f, m, empty_exact_value, type);
 		ir_write_str_lit(f, ", ");
 		ir_print_type(f, m, type);
-		ir_fprintf(f, "* %%%d, align 1", instr->ZeroInit.address->index);
+		ir_write_str_lit(f, "* ");
+		ir_print_value(f, m, instr->ZeroInit.address, type);
+		ir_fprintf(f, ", align %lld", type_align_of(type));
+		ir_print_debug_location(f, m, value);
+		break;
+	}
+
+	case irInstr_MemZero: {
+		// NOTE: The same form of the intrinsic as 'mem.set' uses, with the alignment as an argument
+		ir_write_str_lit(f, "call void @llvm.memset.p0i8.i64(");
+		ir_print_type(f, m, t_rawptr);
+		ir_write_byte(f, ' ');
+		ir_print_value(f, m, instr->MemZero.address, t_rawptr);
+		ir_fprintf(f, ", i8 0, i64 %lld, i32 %lld, i1 false)", instr->MemZero.size, instr->MemZero.align);
+		ir_print_debug_location(f, m, value);
+		break;
+	}
+
+	case irInstr_MemMove: {
+		ir_write_str_lit(f, "call void @llvm.memmove.p0i8.p0i8.i64(");
+		ir_print_type(f, m, t_rawptr);
+		ir_write_byte(f, ' ');
+		ir_print_value(f, m, instr->MemMove.dst, t_rawptr);
+		ir_write_str_lit(f, ", ");
+		ir_print_type(f, m, t_rawptr);
+		ir_write_byte(f, ' ');
+		ir_print_value(f, m, instr->MemMove.src, t_rawptr);
+		ir_fprintf(f, ", i64 %lld, i32 %lld, i1 false)", instr->MemMove.size, instr->MemMove.align);
+		ir_print_debug_location(f, m, value);
 		break;
 	}
 
@@ -1123,6 +1146,7 @@ void ir_print_instr(irFileBuffer *f, irModule *m, irValue *value) {
 		ir_print_type(f, m, type);
 		ir_write_str_lit(f, "* ");
 		ir_print_value(f, m, instr->Store.address, type);
+		ir_fprintf(f, ", align %lld", type_align_of(type));
 		ir_print_debug_location(f, m, value);
 		break;
 	}
@@ -1571,6 +1595,30 @@ void ir_print_instr(irFileBuffer *f, irModule *m, irValue *value) {
 		break;
 	}
 
+	case irInstr_Switch: {
+		irInstrSwitch *sw = &instr->Switch;
+		Type *t = ir_type(sw->value);
+		ir_write_str_lit(f, "switch ");
+		ir_print_type(f, m, t);
+		ir_write_byte(f, ' ');
+		ir_print_value(f, m, sw->value, t);
+		ir_write_str_lit(f, ", label %");
+		ir_print_block_name(f, sw->default_block);
+		ir_write_str_lit(f, " [\n");
+		for_array(i, sw->case_values) {
+			ir_write_str_lit(f, "\t\t");
+			ir_print_type(f, m, t);
+			ir_write_byte(f, ' ');
+			ir_print_value(f, m, sw->case_values[i], t);
+			ir_write_str_lit(f, ", label %");
+			ir_print_block_name(f, sw->case_blocks[i]);
+			ir_write_byte(f, '\n');
+		}
+		ir_write_str_lit(f, "\t]");
+		ir_print_debug_location(f, m, value);
+		break;
+	}
+
 	case irInstr_Return: {
 		irInstrReturn *ret = &instr->Return;
 		ir_write_str_lit(f, "ret ");
@@ -1915,8 +1963,10 @@ void ir_print_instr(irFileBuffer *f, irModule *m, irValue *value) {
 }
 
 
-void ir_print_proc(irFileBuffer *f, irModule *m, irProcedure *proc) {
-	if (proc->body == nullptr) {
+// NOTE: 'declare_only' prints just the prototype of a procedure defined in another codegen unit
+void ir_print_proc(irFileBuffer *f, irModule *m, irProcedure *proc, bool declare_only=false) {
+	bool has_body = proc->body != nullptr && !declare_only;
+	if (!has_body) {
 		ir_write_str_lit(f, "declare ");
 		// if (proc->tags & ProcTag_dll_import) {
 			// ir_write_string(f, "dllimport ");
@@ -1979,7 +2029,7 @@ void ir_print_proc(irFileBuffer *f, irModule *m, irProcedure *proc) {
 				if (e->flags&EntityFlag_NoAlias) {
 					ir_write_str_lit(f, " noalias");
 				}
-				if (proc->body != nullptr) {
+				if (has_body) {
 					if (e->token.string != "" && !is_blank_ident(e->token)) {
 						ir_write_byte(f, ' ');
 						ir_print_encoded_local(f, e->token.string);
@@ -2019,7 +2069,7 @@ void ir_print_proc(irFileBuffer *f, irModule *m, irProcedure *proc) {
 		ir_write_str_lit(f, "noreturn ");
 	}
 
-	if (m->generate_debug_info && proc->entity != nullptr && proc->body != nullptr) {
+	if (m->generate_debug_info && proc->entity != nullptr && has_body) {
 		irDebugInfo **di_ = map_get(&proc->module->debug_info, hash_pointer(proc->entity));
 		if (di_ != nullptr) {
 			irDebugInfo *di = *di_;
@@ -2030,7 +2080,7 @@ void ir_print_proc(irFileBuffer *f, irModule *m, irProcedure *proc) {
 
 
 
-	if (proc->body != nullptr) {
+	if (has_body) {
 		// ir_fprintf(f, "nounwind uwtable {\n");
 
 		ir_write_str_lit(f, "{\n");
@@ -2052,7 +2102,7 @@ void ir_print_proc(irFileBuffer *f, irModule *m, irProcedure *proc) {
 	}
 
 	for_array(i, proc->children) {
-		ir_print_proc(f, m, proc->children[i]);
+		ir_print_proc(f, m, proc->children[i], declare_only);
 	}
 }
 
@@ -2102,12 +2152,96 @@ void foo_bar(void) {
 
 }
 
-void print_llvm_ir(irGen *ir) {
+void ir_print_global(irFileBuffer *f, irModule *m, irValue *v, bool declare_only, bool is_shared) {
+	irValueGlobal *g = &v->Global;
+	Scope *scope = g->entity->scope;
+	bool in_global_scope = false;
+	if (scope != nullptr) {
+		// NOTE: The globals of the runtime package are not prefixed with a dot when escaped
+		in_global_scope = (scope->flags & ScopeFlag_Global) != 0;
+	}
+
+	ir_print_encoded_global(f, ir_get_global_name(m, v), in_global_scope);
+	ir_write_string(f, str_lit(" = "));
+	if (g->is_foreign || declare_only) {
+		ir_write_string(f, str_lit("external "));
+	}
+	if (is_shared && (g->is_private || g->is_internal)) {
+		// NOTE: Referenced from the other codegen units but still not exported
+		ir_write_string(f, str_lit("hidden "));
+	}
+	if (build_context.is_dll) {
+		if (g->is_export && !declare_only) {
+			ir_write_string(f, str_lit("dllexport "));
+		}
+	}
+	if (g->thread_local_model.len > 0) {
+		String model = g->thread_local_model;
+		if (model == "default") {
+			ir_write_string(f, str_lit("thread_local "));
+		} else {
+			ir_fprintf(f, "thread_local(%.*s) ", LIT(model));
+
+		}
+	}
+
+	if (is_shared) {
+		// NOTE: Linkage handled above
+	} else if (g->is_private) {
+		ir_write_string(f, str_lit("private "));
+	} else if (g->is_internal) {
+		ir_write_string(f, str_lit("internal "));
+	}
+	if (g->is_constant) {
+		if (g->is_unnamed_addr && !declare_only) {
+			ir_write_string(f, str_lit("unnamed_addr "));
+		}
+		ir_write_string(f, str_lit("constant "));
+	} else {
+		ir_write_string(f, str_lit("global "));
+	}
+
+
+	ir_print_type(f, m, g->entity->type);
+	ir_write_byte(f, ' ');
+	if (!g->is_foreign && !declare_only) {
+		if (g->value != nullptr) {
+			ir_print_value(f, m, g->value, g->entity->type);
+		} else {
+			ir_write_string(f, str_lit("zeroinitializer"));
+		}
+		if (m->generate_debug_info) {
+			irDebugInfo **di_lookup = map_get(&m->debug_info, hash_entity(g->entity));
+			if (di_lookup != nullptr) {
+				irDebugInfo *di = *di_lookup;
+				GB_ASSERT(di);
+				GB_ASSERT(di->kind == irDebugInfo_GlobalVariableExpression);
+				ir_fprintf(f, ", !dbg !%d", di->id);
+			}
+		}
+	}
+	ir_write_byte(f, '\n');
+}
+
+void ir_print_codegen_unit(irCodegenUnit *unit) {
+	irGen *ir = unit->ir;
 	irModule *m = &ir->module;
+	bool is_only_unit = build_context.codegen_units <= 1;
+	TIMINGS_TRACE_SCOPE("ir print unit", unit->output_base);
 
 	irFileBuffer buf = {}, *f = &buf;
-	ir_file_buffer_init(f, &ir->output_file);
+	ir_file_buffer_init(f, &unit->output_file);
 	defer (ir_file_buffer_destroy(f));
+	if (!is_only_unit) {
+		f->unit = unit;
+	}
+	if (build_context.llvm_api) {
+		f->memory = &unit->llvm_ir;
+	}
+	if (build_context.incremental) {
+		unit->ir_hash = 0xcbf29ce484222325ull;
+		f->hash = &unit->ir_hash;
+	}
 
 	i32 word_bits = cast(i32)(8*build_context.word_size);
 	if (build_context.ODIN_OS == "osx" || build_context.ODIN_OS == "macos") {
@@ -2156,12 +2290,17 @@ void print_llvm_ir(irGen *ir) {
 	if (map_get(&m->members, hash_string(str_lit("llvm.bswap.i64"))) == nullptr) {
 		ir_write_str_lit(f, "declare i64 @llvm.bswap.i64(i64) \n");
 	}
+	if (map_get(&m->members, hash_string(str_lit("llvm.memset.p0i8.i64"))) == nullptr) {
+		ir_write_str_lit(f, "declare void @llvm.memset.p0i8.i64(%..rawptr, i8, i64, i32, i1) \n");
+	}
+	if (map_get(&m->members, hash_string(str_lit("llvm.memmove.p0i8.p0i8.i64"))) == nullptr) {
+		ir_write_str_lit(f, "declare void @llvm.memmove.p0i8.p0i8.i64(%..rawptr, %..rawptr, i64, i32, i1) \n");
+	}
 	ir_write_byte(f, '\n');
 
 
-	for_array(member_index, m->members.entries) {
-		auto *entry = &m->members.entries[member_index];
-		irValue *v = entry->value;
+	for_array(member_index, unit->members) {
+		irValue *v = unit->members[member_index];
 		if (v->kind != irValue_TypeName) {
 			continue;
 		}
@@ -2173,9 +2312,8 @@ void print_llvm_ir(irGen *ir) {
 	bool dll_main_found = false;
 
 	// NOTE(bill): Print foreign prototypes first
-	for_array(member_index, m->members.entries) {
-		auto *entry = &m->members.entries[member_index];
-		irValue *v = entry->value;
+	for_array(member_index, unit->members) {
+		irValue *v = unit->members[member_index];
 		if (v->kind != irValue_Proc) {
 			continue;
 		}
@@ -2185,7 +2323,15 @@ void print_llvm_ir(irGen *ir) {
 		}
 	}
 
-	if (ir->print_chkstk) {
+	// NOTE: Then the procedures defined in the other codegen units
+	for (isize i = 0; i < unit->procs.count; i++) {
+		if (unit->proc_begin <= i && i < unit->proc_end) {
+			continue;
+		}
+		ir_print_proc(f, m, &unit->procs[i]->Proc, true);
+	}
+
+	if (ir->print_chkstk && unit->index == 0) {
 		// TODO(bill): Clean up this code
 		ir_write_str_lit(f, "\n\n");
 		ir_write_str_lit(f, "define void @__chkstk() #0 {\n");
@@ -2195,86 +2341,28 @@ void print_llvm_ir(irGen *ir) {
 	}
 
 	// NOTE(bill): Print procedures with bodies next
-	for_array(member_index, m->members.entries) {
-		auto *entry = &m->members.entries[member_index];
-		irValue *v = entry->value;
-		if (v->kind != irValue_Proc) {
-			continue;
-		}
-
-		if (v->Proc.body != nullptr) {
-			ir_print_proc(f, m, &v->Proc);
-		}
+	for (isize i = unit->proc_begin; i < unit->proc_end; i++) {
+		ir_print_proc(f, m, &unit->procs[i]->Proc);
 	}
 
-	for_array(member_index, m->members.entries) {
-		auto *entry = &m->members.entries[member_index];
-		irValue *v = entry->value;
+	// NOTE: The module's globals are defined by the first unit and declared by the rest
+	for_array(member_index, unit->members) {
+		irValue *v = unit->members[member_index];
 		if (v->kind != irValue_Global) {
 			continue;
 		}
-		irValueGlobal *g = &v->Global;
-		Scope *scope = g->entity->scope;
-		bool in_global_scope = false;
-		if (scope != nullptr) {
-			// TODO(bill): Fix this rule. What should it be?
-			in_global_scope = (scope->flags & ScopeFlag_Global) != 0;
-		}
-
-		ir_print_encoded_global(f, ir_get_global_name(m, v), in_global_scope);
-		ir_write_string(f, str_lit(" = "));
-		if (g->is_foreign) {
-			ir_write_string(f, str_lit("external "));
-		}
-		if (build_context.is_dll) {
-			if (g->is_export) {
-				ir_write_string(f, str_lit("dllexport "));
-			}
-		}
-		if (g->thread_local_model.len > 0) {
-			String model = g->thread_local_model;
-			if (model == "default") {
-				ir_write_string(f, str_lit("thread_local "));
-			} else {
-				ir_fprintf(f, "thread_local(%.*s) ", LIT(model));
-
-			}
-		}
-
-		if (g->is_private) {
-			ir_write_string(f, str_lit("private "));
-		} else if (g->is_internal) {
-			ir_write_string(f, str_lit("internal "));
-		}
-		if (g->is_constant) {
-			if (g->is_unnamed_addr) {
-				ir_write_string(f, str_lit("unnamed_addr "));
-			}
-			ir_write_string(f, str_lit("constant "));
-		} else {
-			ir_write_string(f, str_lit("global "));
-		}
-
-
-		ir_print_type(f, m, g->entity->type);
-		ir_write_byte(f, ' ');
-		if (!g->is_foreign) {
-			if (g->value != nullptr) {
-				ir_print_value(f, m, g->value, g->entity->type);
-			} else {
-				ir_write_string(f, str_lit("zeroinitializer"));
-			}
-			if (m->generate_debug_info) {
-				irDebugInfo **di_lookup = map_get(&m->debug_info, hash_entity(g->entity));
-				if (di_lookup != nullptr) {
-					irDebugInfo *di = *di_lookup;
-					GB_ASSERT(di);
-					GB_ASSERT(di->kind == irDebugInfo_GlobalVariableExpression);
-					ir_fprintf(f, ", !dbg !%d", di->id);
-				}
-			}
+		ir_print_global(f, m, v, unit->index != 0, !is_only_unit);
+	}
+	// NOTE: With a single unit, the constants created whilst printing are added to the module
+	for (isize member_index = unit->members.count; member_index < m->members.entries.count; member_index++) {
+		irValue *v = m->members.entries[member_index].value;
+		if (v->kind != irValue_Global) {
+			continue;
 		}
-		ir_write_byte(f, '\n');
+		ir_print_global(f, m, v, unit->index != 0, !is_only_unit);
+	}
+	for_array(global_index, unit->globals) {
+		ir_print_global(f, m, unit->globals[global_index], false, false);
 	}
 
 	// TODO(lachsinc): Attribute map inside ir module?
@@ -2551,4 +2639,207 @@ void print_llvm_ir(irGen *ir) {
 		ir_fprintf(f, "!%d = !{i32 2, !\"CodeView\", i32 1}\n",           di_code_view);
 		ir_fprintf(f, "!%d = !{i32 1, !\"wchar_size\", i32 2}\n",         di_wchar_size);
 	}
+
+	unit->byte_count = f->byte_count;
+}
+
+
+isize ir_proc_instr_count(irProcedure *proc) {
+	isize count = 1;
+	for_array(i, proc->blocks) {
+		count += proc->blocks[i]->instrs.count;
+	}
+	for_array(i, proc->children) {
+		count += ir_proc_instr_count(proc->children[i]);
+	}
+	return count;
+}
+
+bool llvm_api_compile_codegen_unit(irCodegenUnit *unit); // NOTE: See llvm_api.cpp
+bool build_cache_reuse_object(isize unit_index, u64 ir_hash); // NOTE: See build_cache.cpp
+
+WORKER_TASK_PROC(ir_print_codegen_unit_worker_proc) {
+	irCodegenUnit *unit = cast(irCodegenUnit *)data;
+	ir_print_codegen_unit(unit);
+	bool reused = build_context.incremental && build_cache_reuse_object(unit->index, unit->ir_hash);
+	if (build_context.llvm_api) {
+		if (reused) {
+			array_free(&unit->llvm_ir);
+		} else {
+			unit->failed = !llvm_api_compile_codegen_unit(unit);
+		}
+	}
+	return 0;
+}
+
+struct irMemberEntry {
+	String   name;
+	irValue *value;
+};
+
+GB_COMPARE_PROC(ir_member_entry_cmp) {
+	irMemberEntry const *x = cast(irMemberEntry const *)a;
+	irMemberEntry const *y = cast(irMemberEntry const *)b;
+	int cmp = string_compare(x->name, y->name);
+	if (cmp != 0) {
+		return cmp;
+	}
+	return x->name.len < y->name.len ? -1 : x->name.len > y->name.len;
+}
+
+struct irCodegenUnitProc {
+	irValue *proc;
+	isize    unit_index;
+	isize    member_index;
+};
+
+GB_COMPARE_PROC(ir_codegen_unit_proc_cmp) {
+	irCodegenUnitProc const *x = cast(irCodegenUnitProc const *)a;
+	irCodegenUnitProc const *y = cast(irCodegenUnitProc const *)b;
+	if (x->unit_index != y->unit_index) {
+		return x->unit_index < y->unit_index ? -1 : +1;
+	}
+	return x->member_index < y->member_index ? -1 : x->member_index > y->member_index;
+}
+
+// NOTE: Each package always goes into the same unit, so that a change to one package does not
+// change the LLVM IR of the units of the others and their object files may be reused
+void ir_codegen_units_by_package(Array<irCodegenUnit> units, Array<irValue *> procs) {
+	isize unit_count = units.count;
+	auto list = array_make<irCodegenUnitProc>(heap_allocator(), procs.count);
+	defer (array_free(&list));
+	for_array(i, procs) {
+		Entity *e = procs[i]->Proc.entity;
+		String path = {};
+		if (e != nullptr && e->pkg != nullptr) {
+			path = e->pkg->fullpath;
+		}
+		u64 h = build_cache__hash(0xcbf29ce484222325ull, path.text, path.len);
+		list[i].proc         = procs[i];
+		list[i].unit_index   = cast(isize)(h % cast(u64)unit_count);
+		list[i].member_index = i;
+	}
+	gb_sort_array(list.data, list.count, ir_codegen_unit_proc_cmp);
+
+	isize proc_index = 0;
+	for_array(i, units) {
+		irCodegenUnit *unit = &units[i];
+		unit->proc_begin = proc_index;
+		while (proc_index < list.count && list[proc_index].unit_index == i) {
+			procs[proc_index] = list[proc_index].proc;
+			proc_index += 1;
+		}
+		unit->proc_end = proc_index;
+	}
+}
+
+bool print_llvm_ir(irGen *ir) {
+	irModule *m = &ir->module;
+	isize unit_count = build_context.codegen_units;
+
+	auto members = array_make<irValue *>(heap_allocator(), 0, m->members.entries.count);
+	defer (array_free(&members));
+	if (build_context.incremental) {
+		// NOTE: The order in which members are added varies between builds, but the object file
+		// of a codegen unit is only reused if its LLVM IR is exactly the same
+		auto entries = array_make<irMemberEntry>(heap_allocator(), m->members.entries.count);
+		defer (array_free(&entries));
+		for_array(member_index, m->members.entries) {
+			entries[member_index].name  = m->members.entries[member_index].key.string;
+			entries[member_index].value = m->members.entries[member_index].value;
+		}
+		gb_sort_array(entries.data, entries.count, ir_member_entry_cmp);
+		for_array(i, entries) {
+			array_add(&members, entries[i].value);
+		}
+	} else {
+		for_array(member_index, m->members.entries) {
+			array_add(&members, m->members.entries[member_index].value);
+		}
+	}
+
+	auto procs = array_make<irValue *>(heap_allocator(), 0, members.count);
+	defer (array_free(&procs));
+	isize total_instr_count = 0;
+	for_array(member_index, members) {
+		irValue *v = members[member_index];
+		if (v->kind == irValue_Proc && v->Proc.body != nullptr) {
+			array_add(&procs, v);
+			total_instr_count += ir_proc_instr_count(&v->Proc);
+		}
+	}
+
+	auto units = array_make<irCodegenUnit>(heap_allocator(), unit_count);
+	defer (array_free(&units));
+
+	// NOTE: Contiguous runs of procedures of about the same size, so that procedures
+	// from the same package mostly end up in the same unit
+	isize proc_index = 0;
+	isize instr_count = 0;
+	for_array(i, units) {
+		irCodegenUnit *unit = &units[i];
+		unit->ir          = ir;
+		unit->index       = i;
+		unit->output_base = ir_codegen_unit_output_base(ir->output_base, i);
+		unit->members     = members;
+		unit->procs       = procs;
+		unit->proc_begin  = proc_index;
+		array_init(&unit->globals, heap_allocator());
+		if (build_context.llvm_api) {
+			array_init(&unit->llvm_ir, heap_allocator());
+		}
+
+		isize limit = total_instr_count*(i+1)/unit_count;
+		while (proc_index < procs.count && (instr_count < limit || i+1 == unit_count)) {
+			instr_count += ir_proc_instr_count(&procs[proc_index]->Proc);
+			proc_index += 1;
+		}
+		unit->proc_end = proc_index;
+	}
+	if (build_context.incremental && unit_count > 1) {
+		ir_codegen_units_by_package(units, procs);
+	}
+
+	if (unit_count == 1) {
+		units[0].output_file = ir->output_file;
+		ir_print_codegen_unit_worker_proc(&units[0]);
+		array_free(&units[0].globals);
+		ir->byte_count = units[0].byte_count;
+		return !units[0].failed;
+	}
+
+	for_array(i, units) {
+		irCodegenUnit *unit = &units[i];
+		if (build_context.llvm_api) {
+			continue;
+		}
+		String path = concatenate_strings(heap_allocator(), unit->output_base, str_lit(".ll"));
+		char *output_file_path = cast(char *)path.text;
+		defer (gb_free(heap_allocator(), path.text));
+
+		gbFileError err = gb_file_create(&unit->output_file, output_file_path);
+		if (err != gbFileError_None) {
+			gb_printf_err("Failed to create file %s\n", output_file_path);
+			return false;
+		}
+	}
+
+	ThreadPool pool = {};
+	thread_pool_init(&pool, heap_allocator(), gb_min(build_context.thread_count, unit_count));
+	for_array(i, units) {
+		thread_pool_add_task(&pool, ir_print_codegen_unit_worker_proc, &units[i]);
+	}
+	thread_pool_wait_to_process(&pool);
+	thread_pool_destroy(&pool);
+
+	bool ok = true;
+	for_array(i, units) {
+		if (!build_context.llvm_api) {
+			gb_file_close(&units[i].output_file);
+		}
+		array_free(&units[i].globals);
+		ir->byte_count += units[i].byte_count;
+		ok &= !units[i].failed;
+	}
+	return ok;
 }
@@ -0,0 +1,156 @@
+// LLVM C API backend, used with '-llvm-api'
+//
+// Each codegen unit is printed into memory rather than to a .ll file, then parsed, optimized and
+// emitted as an object file within the compiler, rather than through 'opt' and 'llc' which each
+// have to parse the module again from disk.
+//
+// NOTE: Only available when the compiler is built with ODIN_LLVM_API defined and linked
+// against LLVM 13 or later (for 'LLVMRunPasses'), e.g. 'make debug_llvm_api'
+
+#if defined(ODIN_LLVM_API)
+#include <llvm-c/Analysis.h>
+#include <llvm-c/Core.h>
+#include <llvm-c/IRReader.h>
+#include <llvm-c/Target.h>
+#include <llvm-c/TargetMachine.h>
+#include <llvm-c/Transforms/PassBuilder.h>
+
+gb_global gbString llvm_api_passes = nullptr;
+
+void llvm_api_init(void) {
+	LLVMInitializeX86TargetInfo();
+	LLVMInitializeX86Target();
+	LLVMInitializeX86TargetMC();
+	LLVMInitializeX86AsmPrinter();
+
+	// NOTE: The same as 'build_context.opt_flags', 'dce' replaces '-die' which the new pass
+	// manager does not have
+	llvm_api_passes = gb_string_make(heap_allocator(), "");
+	if (build_context.optimization_level != 0) {
+		llvm_api_passes = gb_string_append_fmt(llvm_api_passes, "default<O%d>", build_context.optimization_level);
+	}
+	if (build_context.ODIN_DEBUG == false) {
+		if (gb_string_length(llvm_api_passes) > 0) {
+			llvm_api_passes = gb_string_appendc(llvm_api_passes, ",");
+		}
+		llvm_api_passes = gb_string_appendc(llvm_api_passes, "memcpyopt,dce");
+	}
+}
+
+// NOTE: The same target as 'llc' would choose with 'build_context.llc_flags'
+gbString llvm_api_target_triple(LLVMModuleRef mod) {
+	gbString triple = gb_string_make(heap_allocator(), LLVMGetTarget(mod));
+	if (gb_string_length(triple) > 0) {
+		return triple;
+	}
+	if (str_eq_ignore_case(cross_compile_target, str_lit("Essence"))) {
+		return gb_string_appendc(triple, "x86_64-pc-none-elf");
+	}
+
+	char *default_triple = LLVMGetDefaultTargetTriple();
+	defer (LLVMDisposeMessage(default_triple));
+	String vendor_os = make_string_c(default_triple);
+	for (isize i = 0; i < vendor_os.len; i++) {
+		if (vendor_os[i] == '-') {
+			vendor_os = substring(vendor_os, i, vendor_os.len);
+			break;
+		}
+	}
+	triple = gb_string_appendc(triple, build_context.word_size == 8 ? "x86_64" : "i386");
+	return gb_string_append_length(triple, vendor_os.text, vendor_os.len);
+}
+
+bool llvm_api_compile_codegen_unit(irCodegenUnit *unit) {
+	TIMINGS_TRACE_SCOPE("llvm api unit", unit->output_base);
+
+	gbAllocator a = heap_allocator();
+	char *name = alloc_cstring(a, unit->output_base);
+	defer (gb_free(a, name));
+#if defined(GB_SYSTEM_WINDOWS)
+	String object_path = concatenate_strings(a, unit->output_base, str_lit(".obj"));
+#else
+	String object_path = concatenate_strings(a, unit->output_base, str_lit(".o"));
+#endif
+	defer (gb_free(a, object_path.text));
+
+	LLVMContextRef ctx = LLVMContextCreate();
+	defer (LLVMContextDispose(ctx));
+
+	// NOTE: The parser expects the buffer to be null terminated
+	array_add(&unit->llvm_ir, cast(u8)0);
+	LLVMMemoryBufferRef buffer = LLVMCreateMemoryBufferWithMemoryRange(cast(char *)unit->llvm_ir.data, unit->llvm_ir.count-1, name, true);
+	LLVMModuleRef mod = nullptr;
+	char *message = nullptr;
+	bool failed = LLVMParseIRInContext(ctx, buffer, &mod, &message) != 0;
+	array_free(&unit->llvm_ir);
+	if (failed) {
+		gb_printf_err("%s: %s\n", name, message);
+		LLVMDisposeMessage(message);
+		return false;
+	}
+	defer (LLVMDisposeModule(mod));
+
+	if (LLVMVerifyModule(mod, LLVMReturnStatusAction, &message)) {
+		gb_printf_err("%s: %s\n", name, message);
+		LLVMDisposeMessage(message);
+		return false;
+	}
+	LLVMDisposeMessage(message);
+
+	gbString triple = llvm_api_target_triple(mod);
+	defer (gb_string_free(triple));
+	LLVMTargetRef target = nullptr;
+	if (LLVMGetTargetFromTriple(triple, &target, &message)) {
+		gb_printf_err("%s: %s\n", triple, message);
+		LLVMDisposeMessage(message);
+		return false;
+	}
+
+	LLVMCodeGenOptLevel opt_level = LLVMCodeGenLevelNone;
+	switch (build_context.optimization_level) {
+	case 1: opt_level = LLVMCodeGenLevelLess;       break;
+	case 2: opt_level = LLVMCodeGenLevelDefault;    break;
+	case 3: opt_level = LLVMCodeGenLevelAggressive; break;
+	}
+#if defined(GB_SYSTEM_WINDOWS)
+	LLVMRelocMode reloc = LLVMRelocDefault;
+#else
+	LLVMRelocMode reloc = LLVMRelocPIC;
+#endif
+	LLVMTargetMachineRef machine = LLVMCreateTargetMachine(target, triple, "", "", opt_level, reloc, LLVMCodeModelDefault);
+	defer (LLVMDisposeTargetMachine(machine));
+
+	LLVMSetTarget(mod, triple);
+	LLVMTargetDataRef data_layout = LLVMCreateTargetDataLayout(machine);
+	LLVMSetModuleDataLayout(mod, data_layout);
+	LLVMDisposeTargetData(data_layout);
+
+	if (gb_string_length(llvm_api_passes) > 0) {
+		LLVMPassBuilderOptionsRef options = LLVMCreatePassBuilderOptions();
+		defer (LLVMDisposePassBuilderOptions(options));
+		LLVMErrorRef err = LLVMRunPasses(mod, llvm_api_passes, machine, options);
+		if (err != nullptr) {
+			message = LLVMGetErrorMessage(err);
+			gb_printf_err("%s: %s\n", name, message);
+			LLVMDisposeErrorMessage(message);
+			return false;
+		}
+	}
+
+	if (LLVMTargetMachineEmitToFile(machine, mod, cast(char *)object_path.text, LLVMObjectFile, &message)) {
+		gb_printf_err("%.*s: %s\n", LIT(object_path), message);
+		LLVMDisposeMessage(message);
+		return false;
+	}
+	return true;
+}
+
+#else
+void llvm_api_init(void) {
+}
+
+bool llvm_api_compile_codegen_unit(irCodegenUnit *unit) {
+	GB_PANIC("The compiler was built without ODIN_LLVM_API");
+	return false;
+}
+#endif
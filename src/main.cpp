@@ -16,16 +16,39 @@
 #include "ir.cpp"
 #include "ir_opt.cpp"
 #include "ir_print.cpp"
+#include "llvm_api.cpp"
+#include "build_cache.cpp"
+#include "ast_cache.cpp"
+#include "decl_graph.cpp"
+#include "benchmark.cpp"
+
+// NOTE: A link step names the object file of every codegen unit, so the command line may be
+// longer than any fixed buffer. 'vsnprintf' is used rather than 'gb_snprintf_va', as the latter
+// writes past the end of the buffer when a string argument does not fit.
+// The result is null terminated and 'len_' includes the null.
+char *system_format_command_line(isize *len_, char const *fmt, va_list va) {
+	va_list args;
+	va_copy(args, va);
+	int len = vsnprintf(nullptr, 0, fmt, args);
+	va_end(args);
+	GB_ASSERT(len >= 0);
+
+	char *cmd_line = gb_alloc_array(heap_allocator(), char, len+1);
+	va_copy(args, va);
+	vsnprintf(cmd_line, len+1, fmt, args);
+	va_end(args);
+	*len_ = len+1;
+	return cmd_line;
+}
 
 // NOTE(bill): 'name' is used in debugging and profiling modes
 i32 system_exec_command_line_app(char *name, bool is_silent, char *fmt, ...) {
 #if defined(GB_SYSTEM_WINDOWS)
 	STARTUPINFOW start_info = {gb_size_of(STARTUPINFOW)};
 	PROCESS_INFORMATION pi = {0};
-	char cmd_line[4*1024] = {0};
+	char *cmd_line;
 	isize cmd_len;
 	va_list va;
-	gbTempArenaMemory tmp;
 	String16 cmd;
 	i32 exit_code = 0;
 
@@ -36,20 +59,23 @@ i32 system_exec_command_line_app(char *name, bool is_silent, char *fmt, ...) {
 	start_info.hStdError   = GetStdHandle(STD_ERROR_HANDLE);
 
 	va_start(va, fmt);
-	cmd_len = gb_snprintf_va(cmd_line, gb_size_of(cmd_line), fmt, va);
+	cmd_line = system_format_command_line(&cmd_len, fmt, va);
 	va_end(va);
+	defer (gb_free(heap_allocator(), cmd_line));
 
 	// gb_printf_err("%.*s\n", cast(int)cmd_len, cmd_line);
 
-	tmp = gb_temp_arena_memory_begin(&string_buffer_arena);
-	defer (gb_temp_arena_memory_end(tmp));
-
-	cmd = string_to_string16(string_buffer_allocator, make_string(cast(u8 *)cmd_line, cmd_len-1));
+	// NOTE: Not the string buffer arena, as codegen units are compiled concurrently
+	cmd = string_to_string16(heap_allocator(), make_string(cast(u8 *)cmd_line, cmd_len-1));
+	defer (gb_free(heap_allocator(), cmd.text));
+	u64 trace_start = timings_trace_begin();
 	if (CreateProcessW(nullptr, cmd.text,
 	                   nullptr, nullptr, true, 0, nullptr, nullptr,
 	                   &start_info, &pi)) {
 		WaitForSingleObject(pi.hProcess, INFINITE);
 		GetExitCodeProcess(pi.hProcess, cast(DWORD *)&exit_code);
+		timings_trace_end("external tool", make_string_c(name), trace_start,
+		                  make_string(cast(u8 *)cmd_line, cmd_len-1));
 
 		CloseHandle(pi.hProcess);
 		CloseHandle(pi.hThread);
@@ -63,19 +89,22 @@ i32 system_exec_command_line_app(char *name, bool is_silent, char *fmt, ...) {
 
 #elif defined(GB_SYSTEM_OSX) || defined(GB_SYSTEM_UNIX)
 
-	char cmd_line[4096] = {0};
+	char *cmd_line;
 	isize cmd_len;
 	va_list va;
 	String cmd;
 	i32 exit_code = 0;
 
 	va_start(va, fmt);
-	cmd_len = gb_snprintf_va(cmd_line, gb_size_of(cmd_line), fmt, va);
+	cmd_line = system_format_command_line(&cmd_len, fmt, va);
 	va_end(va);
-	cmd = make_string(cast(u8 *)&cmd_line, cmd_len-1);
+	defer (gb_free(heap_allocator(), cmd_line));
+	cmd = make_string(cast(u8 *)cmd_line, cmd_len-1);
 
 	//printf("do: %s\n", cmd_line);
+	u64 trace_start = timings_trace_begin();
 	exit_code = system(&cmd_line[0]);
+	timings_trace_end("external tool", make_string_c(name), trace_start, cmd);
 
 	// pid_t pid = fork();
 	// int status = 0;
@@ -164,6 +193,7 @@ void usage(String argv0) {
 	print_usage_line(1, "check     parse and type check .odin file");
 	print_usage_line(1, "docs      generate documentation for a .odin file");
 	print_usage_line(1, "version   print version");
+	print_usage_line(1, "benchmark run a micro-benchmark of the compiler");
 }
 
 
@@ -205,7 +235,11 @@ enum BuildFlagKind {
 	BuildFlag_OptimizationLevel,
 	BuildFlag_ShowTimings,
 	BuildFlag_ThreadCount,
+	BuildFlag_CodegenUnits,
 	BuildFlag_KeepTempFiles,
+	BuildFlag_Incremental,
+	BuildFlag_AstCache,
+	BuildFlag_LlvmApi,
 	BuildFlag_Collection,
 	BuildFlag_BuildMode,
 	BuildFlag_Debug,
@@ -227,6 +261,7 @@ enum BuildFlagParamKind {
 	BuildFlagParam_Integer,
 	BuildFlagParam_Float,
 	BuildFlagParam_String,
+	BuildFlagParam_OptionalString,
 
 	BuildFlagParam_COUNT,
 };
@@ -247,9 +282,13 @@ bool parse_build_flags(Array<String> args) {
 	add_flag(&build_flags, BuildFlag_OutFile,           str_lit("out"),             BuildFlagParam_String);
 	add_flag(&build_flags, BuildFlag_ResourceFile,      str_lit("resource"),        BuildFlagParam_String);
 	add_flag(&build_flags, BuildFlag_OptimizationLevel, str_lit("opt"),             BuildFlagParam_Integer);
-	add_flag(&build_flags, BuildFlag_ShowTimings,       str_lit("show-timings"),    BuildFlagParam_None);
+	add_flag(&build_flags, BuildFlag_ShowTimings,       str_lit("show-timings"),    BuildFlagParam_OptionalString);
 	add_flag(&build_flags, BuildFlag_ThreadCount,       str_lit("thread-count"),    BuildFlagParam_Integer);
+	add_flag(&build_flags, BuildFlag_CodegenUnits,      str_lit("codegen-units"),   BuildFlagParam_Integer);
 	add_flag(&build_flags, BuildFlag_KeepTempFiles,     str_lit("keep-temp-files"), BuildFlagParam_None);
+	add_flag(&build_flags, BuildFlag_Incremental,       str_lit("incremental"),     BuildFlagParam_None);
+	add_flag(&build_flags, BuildFlag_AstCache,          str_lit("ast-cache"),       BuildFlagParam_None);
+	add_flag(&build_flags, BuildFlag_LlvmApi,           str_lit("llvm-api"),        BuildFlagParam_None);
 	add_flag(&build_flags, BuildFlag_Collection,        str_lit("collection"),      BuildFlagParam_String);
 	add_flag(&build_flags, BuildFlag_BuildMode,         str_lit("build-mode"),      BuildFlagParam_String);
 	add_flag(&build_flags, BuildFlag_Debug,             str_lit("debug"),           BuildFlagParam_None);
@@ -276,7 +315,7 @@ bool parse_build_flags(Array<String> args) {
 		String name = substring(flag, 1, flag.len);
 		isize end = 0;
 		for (; end < name.len; end++) {
-			if (name[end] == '=') break;
+			if (name[end] == '=' || name[end] == ':') break;
 		}
 		name = substring(name, 0, end);
 		String param = {};
@@ -300,6 +339,11 @@ bool parse_build_flags(Array<String> args) {
 							gb_printf_err("Flag '%.*s' was not expecting a parameter '%.*s'\n", LIT(name), LIT(param));
 							bad_flags = true;
 						}
+					} else if (bf.param_kind == BuildFlagParam_OptionalString) {
+						ok = true;
+						if (param.len > 0) {
+							value = exact_value_string(param);
+						}
 					} else if (param.len == 0) {
 						gb_printf_err("Flag missing for '%.*s'\n", LIT(name));
 						bad_flags = true;
@@ -419,8 +463,15 @@ bool parse_build_flags(Array<String> args) {
 							build_context.optimization_level = cast(i32)big_int_to_i64(&value.value_integer);
 							break;
 						case BuildFlag_ShowTimings:
-							GB_ASSERT(value.kind == ExactValue_Invalid);
 							build_context.show_timings = true;
+							if (value.kind == ExactValue_String) {
+								if (value.value_string == "json") {
+									build_context.show_timings_json = true;
+								} else {
+									gb_printf_err("Invalid -show-timings format '%.*s', expected 'json'\n", LIT(value.value_string));
+									bad_flags = true;
+								}
+							}
 							break;
 						case BuildFlag_ThreadCount: {
 							GB_ASSERT(value.kind == ExactValue_Integer);
@@ -433,10 +484,38 @@ bool parse_build_flags(Array<String> args) {
 							}
 							break;
 						}
+						case BuildFlag_CodegenUnits: {
+							GB_ASSERT(value.kind == ExactValue_Integer);
+							isize count = cast(isize)big_int_to_i64(&value.value_integer);
+							if (count <= 0) {
+								gb_printf_err("%.*s expected a positive non-zero number, got %.*s\n", LIT(name), LIT(param));
+								build_context.codegen_units = 1;
+							} else {
+								build_context.codegen_units = count;
+							}
+							break;
+						}
 						case BuildFlag_KeepTempFiles:
 							GB_ASSERT(value.kind == ExactValue_Invalid);
 							build_context.keep_temp_files = true;
 							break;
+						case BuildFlag_Incremental:
+							GB_ASSERT(value.kind == ExactValue_Invalid);
+							build_context.incremental = true;
+							break;
+						case BuildFlag_AstCache:
+							GB_ASSERT(value.kind == ExactValue_Invalid);
+							build_context.ast_cache = true;
+							break;
+						case BuildFlag_LlvmApi:
+							GB_ASSERT(value.kind == ExactValue_Invalid);
+						#if defined(ODIN_LLVM_API)
+							build_context.llvm_api = true;
+						#else
+							gb_printf_err("-llvm-api requires a compiler built with ODIN_LLVM_API (see 'make debug_llvm_api')\n");
+							bad_flags = true;
+						#endif
+							break;
 
 						case BuildFlag_CrossCompile: {
 							GB_ASSERT(value.kind == ExactValue_String);
@@ -593,8 +672,25 @@ bool parse_build_flags(Array<String> args) {
 	return !bad_flags;
 }
 
-void show_timings(Checker *c, Timings *t) {
-	Parser *p      = c->parser;
+TimeStamp const *find_timings_section(Timings *t, String label) {
+	for_array(i, t->sections) {
+		if (t->sections[i].label == label) {
+			return &t->sections[i];
+		}
+	}
+	return nullptr;
+}
+
+void show_timings_pass(char const *name, f64 time, isize lines, isize tokens) {
+	gb_printf("%s\n", name);
+	gb_printf("LOC/s        - %.3f\n", cast(f64)lines/time);
+	gb_printf("us/LOC       - %.3f\n", 1.0e6*time/cast(f64)lines);
+	gb_printf("Tokens/s     - %.3f\n", cast(f64)tokens/time);
+	gb_printf("us/Token     - %.3f\n", 1.0e6*time/cast(f64)tokens);
+	gb_printf("\n");
+}
+
+void show_timings(Parser *p, CheckerInfo *info, Timings *t) {
 	isize lines    = p->total_line_count;
 	isize tokens   = p->total_token_count;
 	isize files    = 0;
@@ -602,71 +698,101 @@ void show_timings(Checker *c, Timings *t) {
 	for_array(i, p->packages) {
 		files += p->packages[i]->files.count;
 	}
-#if 1
+
+	if (build_context.show_timings_json) {
+		TimingsTrace *trace = global_timings_trace;
+		GB_ASSERT(trace != nullptr);
+		timings_finish(t);
+		timings_trace_add_counter(trace, "lines",     lines);
+		timings_trace_add_counter(trace, "tokens",    tokens);
+		timings_trace_add_counter(trace, "files",     files);
+		timings_trace_add_counter(trace, "packages",  packages);
+		timings_trace_add_counter(trace, "ast_nodes", p->total_node_count);
+		timings_trace_add_counter(trace, "types",     gb_atomic64_load(&global_type_count));
+		timings_trace_add_counter(trace, "entities",  gb_atomic64_load(&global_entity_id));
+		timings_trace_add_counter(trace, "type_info_slow_lookups", info->type_info_slow_lookup_count);
+		if (build_context.ast_cache) {
+			timings_trace_add_counter(trace, "ast_cache_loads", p->ast_cache_load_count);
+			timings_trace_add_counter(trace, "ast_cache_saves", p->ast_cache_save_count);
+		}
+
+		String output_name = {};
+		String output_base = {};
+		ir_gen_output_paths(p->init_fullpath, &output_name, &output_base);
+		String path = concatenate_strings(heap_allocator(), output_base, str_lit(".timings.json"));
+		defer (gb_free(heap_allocator(), path.text));
+		if (!timings_write_trace_json(t, trace, path)) {
+			gb_printf_err("Failed to write timings to %.*s\n", LIT(path));
+		}
+		return;
+	}
+
 	timings_print_all(t);
-#else
-	{
-		timings_print_all(t);
-		gb_printf("\n");
-		gb_printf("Total Lines    - %td\n", lines);
-		gb_printf("Total Tokens   - %td\n", tokens);
-		gb_printf("Total Files    - %td\n", files);
-		gb_printf("Total Packages - %td\n", packages);
+	gb_printf("\n");
+	gb_printf("Total Lines    - %td\n", lines);
+	gb_printf("Total Tokens   - %td\n", tokens);
+	gb_printf("Total Files    - %td\n", files);
+	gb_printf("Total Packages - %td\n", packages);
+	gb_printf("\n");
+	gb_printf("Type info slow lookups - %td\n", info->type_info_slow_lookup_count);
+	gb_printf("\n");
+	if (build_context.ast_cache) {
+		gb_printf("AST cache loads - %td files\n", p->ast_cache_load_count);
+		gb_printf("AST cache saves - %td files\n", p->ast_cache_save_count);
 		gb_printf("\n");
 	}
-	{
-		TimeStamp ts = t->sections[0];
-		GB_ASSERT(ts.label == "parse files");
-		f64 parse_time = time_stamp_as_s(ts, t->freq);
-		gb_printf("Parse pass\n");
-		gb_printf("LOC/s        - %.3f\n", cast(f64)lines/parse_time);
-		gb_printf("us/LOC       - %.3f\n", 1.0e6*parse_time/cast(f64)lines);
-		gb_printf("Tokens/s     - %.3f\n", cast(f64)tokens/parse_time);
-		gb_printf("us/Token     - %.3f\n", 1.0e6*parse_time/cast(f64)tokens);
-		gb_printf("\n");
+	if (lines > 0 && tokens > 0) {
+		TimeStamp const *parse = find_timings_section(t, str_lit("parse files"));
+		TimeStamp const *check = find_timings_section(t, str_lit("type check"));
+		if (parse != nullptr) {
+			show_timings_pass("Parse pass", time_stamp_as_s(*parse, t->freq), lines, tokens);
+		}
+		if (check != nullptr) {
+			show_timings_pass("Checker pass", time_stamp_as_s(*check, t->freq), lines, tokens);
+		}
+		show_timings_pass("Total pass", t->total_time_seconds, lines, tokens);
 	}
-	{
-		TimeStamp ts = t->sections[1];
-		GB_ASSERT(ts.label == "type check");
-		f64 parse_time = time_stamp_as_s(ts, t->freq);
-		gb_printf("Checker pass\n");
-		gb_printf("LOC/s        - %.3f\n", cast(f64)lines/parse_time);
-		gb_printf("us/LOC       - %.3f\n", 1.0e6*parse_time/cast(f64)lines);
-		gb_printf("Tokens/s     - %.3f\n", cast(f64)tokens/parse_time);
-		gb_printf("us/Token     - %.3f\n", 1.0e6*parse_time/cast(f64)tokens);
-		gb_printf("\n");
+
+	arena_print_stats();
+	if (global_build_cache != nullptr) {
+		build_cache_print_stats(global_build_cache);
 	}
-	{
-		f64 total_time = t->total_time_seconds;
-		gb_printf("Total pass\n");
-		gb_printf("LOC/s        - %.3f\n", cast(f64)lines/total_time);
-		gb_printf("us/LOC       - %.3f\n", 1.0e6*total_time/cast(f64)lines);
-		gb_printf("Tokens/s     - %.3f\n", cast(f64)tokens/total_time);
-		gb_printf("us/Token     - %.3f\n", 1.0e6*total_time/cast(f64)tokens);
-		gb_printf("\n");
+	if (global_decl_graph != nullptr) {
+		decl_graph_print_stats(global_decl_graph);
 	}
-#endif
 }
 
 void remove_temp_files(String output_base) {
 	if (build_context.keep_temp_files) return;
 
-	auto data = array_make<u8>(heap_allocator(), output_base.len + 10);
+	auto data = array_make<u8>(heap_allocator(), output_base.len + 32);
 	defer (array_free(&data));
 
-	isize n = output_base.len;
-	gb_memmove(data.data, output_base.text, n);
+	isize n = 0;
 #define EXT_REMOVE(s) do {                         \
 		gb_memmove(data.data+n, s, gb_size_of(s)); \
 		gb_file_remove(cast(char *)data.data);     \
 	} while (0)
-	EXT_REMOVE(".ll");
-	EXT_REMOVE(".bc");
+	for (isize i = 0; i < build_context.codegen_units; i++) {
+		String base = ir_codegen_unit_output_base(output_base, i);
+		n = base.len;
+		gb_memmove(data.data, base.text, n);
+
+		EXT_REMOVE(".ll");
+		EXT_REMOVE(".bc");
+		if (!build_context.incremental) {
+			// NOTE: The object files are reused by the next incremental build
+		#if defined(GB_SYSTEM_WINDOWS)
+			EXT_REMOVE(".obj");
+		#else
+			EXT_REMOVE(".o");
+		#endif
+		}
+	}
 #if defined(GB_SYSTEM_WINDOWS)
-	EXT_REMOVE(".obj");
+	n = output_base.len;
+	gb_memmove(data.data, output_base.text, n);
 	EXT_REMOVE(".res");
-#else
-	EXT_REMOVE(".o");
 #endif
 
 #undef EXT_REMOVE
@@ -722,6 +848,57 @@ i32 exec_llvm_llc(String output_base) {
 
 
 
+struct CodegenUnitTask {
+	String output_base;
+	i32    exit_code;
+};
+
+WORKER_TASK_PROC(codegen_unit_worker_proc) {
+	CodegenUnitTask *task = cast(CodegenUnitTask *)data;
+	task->exit_code = exec_llvm_opt(task->output_base);
+	if (task->exit_code == 0) {
+		task->exit_code = exec_llvm_llc(task->output_base);
+	}
+	return 0;
+}
+
+// NOTE: Each codegen unit goes through opt and llc independently of the others
+i32 exec_llvm_codegen_units(String output_base) {
+	isize unit_count = build_context.codegen_units;
+	auto tasks = array_make<CodegenUnitTask>(heap_allocator(), unit_count);
+	defer (array_free(&tasks));
+
+	ThreadPool pool = {};
+	thread_pool_init(&pool, heap_allocator(), gb_min(build_context.thread_count, unit_count));
+	for_array(i, tasks) {
+		tasks[i].output_base = ir_codegen_unit_output_base(output_base, i);
+		if (build_cache_object_is_reused(global_build_cache, i)) {
+			continue;
+		}
+		thread_pool_add_task(&pool, codegen_unit_worker_proc, &tasks[i]);
+	}
+	thread_pool_wait_to_process(&pool);
+	thread_pool_destroy(&pool);
+
+	for_array(i, tasks) {
+		if (tasks[i].exit_code != 0) {
+			return tasks[i].exit_code;
+		}
+	}
+	return 0;
+}
+
+// NOTE: The quoted object files of all the codegen units, as passed to the linker
+gbString codegen_unit_object_files(String output_base, char const *ext) {
+	gbString objects = gb_string_make(heap_allocator(), "");
+	for (isize i = 0; i < build_context.codegen_units; i++) {
+		String base = ir_codegen_unit_output_base(output_base, i);
+		objects = gb_string_append_fmt(objects, "%s\"%.*s%s\"", i > 0 ? " " : "", LIT(base), ext);
+	}
+	return objects;
+}
+
+
 int main(int arg_count, char **arg_ptr) {
 	if (arg_count < 2) {
 		usage(make_string_c(arg_ptr[0]));
@@ -733,9 +910,14 @@ int main(int arg_count, char **arg_ptr) {
 	defer (timings_destroy(&timings));
 
 	init_string_buffer_memory();
+	init_string_interner();
 	init_global_error_collector();
+	init_keyword_hash_table();
+	init_directive_hash_table();
 	global_big_int_init();
-	arena_init(&global_ast_arena, heap_allocator());
+	arena_init(&global_ast_arena, heap_allocator(), "ast");
+	arena_init(&global_type_arena, heap_allocator(), "type");
+	arena_init(&global_entity_arena, heap_allocator(), "entity");
 
 	array_init(&library_collections, heap_allocator());
 	// NOTE(bill): 'core' cannot be (re)defined by the user
@@ -797,6 +979,8 @@ int main(int arg_count, char **arg_ptr) {
 		print_usage_line(0, "Documentation generation is not yet supported");
 		return 1;
 		#endif
+	} else if (command == "benchmark") {
+		return benchmark_main(args[0], array_slice(args, 2, args.count));
 	} else if (command == "version") {
 		gb_printf("%.*s version %.*s\n", LIT(args[0]), LIT(ODIN_VERSION));
 		return 0;
@@ -827,8 +1011,20 @@ int main(int arg_count, char **arg_ptr) {
 	}
 
 	init_universal();
+	if (build_context.ast_cache) {
+		init_ast_cache();
+	}
+	if (build_context.llvm_api) {
+		llvm_api_init();
+	}
 	// TODO(bill): prevent compiling without a linker
 
+	TimingsTrace timings_trace = {};
+	if (build_context.show_timings_json) {
+		timings_trace_init(&timings_trace);
+	}
+	defer (if (build_context.show_timings_json) timings_trace_destroy(&timings_trace));
+
 	timings_start_section(&timings, str_lit("parse files"));
 
 	Parser parser = {0};
@@ -847,19 +1043,48 @@ int main(int arg_count, char **arg_ptr) {
 	}
 
 
-	timings_start_section(&timings, str_lit("type check"));
+	BuildCache build_cache = {};
+	bool use_build_cache = false;
+	if (build_context.incremental && !build_context.no_output_files) {
+		timings_start_section(&timings, str_lit("build cache"));
 
-	Checker checker = {0};
+		String output_name = {};
+		String output_base = {};
+		ir_gen_output_paths(parser.init_fullpath, &output_name, &output_base);
+		build_cache_init(&build_cache, &parser, output_base);
+		use_build_cache = build_cache_load(&build_cache);
+		global_build_cache = &build_cache;
+	}
 
-	init_checker(&checker, &parser);
-	defer (destroy_checker(&checker));
+	DeclGraph decl_graph = {};
+	defer (if (global_decl_graph != nullptr) decl_graph_destroy(&decl_graph));
 
-	check_parsed_files(&checker);
+	Checker checker = {0};
+	defer (if (!use_build_cache) destroy_checker(&checker));
+
+	if (!use_build_cache) {
+		timings_start_section(&timings, str_lit("type check"));
+
+		init_checker(&checker, &parser);
+		if (build_context.incremental) {
+			String output_name = {};
+			String output_base = {};
+			ir_gen_output_paths(parser.init_fullpath, &output_name, &output_base);
+			decl_graph_init(&decl_graph, output_base);
+			decl_graph_load(&decl_graph);
+			checker.decl_graph = &decl_graph;
+			global_decl_graph = &decl_graph;
+		}
+		check_parsed_files(&checker);
+		if (checker.decl_graph != nullptr && global_error_collector.count == 0 && global_error_collector.warning_count == 0) {
+			decl_graph_save(&decl_graph, &checker);
+		}
+	}
 
 #if 1
 	if (build_context.no_output_files) {
 		if (build_context.show_timings) {
-			show_timings(&checker, &timings);
+			show_timings(&parser, &checker.info, &timings);
 		}
 
 		if (global_error_collector.count != 0) {
@@ -869,40 +1094,85 @@ int main(int arg_count, char **arg_ptr) {
 		return 0;
 	}
 
-	irGen ir_gen = {0};
-	if (!ir_gen_init(&ir_gen, &checker)) {
-		return 1;
-	}
-	// defer (ir_gen_destroy(&ir_gen));
+	String output_name = {};
+	String output_base = {};
+	Array<String> foreign_library_paths = {};
+	bool generate_debug_info = false;
 
+	build_context.optimization_level = gb_clamp(build_context.optimization_level, 0, 3);
 
-	timings_start_section(&timings, str_lit("llvm ir gen"));
-	ir_gen_tree(&ir_gen);
+	i32 exit_code = 0;
 
-	timings_start_section(&timings, str_lit("llvm ir opt tree"));
-	ir_opt_tree(&ir_gen);
+	if (use_build_cache) {
+		// NOTE: Nothing has changed since the last build, so only link its object file again
+		ir_gen_output_paths(parser.init_fullpath, &output_name, &output_base);
+		foreign_library_paths = build_cache.foreign_library_paths;
+		if (build_context.ODIN_DEBUG) {
+			generate_debug_info = build_context.ODIN_OS == "windows" && build_context.word_size == 8;
+		}
+	} else {
+		irGen ir_gen = {0};
+		if (!ir_gen_init(&ir_gen, &checker)) {
+			return 1;
+		}
+		// defer (ir_gen_destroy(&ir_gen));
 
-	timings_start_section(&timings, str_lit("llvm ir print"));
-	print_llvm_ir(&ir_gen);
 
+		timings_start_section(&timings, str_lit("llvm ir gen"));
+		ir_gen_tree(&ir_gen);
 
-	String output_name = ir_gen.output_name;
-	String output_base = ir_gen.output_base;
+		timings_start_section(&timings, str_lit("llvm ir opt tree"));
+		ir_opt_tree(&ir_gen);
 
-	build_context.optimization_level = gb_clamp(build_context.optimization_level, 0, 3);
+		if (build_context.llvm_api) {
+			// NOTE: Each codegen unit is optimized and emitted as soon as it has been printed
+			timings_start_section(&timings, str_lit("llvm ir print & llvm api"));
+		} else {
+			timings_start_section(&timings, str_lit("llvm ir print"));
+		}
+		if (build_context.incremental) {
+			build_cache_begin_codegen(&build_cache);
+		}
+		if (!print_llvm_ir(&ir_gen)) {
+			return 1;
+		}
+		if (global_timings_trace != nullptr) {
+			timings_trace_add_counter(global_timings_trace, "llvm_ir_bytes", ir_gen.byte_count);
+		}
 
-	i32 exit_code = 0;
 
-	timings_start_section(&timings, str_lit("llvm-opt"));
-	exit_code = exec_llvm_opt(output_base);
-	if (exit_code != 0) {
-		return exit_code;
-	}
+		output_name = ir_gen.output_name;
+		output_base = ir_gen.output_base;
+		foreign_library_paths = ir_gen.module.foreign_library_paths;
+		generate_debug_info = ir_gen.module.generate_debug_info;
 
-	timings_start_section(&timings, str_lit("llvm-llc"));
-	exit_code = exec_llvm_llc(output_base);
-	if (exit_code != 0) {
-		return exit_code;
+		if (build_context.llvm_api) {
+			// NOTE: Already done by 'print_llvm_ir'
+		} else if (build_context.codegen_units > 1) {
+			timings_start_section(&timings, str_lit("llvm-opt & llc"));
+			exit_code = exec_llvm_codegen_units(output_base);
+			if (exit_code != 0) {
+				return exit_code;
+			}
+		} else if (build_cache_object_is_reused(global_build_cache, 0)) {
+			// NOTE: The LLVM IR is the same as that of the previous build
+		} else {
+			timings_start_section(&timings, str_lit("llvm-opt"));
+			exit_code = exec_llvm_opt(output_base);
+			if (exit_code != 0) {
+				return exit_code;
+			}
+
+			timings_start_section(&timings, str_lit("llvm-llc"));
+			exit_code = exec_llvm_llc(output_base);
+			if (exit_code != 0) {
+				return exit_code;
+			}
+		}
+
+		if (build_context.incremental) {
+			build_cache_save(&build_cache, foreign_library_paths);
+		}
 	}
 
 	#if defined(GB_SYSTEM_WINDOWS)
@@ -912,14 +1182,17 @@ int main(int arg_count, char **arg_ptr) {
 		defer (gb_string_free(lib_str));
 		char lib_str_buf[1024] = {0};
 
-		for_array(i, ir_gen.module.foreign_library_paths) {
-			String lib = ir_gen.module.foreign_library_paths[i];
+		for_array(i, foreign_library_paths) {
+			String lib = foreign_library_paths[i];
 			GB_ASSERT(lib.len < gb_count_of(lib_str_buf)-1);
 			isize len = gb_snprintf(lib_str_buf, gb_size_of(lib_str_buf),
 			                        " \"%.*s\"", LIT(lib));
 			lib_str = gb_string_appendc(lib_str, lib_str_buf);
 		}
 
+		gbString object_files = codegen_unit_object_files(output_base, ".obj");
+		defer (gb_string_free(object_files));
+
 		char *output_ext = "exe";
 		gbString link_settings = gb_string_make_reserve(heap_allocator(), 256);
 		defer (gb_string_free(link_settings));
@@ -936,7 +1209,7 @@ int main(int arg_count, char **arg_ptr) {
 			link_settings = gb_string_append_fmt(link_settings, " /defaultlib:libcmt");
 		}
 
-		if (ir_gen.module.generate_debug_info) {
+		if (generate_debug_info) {
 			link_settings = gb_string_append_fmt(link_settings, " /DEBUG");
 		}
 		if (!build_context.use_lld) { // msvc
@@ -952,36 +1225,36 @@ int main(int arg_count, char **arg_ptr) {
 				}
 
 				exit_code = system_exec_command_line_app("msvc-link", true,
-					"link \"%.*s.obj\" \"%.*s.res\" -OUT:\"%.*s.%s\" %s "
+					"link %s \"%.*s.res\" -OUT:\"%.*s.%s\" %s "
 					"/nologo /incremental:no /opt:ref /subsystem:CONSOLE "
 					" %.*s "
 					" %s "
 					"",
-					LIT(output_base), LIT(output_base), LIT(output_base), output_ext,
+					object_files, LIT(output_base), LIT(output_base), output_ext,
 					lib_str, LIT(build_context.link_flags),
 					link_settings
 				);
 			} else {
 				exit_code = system_exec_command_line_app("msvc-link", true,
-					"link \"%.*s.obj\" -OUT:\"%.*s.%s\" %s "
+					"link %s -OUT:\"%.*s.%s\" %s "
 					"/nologo /incremental:no /opt:ref /subsystem:CONSOLE "
 					" %.*s "
 					" %s "
 					"",
-					LIT(output_base), LIT(output_base), output_ext,
+					object_files, LIT(output_base), output_ext,
 					lib_str, LIT(build_context.link_flags),
 					link_settings
 				);
 			}
 		} else { // lld
 			exit_code = system_exec_command_line_app("msvc-link", true,
-				"\"%.*s\\bin\\lld-link\" \"%.*s.obj\" -OUT:\"%.*s.%s\" %s "
+				"\"%.*s\\bin\\lld-link\" %s -OUT:\"%.*s.%s\" %s "
 				"/nologo /incremental:no /opt:ref /subsystem:CONSOLE "
 				" %.*s "
 				" %s "
 				"",
 				LIT(build_context.ODIN_ROOT),
-				LIT(output_base), LIT(output_base), output_ext,
+				object_files, LIT(output_base), output_ext,
 				lib_str, LIT(build_context.link_flags),
 				link_settings
 			);
@@ -992,7 +1265,7 @@ int main(int arg_count, char **arg_ptr) {
 		}
 
 		if (build_context.show_timings) {
-			show_timings(&checker, &timings);
+			show_timings(&parser, &checker.info, &timings);
 		}
 
 		remove_temp_files(output_base);
@@ -1013,8 +1286,8 @@ int main(int arg_count, char **arg_ptr) {
 		gbString lib_str = gb_string_make(heap_allocator(), "-L/");
 		defer (gb_string_free(lib_str));
 
-		for_array(i, ir_gen.module.foreign_library_paths) {
-			String lib = ir_gen.module.foreign_library_paths[i];
+		for_array(i, foreign_library_paths) {
+			String lib = foreign_library_paths[i];
 
 			// NOTE(zangent): Sometimes, you have to use -framework on MacOS.
 			//   This allows you to specify '-f' in a #foreign_system_library,
@@ -1095,8 +1368,11 @@ int main(int arg_count, char **arg_ptr) {
 			}
 		#endif
 
+		gbString object_files = codegen_unit_object_files(output_base, ".o");
+		defer (gb_string_free(object_files));
+
 		exit_code = system_exec_command_line_app("ld-link", true,
-			"%s \"%.*s.o\" -o \"%.*s%.*s\" %s "
+			"%s %s -o \"%.*s%.*s\" %s "
 			" %s "
 			" %.*s "
 			" %s "
@@ -1109,7 +1385,7 @@ int main(int arg_count, char **arg_ptr) {
 				// This points the linker to where the entry point is
 				" -e _main "
 			#endif
-			, linker, LIT(output_base), LIT(output_base), LIT(output_ext),
+			, linker, object_files, LIT(output_base), LIT(output_ext),
 			lib_str,
 			str_eq_ignore_case(cross_compile_target, str_lit("Essence")) ? "-lfreetype -lglue" : "-lc -lm",
 			LIT(build_context.link_flags),
@@ -1136,7 +1412,7 @@ int main(int arg_count, char **arg_ptr) {
 
 
 		if (build_context.show_timings) {
-			show_timings(&checker, &timings);
+			show_timings(&parser, &checker.info, &timings);
 		}
 
 		remove_temp_files(output_base);
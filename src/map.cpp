@@ -46,8 +46,13 @@ gb_inline HashKey hashing_proc(void const *data, isize len) {
 }
 
 gb_inline HashKey hash_string(String s) {
-	HashKey h = hashing_proc(s.text, s.len);
-	h.kind = HashKey_String;
+	HashKey h = {HashKey_String};
+	InternedStringHeader *header = string_interned_header(s);
+	if (header != nullptr) {
+		h.key = header->hash;
+	} else {
+		h.key = gb_fnv64a(s.text, s.len);
+	}
 	h.string = s;
 	return h;
 }
@@ -81,6 +86,11 @@ bool hash_key_equal(HashKey a, HashKey b) {
 		// NOTE(bill): If two string's hashes collide, compare the strings themselves
 		if (a.kind == HashKey_String) {
 			if (b.kind == HashKey_String) {
+				if (a.string.text != b.string.text &&
+				    string_is_interned(a.string) && string_is_interned(b.string)) {
+					// NOTE: Distinct interned strings are never equal
+					return false;
+				}
 				return a.string == b.string;
 			}
 			return false;
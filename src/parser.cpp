@@ -110,7 +110,8 @@ Ast *clone_ast(Ast *node) {
 	if (node == nullptr) {
 		return nullptr;
 	}
-	Ast *n = alloc_ast_node(node->file, node->kind);
+	// NOTE: 'node->file' is copied across, only the parser counts the nodes of a file
+	Ast *n = alloc_ast_node(nullptr, node->kind);
 	gb_memmove(n, node, gb_size_of(Ast));
 
 	switch (n->kind) {
@@ -422,6 +423,9 @@ Ast *alloc_ast_node(AstFile *f, AstKind kind) {
 	Ast *node = gb_alloc_item(a, Ast);
 	node->kind = kind;
 	node->file = f;
+	if (f != nullptr) {
+		f->node_count += 1;
+	}
 	return node;
 }
 
@@ -1013,9 +1017,31 @@ Ast *ast_attribute(AstFile *f, Token token, Token open, Token close, Array<Ast *
 }
 
 
+Token read_token(AstFile *f) {
+	Token token = tokenizer_get_token(&f->tokenizer);
+	if (token.kind == Token_Invalid && f->invalid_token_pos.line == 0) {
+		f->invalid_token_pos = token.pos;
+	}
+	f->token_count += 1;
+	return token;
+}
+
+// NOTE: Returns the nth token after the current one without consuming it
+Token peek_token(AstFile *f, isize n = 0) {
+	GB_ASSERT(0 <= n && n < AST_FILE_TOKEN_RING_SIZE);
+	while (f->token_ring_count <= n) {
+		isize index = (f->token_ring_head + f->token_ring_count) & (AST_FILE_TOKEN_RING_SIZE-1);
+		f->token_ring[index] = read_token(f);
+		f->token_ring_count += 1;
+	}
+	return f->token_ring[(f->token_ring_head + n) & (AST_FILE_TOKEN_RING_SIZE-1)];
+}
+
 bool next_token0(AstFile *f) {
-	if (f->curr_token_index+1 < f->tokens.count) {
-		f->curr_token = f->tokens[++f->curr_token_index];
+	if (f->curr_token.kind != Token_EOF) {
+		f->curr_token = peek_token(f, 0);
+		f->token_ring_head = (f->token_ring_head + 1) & (AST_FILE_TOKEN_RING_SIZE-1);
+		f->token_ring_count -= 1;
 		return true;
 	}
 	syntax_error(f->curr_token, "Token is EOF");
@@ -1360,6 +1386,28 @@ Ast *parse_ident(AstFile *f, bool allow_poly_names=false) {
 	return ast_ident(f, token);
 }
 
+gb_global u8 directive_hash_table[NAME_HASH_TABLE_SIZE] = {}; // NOTE: DirectiveKind
+
+void init_directive_hash_table(void) {
+	for (i32 d = Directive_Invalid+1; d < Directive_COUNT; d++) {
+		u32 index = name_hash_index(directive_strings[d]);
+		GB_ASSERT_MSG(directive_hash_table[index] == Directive_Invalid,
+		              "Directive hash collision between '%.*s' and '%.*s'",
+		              LIT(directive_strings[d]), LIT(directive_strings[directive_hash_table[index]]));
+		directive_hash_table[index] = cast(u8)d;
+	}
+}
+
+DirectiveKind directive_kind(String const &name) {
+	if (name.len > 0) {
+		DirectiveKind d = cast(DirectiveKind)directive_hash_table[name_hash_index(name)];
+		if (d != Directive_Invalid && directive_strings[d] == name) {
+			return d;
+		}
+	}
+	return Directive_Invalid;
+}
+
 Ast *parse_tag_expr(AstFile *f, Ast *expression) {
 	Token token = expect_token(f, Token_Hash);
 	Token name = expect_token(f, Token_Ident);
@@ -1500,9 +1548,10 @@ void parse_proc_tags(AstFile *f, u64 *tags) {
 		Ast *tag_expr = parse_tag_expr(f, nullptr);
 		ast_node(te, TagExpr, tag_expr);
 		String tag_name = te->name.string;
+		DirectiveKind tag_kind = directive_kind(tag_name);
 
 		#define ELSE_IF_ADD_TAG(name) \
-		else if (tag_name == #name) { \
+		else if (tag_kind == Directive_##name) { \
 			check_proc_add_tag(f, tag_expr, tags, ProcTag_##name, tag_name); \
 		}
 
@@ -1544,8 +1593,8 @@ Ast *convert_stmt_to_expr(AstFile *f, Ast *statement, String kind) {
 
 	syntax_error(f->curr_token, "Expected '%.*s', found a simple statement.", LIT(kind));
 	Token end = f->curr_token;
-	if (f->tokens.count < f->curr_token_index) {
-		end = f->tokens[f->curr_token_index+1];
+	if (end.kind != Token_EOF) {
+		end = peek_token(f);
 	}
 	return ast_bad_expr(f, f->curr_token, end);
 }
@@ -1648,7 +1697,8 @@ Ast *parse_operand(AstFile *f, bool lhs) {
 	case Token_Hash: {
 		Token token = expect_token(f, Token_Hash);
 		Token name = expect_token(f, Token_Ident);
-		if (name.string == "type") {
+		DirectiveKind d = directive_kind(name.string);
+		if (d == Directive_type) {
 			return ast_helper_type(f, token, parse_type(f));
 		} /* else if (name.string == "no_deferred") {
 			operand = parse_expr(f, false);
@@ -1657,17 +1707,17 @@ Ast *parse_operand(AstFile *f, bool lhs) {
 				operand = ast_bad_expr(f, token, f->curr_token);
 			}
 			operand->stmt_state_flags |= StmtStateFlag_no_deferred;
-		} */ else if (name.string == "file") { return ast_basic_directive(f, token, name.string);
-		} else if (name.string == "line") { return ast_basic_directive(f, token, name.string);
-		} else if (name.string == "procedure") { return ast_basic_directive(f, token, name.string);
-		} else if (name.string == "caller_location") { return ast_basic_directive(f, token, name.string);
-		} else if (name.string == "location") {
+		} */ else if (d == Directive_file) { return ast_basic_directive(f, token, name.string);
+		} else if (d == Directive_line) { return ast_basic_directive(f, token, name.string);
+		} else if (d == Directive_procedure) { return ast_basic_directive(f, token, name.string);
+		} else if (d == Directive_caller_location) { return ast_basic_directive(f, token, name.string);
+		} else if (d == Directive_location) {
 			Ast *tag = ast_basic_directive(f, token, name.string);
 			return parse_call_expr(f, tag);
-		} else if (name.string == "assert") {
+		} else if (d == Directive_assert) {
 			Ast *tag = ast_basic_directive(f, token, name.string);
 			return parse_call_expr(f, tag);
-		} else if (name.string == "defined") {
+		} else if (d == Directive_defined) {
 			Ast *tag = ast_basic_directive(f, token, name.string);
 			return parse_call_expr(f, tag);
 		} else {
@@ -1889,17 +1939,18 @@ Ast *parse_operand(AstFile *f, bool lhs) {
 
 		while (allow_token(f, Token_Hash)) {
 			Token tag = expect_token_after(f, Token_Ident, "#");
-			if (tag.string == "packed") {
+			DirectiveKind d = directive_kind(tag.string);
+			if (d == Directive_packed) {
 				if (is_packed) {
 					syntax_error(tag, "Duplicate struct tag '#%.*s'", LIT(tag.string));
 				}
 				is_packed = true;
-			} else if (tag.string == "align") {
+			} else if (d == Directive_align) {
 				if (align) {
 					syntax_error(tag, "Duplicate struct tag '#%.*s'", LIT(tag.string));
 				}
 				align = parse_expr(f, true);
-			} else if (tag.string == "raw_union") {
+			} else if (d == Directive_raw_union) {
 				if (is_raw_union) {
 					syntax_error(tag, "Duplicate struct tag '#%.*s'", LIT(tag.string));
 				}
@@ -1953,7 +2004,7 @@ Ast *parse_operand(AstFile *f, bool lhs) {
 
 		while (allow_token(f, Token_Hash)) {
 			Token tag = expect_token_after(f, Token_Ident, "#");
-			 if (tag.string == "align") {
+			 if (directive_kind(tag.string) == Directive_align) {
 				if (align) {
 					syntax_error(tag, "Duplicate union tag '#%.*s'", LIT(tag.string));
 				}
@@ -2006,7 +2057,7 @@ Ast *parse_operand(AstFile *f, bool lhs) {
 
 		while (allow_token(f, Token_Hash)) {
 			Token tag = expect_token_after(f, Token_Ident, "#");
-			if (tag.string == "align") {
+			if (directive_kind(tag.string) == Directive_align) {
 				if (align) {
 					syntax_error(tag, "Duplicate bit_field tag '#%.*s'", LIT(tag.string));
 				}
@@ -2813,10 +2864,9 @@ FieldPrefixKind is_token_field_prefix(AstFile *f) {
 		advance_token(f);
 		switch (f->curr_token.kind) {
 		case Token_Ident:
-			if (f->curr_token.string == "no_alias") {
-				return FieldPrefix_no_alias;
-			} else if (f->curr_token.string == "c_vararg") {
-				return FieldPrefix_c_var_arg;
+			switch (directive_kind(f->curr_token.string)) {
+			case Directive_no_alias: return FieldPrefix_no_alias;
+			case Directive_c_vararg: return FieldPrefix_c_var_arg;
 			}
 			break;
 		}
@@ -3254,7 +3304,7 @@ Ast *parse_if_stmt(AstFile *f) {
 		} break;
 		default:
 			syntax_error(f->curr_token, "Expected if statement block statement");
-			else_stmt = ast_bad_stmt(f, f->curr_token, f->tokens[f->curr_token_index+1]);
+			else_stmt = ast_bad_stmt(f, f->curr_token, peek_token(f));
 			break;
 		}
 	}
@@ -3299,7 +3349,7 @@ Ast *parse_when_stmt(AstFile *f) {
 		} break;
 		default:
 			syntax_error(f->curr_token, "Expected when statement block statement");
-			else_stmt = ast_bad_stmt(f, f->curr_token, f->tokens[f->curr_token_index+1]);
+			else_stmt = ast_bad_stmt(f, f->curr_token, peek_token(f));
 			break;
 		}
 	}
@@ -3825,22 +3875,23 @@ Ast *parse_stmt(AstFile *f) {
 		Token hash_token = expect_token(f, Token_Hash);
 		Token name = expect_token(f, Token_Ident);
 		String tag = name.string;
+		DirectiveKind d = directive_kind(tag);
 
-		if (tag == "bounds_check") {
+		if (d == Directive_bounds_check) {
 			s = parse_stmt(f);
 			s->stmt_state_flags |= StmtStateFlag_bounds_check;
 			if ((s->stmt_state_flags & StmtStateFlag_no_bounds_check) != 0) {
 				syntax_error(token, "#bounds_check and #no_bounds_check cannot be applied together");
 			}
 			return s;
-		} else if (tag == "no_bounds_check") {
+		} else if (d == Directive_no_bounds_check) {
 			s = parse_stmt(f);
 			s->stmt_state_flags |= StmtStateFlag_no_bounds_check;
 			if ((s->stmt_state_flags & StmtStateFlag_bounds_check) != 0) {
 				syntax_error(token, "#bounds_check and #no_bounds_check cannot be applied together");
 			}
 			return s;
-		} else if (tag == "complete") {
+		} else if (d == Directive_complete) {
 			s = parse_stmt(f);
 			switch (s->kind) {
 			case Ast_SwitchStmt:
@@ -3854,7 +3905,7 @@ Ast *parse_stmt(AstFile *f) {
 				break;
 			}
 			return s;
-		} else if (tag == "assert") {
+		} else if (d == Directive_assert) {
 			Ast *t = ast_basic_directive(f, hash_token, tag);
 			return ast_expr_stmt(f, parse_call_expr(f, t));
 		} /* else if (name.string == "no_deferred") {
@@ -3862,7 +3913,7 @@ Ast *parse_stmt(AstFile *f) {
 			s->stmt_state_flags |= StmtStateFlag_no_deferred;
 		} */
 
-		if (tag == "include") {
+		if (d == Directive_include) {
 			syntax_error(token, "#include is not a valid import declaration kind. Did you mean 'import'?");
 			s = ast_bad_stmt(f, token, f->curr_token);
 		} else {
@@ -3910,7 +3961,7 @@ Array<Ast *> parse_stmt_list(AstFile *f) {
 }
 
 
-ParseFileError init_ast_file(AstFile *f, String fullpath, TokenPos *err_pos) {
+ParseFileError init_ast_file(AstFile *f, String fullpath) {
 	GB_ASSERT(f != nullptr);
 	f->fullpath = string_trim_whitespace(fullpath); // Just in case
 	if (!string_ends_with(f->fullpath, str_lit(".odin"))) {
@@ -3931,36 +3982,8 @@ ParseFileError init_ast_file(AstFile *f, String fullpath, TokenPos *err_pos) {
 
 	}
 
-	isize file_size = f->tokenizer.end - f->tokenizer.start;
-	isize init_token_cap = cast(isize)gb_max(next_pow2(cast(i64)(file_size/2ll)), 16);
-	array_init(&f->tokens, heap_allocator(), 0, gb_max(init_token_cap, 16));
-
-	if (err == TokenizerInit_Empty) {
-		Token token = {Token_EOF};
-		token.pos.file   = fullpath;
-		token.pos.line   = 1;
-		token.pos.column = 1;
-		array_add(&f->tokens, token);
-		return ParseFile_None;
-	}
-
-	while (f->curr_token.kind != Token_EOF) {
-		Token token = tokenizer_get_token(&f->tokenizer);
-		if (token.kind == Token_Invalid) {
-			err_pos->line   = token.pos.line;
-			err_pos->column = token.pos.column;
-			return ParseFile_InvalidToken;
-		}
-		array_add(&f->tokens, token);
-
-		if (token.kind == Token_EOF) {
-			break;
-		}
-	}
-
-	f->curr_token_index = 0;
-	f->prev_token = f->tokens[f->curr_token_index];
-	f->curr_token = f->tokens[f->curr_token_index];
+	f->curr_token = read_token(f);
+	f->prev_token = f->curr_token;
 
 	array_init(&f->comments, heap_allocator());
 	array_init(&f->imports, heap_allocator());
@@ -3972,7 +3995,6 @@ ParseFileError init_ast_file(AstFile *f, String fullpath, TokenPos *err_pos) {
 
 void destroy_ast_file(AstFile *f) {
 	GB_ASSERT(f != nullptr);
-	array_free(&f->tokens);
 	array_free(&f->comments);
 	array_free(&f->imports);
 	gb_free(heap_allocator(), f->tokenizer.fullpath.text);
@@ -4035,9 +4057,15 @@ void parser_add_package(Parser *p, AstPackage *pkg) {
 	}
 }
 
+void parser_add_worker_task(Parser *p, ImportedFile const &f);
+
+// NOTE: Must be called with 'file_add_mutex' held
 void parser_add_file_to_process(Parser *p, AstPackage *pkg, FileInfo fi, TokenPos pos) {
 	ImportedFile f = {pkg, fi, pos, p->files_to_process.count};
 	array_add(&p->files_to_process, f);
+	if (p->thread_pool != nullptr) {
+		parser_add_worker_task(p, f);
+	}
 }
 
 
@@ -4067,7 +4095,7 @@ bool try_add_import_path(Parser *p, String const &path, String const &rel_path,
 	if (kind == Package_Init && string_ends_with(path, FILE_EXT)) {
 		FileInfo fi = {};
 		fi.name = filename_from_path(path);
-		fi.fullpath = path;
+		fi.fullpath = copy_string(heap_allocator(), path); // NOTE: Owned by the AstFile, 'path' is interned
 		fi.size = get_file_size(path);
 		fi.is_dir = false;
 
@@ -4110,7 +4138,7 @@ bool try_add_import_path(Parser *p, String const &path, String const &rel_path,
 	for_array(list_index, list) {
 		FileInfo fi = list[list_index];
 		String name = fi.name;
-		if (string_ends_with(name, FILE_EXT)) {
+		if (!fi.is_dir && string_ends_with(name, FILE_EXT)) {
 			if (is_excluded_target_filename(name)) {
 				continue;
 			}
@@ -4310,7 +4338,7 @@ void parse_setup_file_decls(Parser *p, AstFile *f, String base_dir, Array<Ast *>
 				decls[i] = ast_bad_decl(f, id->relpath, id->relpath);
 				continue;
 			}
-			import_path = string_trim_whitespace(import_path);
+			import_path = string_intern(string_trim_whitespace(import_path));
 
 			id->fullpath = import_path;
 			if (is_package_name_reserved(import_path)) {
@@ -4428,15 +4456,7 @@ bool parse_build_tag(Token token_for_pos, String s) {
 	return true;
 }
 
-bool parse_file(Parser *p, AstFile *f) {
-	if (f->tokens.count == 0) {
-		return true;
-	}
-	if (f->tokens.count > 0 && f->tokens[0].kind == Token_EOF) {
-		return true;
-	}
-
-	String filepath = f->tokenizer.fullpath;
+String get_file_base_dir(String filepath) {
 	String base_dir = filepath;
 	for (isize i = filepath.len-1; i >= 0; i--) {
 		if (base_dir[i] == '\\' ||
@@ -4445,6 +4465,15 @@ bool parse_file(Parser *p, AstFile *f) {
 		}
 		base_dir.len--;
 	}
+	return base_dir;
+}
+
+bool parse_file(Parser *p, AstFile *f) {
+	if (f->curr_token.kind == Token_EOF) {
+		return true;
+	}
+
+	String base_dir = get_file_base_dir(f->tokenizer.fullpath);
 
 	comsume_comment_groups(f, f->prev_token);
 
@@ -4511,18 +4540,24 @@ bool parse_file(Parser *p, AstFile *f) {
 }
 
 
+// NOTE: See ast_cache.cpp
+bool ast_cache_use_for_file(AstFile *f);
+i64  ast_cache_diagnostic_count(void);
+bool ast_cache_load_file(Parser *p, AstFile *f);
+bool ast_cache_save_file(AstFile *f, i64 prev_diagnostic_count);
+
 ParseFileError process_imported_file(Parser *p, ImportedFile imported_file) {
 	AstPackage *pkg = imported_file.pkg;
 	FileInfo *fi = &imported_file.fi;
 	TokenPos pos = imported_file.pos;
+	TIMINGS_TRACE_SCOPE("parse file", fi->fullpath);
 
 	AstFile *file = gb_alloc_item(heap_allocator(), AstFile);
 	file->pkg = pkg;
 
 	file->id = imported_file.index+1;
 
-	TokenPos err_pos = {0};
-	ParseFileError err = init_ast_file(file, fi->fullpath, &err_pos);
+	ParseFileError err = init_ast_file(file, fi->fullpath);
 
 	if (err != ParseFile_None) {
 		if (err == ParseFile_EmptyFile) {
@@ -4546,9 +4581,6 @@ ParseFileError process_imported_file(Parser *p, ImportedFile imported_file) {
 		case ParseFile_NotFound:
 			error(pos, "Failed to parse file: %.*s; file cannot be found ('%.*s')", LIT(fi->name), LIT(fi->fullpath));
 			break;
-		case ParseFile_InvalidToken:
-			error(pos, "Failed to parse file: %.*s; invalid token found in file at (%td:%td)", LIT(fi->name), err_pos.line, err_pos.column);
-			break;
 		case ParseFile_EmptyFile:
 			error(pos, "Failed to parse file: %.*s; file contains no tokens", LIT(fi->name));
 			break;
@@ -4559,41 +4591,135 @@ ParseFileError process_imported_file(Parser *p, ImportedFile imported_file) {
 
 
 skip:
-	if (parse_file(p, file)) {
+	bool use_ast_cache = ast_cache_use_for_file(file);
+	bool parsed = false;
+	bool saved  = false;
+	if (use_ast_cache && ast_cache_load_file(p, file)) {
+		parsed = true;
+	} else {
+		i64 prev_diagnostic_count = use_ast_cache ? ast_cache_diagnostic_count() : 0;
+		parsed = parse_file(p, file);
+		if (file->invalid_token_pos.line != 0) {
+			// NOTE: Tokens are only read whilst parsing, so this is found afterwards
+			TokenPos err_pos = file->invalid_token_pos;
+			error(pos, "Failed to parse file: %.*s; invalid token found in file at (%td:%td)", LIT(fi->name), err_pos.line, err_pos.column);
+			return ParseFile_InvalidToken;
+		}
+		if (use_ast_cache && parsed) {
+			saved = ast_cache_save_file(file, prev_diagnostic_count);
+		}
+	}
+	if (parsed) {
 		gb_mutex_lock(&p->file_add_mutex);
 		defer (gb_mutex_unlock(&p->file_add_mutex));
 
 		array_add(&file->pkg->files, file);
 
+		p->ast_cache_load_count += file->is_cached;
+		p->ast_cache_save_count += saved;
+
 		if (pkg->name.len == 0) {
 			pkg->name = file->package_name;
-		} else if (file->tokens.count > 0 && pkg->name != file->package_name) {
+		} else if (file->token_count > 0 && pkg->name != file->package_name) {
 			error(file->package_token, "Different package name, expected '%.*s', got '%.*s'", LIT(pkg->name), LIT(file->package_name));
 		}
 
 		p->total_line_count += file->tokenizer.line_count;
-		p->total_token_count += file->tokens.count;
+		p->total_token_count += file->token_count;
+		p->total_node_count  += file->node_count;
 	}
 	return ParseFile_None;
 }
 
 
-GB_THREAD_PROC(parse_worker_file_proc) {
-	if (thread == nullptr) return 0;
-	auto *p = cast(Parser *)thread->user_data;
-	isize index = thread->user_index;
-	gb_mutex_lock(&p->file_add_mutex);
-	auto file_to_process = p->files_to_process[index];
-	gb_mutex_unlock(&p->file_add_mutex);
-	ParseFileError err = process_imported_file(p, file_to_process);
+struct ParserWorkerData {
+	Parser *     parser;
+	ImportedFile imported_file;
+};
+
+WORKER_TASK_PROC(parser_worker_proc) {
+	ParserWorkerData *wd = cast(ParserWorkerData *)data;
+	Parser *p = wd->parser;
+	ParseFileError err = process_imported_file(p, wd->imported_file);
+	if (err != ParseFile_None) {
+		gb_mutex_lock(&p->file_add_mutex);
+		if (p->worker_error == ParseFile_None) {
+			p->worker_error = err;
+		}
+		gb_mutex_unlock(&p->file_add_mutex);
+	}
+	gb_free(heap_allocator(), wd);
 	return cast(isize)err;
 }
 
+void parser_add_worker_task(Parser *p, ImportedFile const &f) {
+	GB_ASSERT(p->thread_pool != nullptr);
+	ParserWorkerData *wd = gb_alloc_item(heap_allocator(), ParserWorkerData);
+	wd->parser = p;
+	wd->imported_file = f;
+	thread_pool_add_task(p->thread_pool, parser_worker_proc, wd);
+}
+
+GB_COMPARE_PROC(ast_file_id_cmp) {
+	AstFile *x = *cast(AstFile **)a;
+	AstFile *y = *cast(AstFile **)b;
+	return x->id < y->id ? -1 : x->id > y->id;
+}
+
+// NOTE: With more than one thread, the files of a package and the packages themselves are added
+// in whichever order they finish parsing. Put them back in the order a single thread finds them:
+// the files of a package in directory order, and each package after the first file to import it.
+void parser_sort_packages(Parser *p) {
+	Map<AstPackage *> path_map = {}; // Key: String (package fullpath)
+	map_init(&path_map, heap_allocator(), 2*p->packages.count);
+	defer (map_destroy(&path_map));
+
+	auto packages = array_make<AstPackage *>(heap_allocator(), 0, p->packages.count);
+	for_array(i, p->packages) {
+		AstPackage *pkg = p->packages[i];
+		gb_sort_array(pkg->files.data, pkg->files.count, ast_file_id_cmp);
+		if (pkg->kind == Package_Runtime || pkg->kind == Package_Init) {
+			// NOTE: These are added before any file is parsed
+			array_add(&packages, pkg);
+			map_set(&path_map, hash_string(pkg->fullpath), cast(AstPackage *)nullptr);
+		} else {
+			map_set(&path_map, hash_string(pkg->fullpath), pkg);
+		}
+	}
+
+	isize file_id = 0;
+	for (isize i = 0; i < packages.count; i++) {
+		AstPackage *pkg = packages[i];
+		for_array(j, pkg->files) {
+			AstFile *f = pkg->files[j];
+			f->id = ++file_id;
+			for_array(k, f->imports) {
+				Ast *node = f->imports[k];
+				if (node->kind != Ast_ImportDecl) {
+					continue;
+				}
+				AstPackage **found = map_get(&path_map, hash_string(node->ImportDecl.fullpath));
+				if (found != nullptr && *found != nullptr) {
+					array_add(&packages, *found);
+					*found = nullptr;
+				}
+			}
+		}
+	}
+	GB_ASSERT(packages.count == p->packages.count);
+
+	for_array(i, packages) {
+		packages[i]->id = i+1;
+	}
+	array_free(&p->packages);
+	p->packages = packages;
+}
+
 ParseFileError parse_packages(Parser *p, String init_filename) {
 	GB_ASSERT(init_filename.text[init_filename.len] == 0);
 
 	char *fullpath_str = gb_path_get_full_name(heap_allocator(), cast(char const *)&init_filename[0]);
-	String init_fullpath = string_trim_whitespace(make_string_c(fullpath_str));
+	String init_fullpath = string_intern(string_trim_whitespace(make_string_c(fullpath_str)));
 	if (!path_is_directory(init_fullpath)) {
 		String const ext = str_lit(".odin");
 		if (!string_ends_with(init_fullpath, ext)) {
@@ -4605,17 +4731,15 @@ ParseFileError parse_packages(Parser *p, String init_filename) {
 
 	TokenPos init_pos = {};
 	if (!build_context.generate_docs) {
-		String s = get_fullpath_core(heap_allocator(), str_lit("runtime"));
+		String s = string_intern(get_fullpath_core(heap_allocator(), str_lit("runtime")));
 		try_add_import_path(p, s, s, init_pos, Package_Runtime);
 	}
 
 	try_add_import_path(p, init_fullpath, init_fullpath, init_pos, Package_Init);
 	p->init_fullpath = init_fullpath;
 
-#if 1
 	isize thread_count = gb_max(build_context.thread_count, 1);
 	if (thread_count > 1) {
-		isize volatile curr_import_index = 0;
 		isize initial_file_count = p->files_to_process.count;
 		// NOTE(bill): Make sure that these are in parsed in this order
 		for (isize i = 0; i < initial_file_count; i++) {
@@ -4623,48 +4747,32 @@ ParseFileError parse_packages(Parser *p, String init_filename) {
 			if (err != ParseFile_None) {
 				return err;
 			}
-			curr_import_index++;
 		}
 
-		auto worker_threads = array_make<gbThread>(heap_allocator(), thread_count);
-		defer (array_free(&worker_threads));
+		ThreadPool thread_pool = {};
+		thread_pool_init(&thread_pool, heap_allocator(), thread_count);
 
-		for_array(i, worker_threads) {
-			gbThread *t = &worker_threads[i];
-			gb_thread_init(t);
+		// NOTE: Any import found from now on is pushed straight into the pool
+		// by 'parser_add_file_to_process'
+		gb_mutex_lock(&p->file_add_mutex);
+		p->thread_pool = &thread_pool;
+		for (isize i = initial_file_count; i < p->files_to_process.count; i++) {
+			parser_add_worker_task(p, p->files_to_process[i]);
 		}
-		defer (for_array(i, worker_threads) {
-			gb_thread_destroy(&worker_threads[i]);
-		});
+		gb_mutex_unlock(&p->file_add_mutex);
 
-		auto errors = array_make<ParseFileError>(heap_allocator(), 0, 16);
+		thread_pool_wait_to_process(&thread_pool);
 
-		for (;;) {
-			bool are_any_alive = false;
-			for_array(i, worker_threads) {
-				gbThread *t = &worker_threads[i];
-				if (gb_thread_is_running(t)) {
-					are_any_alive = true;
-				} else if (curr_import_index < p->files_to_process.count) {
-					auto curr_err = cast(ParseFileError)t->return_value;
-					if (curr_err != ParseFile_None) {
-						array_add(&errors, curr_err);
-					} else {
-						t->user_index = curr_import_index;
-						curr_import_index++;
-						gb_thread_start(t, parse_worker_file_proc, p);
-						are_any_alive = true;
-					}
-				}
-			}
-			if (!are_any_alive && curr_import_index >= p->files_to_process.count) {
-				break;
-			}
-		}
+		gb_mutex_lock(&p->file_add_mutex);
+		p->thread_pool = nullptr;
+		gb_mutex_unlock(&p->file_add_mutex);
+
+		thread_pool_destroy(&thread_pool);
 
-		if (errors.count > 0) {
-			return errors[errors.count-1];
+		if (p->worker_error != ParseFile_None) {
+			return p->worker_error;
 		}
+		parser_sort_packages(p);
 	} else {
 		for_array(i, p->files_to_process) {
 			ParseFileError err = process_imported_file(p, p->files_to_process[i]);
@@ -4673,15 +4781,6 @@ ParseFileError parse_packages(Parser *p, String init_filename) {
 			}
 		}
 	}
-#else
-	for_array(i, p->files_to_process) {
-		ImportedFile f = p->files_to_process[i];
-		ParseFileError err = process_imported_file(p, f);
-		if (err != ParseFile_None) {
-			return err;
-		}
-	}
-#endif
 
 	return ParseFile_None;
 }
@@ -78,8 +78,16 @@ struct AstFile {
 	Ast *        pkg_decl;
 	String       fullpath;
 	Tokenizer    tokenizer;
-	Array<Token> tokens;
-	isize        curr_token_index;
+
+	// NOTE: Tokens are pulled from the tokenizer as the parser needs them, this only
+	// holds the ones which have been peeked at but not yet consumed
+#define AST_FILE_TOKEN_RING_SIZE 4 // NOTE: Power of two, larger than the parser's lookahead
+	Token        token_ring[AST_FILE_TOKEN_RING_SIZE];
+	isize        token_ring_head;
+	isize        token_ring_count;
+	isize        token_count;   // NOTE: Tokens read from the tokenizer so far
+	TokenPos     invalid_token_pos; // NOTE: First Token_Invalid, 'line' is 0 if there is none
+
 	Token        curr_token;
 	Token        prev_token; // previous non-comment
 	Token        package_token;
@@ -111,6 +119,9 @@ struct AstFile {
 #define PARSER_MAX_FIX_COUNT 6
 	isize    fix_count;
 	TokenPos fix_prev_pos;
+
+	isize    node_count; // NOTE: Nodes allocated whilst parsing the file
+	bool     is_cached;  // NOTE: Loaded from the AST cache rather than parsed, see ast_cache.cpp
 };
 
 
@@ -137,8 +148,13 @@ struct Parser {
 	Array<ImportedFile>    files_to_process;
 	isize                  total_token_count;
 	isize                  total_line_count;
+	isize                  total_node_count;
+	isize                  ast_cache_load_count;
+	isize                  ast_cache_save_count;
 	gbMutex                file_add_mutex;
 	gbMutex                file_decl_mutex;
+	ThreadPool *           thread_pool; // NOTE: Only set whilst parsing with multiple threads
+	ParseFileError         worker_error;
 };
 
 enum ProcInlining {
@@ -154,6 +170,42 @@ enum ProcTag {
 	ProcTag_no_context      = 1<<6,
 };
 
+// NOTE: Names which may follow a '#' (see 'directive_kind')
+#define DIRECTIVE_KINDS \
+	DIRECTIVE_KIND(type),            \
+	DIRECTIVE_KIND(file),            \
+	DIRECTIVE_KIND(line),            \
+	DIRECTIVE_KIND(procedure),       \
+	DIRECTIVE_KIND(caller_location), \
+	DIRECTIVE_KIND(location),        \
+	DIRECTIVE_KIND(assert),          \
+	DIRECTIVE_KIND(defined),         \
+	DIRECTIVE_KIND(packed),          \
+	DIRECTIVE_KIND(align),           \
+	DIRECTIVE_KIND(raw_union),       \
+	DIRECTIVE_KIND(no_alias),        \
+	DIRECTIVE_KIND(c_vararg),        \
+	DIRECTIVE_KIND(bounds_check),    \
+	DIRECTIVE_KIND(no_bounds_check), \
+	DIRECTIVE_KIND(require_results), \
+	DIRECTIVE_KIND(complete),        \
+	DIRECTIVE_KIND(include),         \
+
+enum DirectiveKind {
+	Directive_Invalid,
+#define DIRECTIVE_KIND(name) Directive_##name
+	DIRECTIVE_KINDS
+#undef DIRECTIVE_KIND
+	Directive_COUNT,
+};
+
+String const directive_strings[] = {
+	{cast(u8 *)"", 0},
+#define DIRECTIVE_KIND(name) {cast(u8 *)#name, gb_size_of(#name)-1}
+	DIRECTIVE_KINDS
+#undef DIRECTIVE_KIND
+};
+
 enum ProcCallingConvention {
 	ProcCC_Invalid = 0,
 	ProcCC_Odin,
@@ -162,6 +162,7 @@ GB_COMPARE_PROC(string_cmp_proc) {
 
 gb_inline bool str_eq(String const &a, String const &b) {
 	if (a.len != b.len) return false;
+	if (a.text == b.text) return true;
 	for (isize i = 0; i < a.len; i++) {
 		if (a.text[i] != b.text[i]) {
 			return false;
@@ -0,0 +1,187 @@
+// A global, thread safe table of interned strings (identifiers and package paths)
+//
+// Every interned string lives in one reserved region of memory directly after a header
+// holding its hash. Whether a String is interned is a range check plus a check that the
+// header refers back to it, which lets 'hash_string' reuse the hash and means two interned
+// strings are equal if and only if their text pointers are equal.
+
+struct InternedStringHeader {
+	u64   hash; // NOTE: Same as 'gb_fnv64a' of the text
+	u8 *  text; // NOTE: Points just past this header
+	isize len;
+};
+
+struct StringInternShard {
+	gbMutex                 mutex;
+	InternedStringHeader ** slots;
+	isize                   slot_count;
+	isize                   count;
+};
+
+#define STRING_INTERN_SHARD_COUNT 64
+
+#if defined(GB_ARCH_64_BIT)
+#define STRING_INTERN_RESERVE_SIZE (256*1024*1024)
+#else
+#define STRING_INTERN_RESERVE_SIZE (32*1024*1024)
+#endif
+#define STRING_INTERN_COMMIT_SIZE (1024*1024)
+
+struct StringInterner {
+	u8 *       base;
+	u8 *       end;
+	gbAtomic64 used;
+	gbMutex    commit_mutex;
+	isize      committed; // NOTE: Only used on Windows, the rest of the region is only reserved
+
+	StringInternShard shards[STRING_INTERN_SHARD_COUNT];
+};
+
+gb_global StringInterner global_string_interner = {};
+
+
+void init_string_interner(void) {
+	StringInterner *si = &global_string_interner;
+	isize size = STRING_INTERN_RESERVE_SIZE;
+#if defined(GB_SYSTEM_WINDOWS)
+	void *base = VirtualAlloc(nullptr, size, MEM_RESERVE, PAGE_READWRITE);
+#else
+	void *base = mmap(nullptr, size, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANON|MAP_NORESERVE, -1, 0);
+	if (base == MAP_FAILED) {
+		base = nullptr;
+	}
+#endif
+	if (base == nullptr) {
+		// NOTE: Interning is only an optimization, 'string_intern' returns its argument
+		return;
+	}
+
+	gb_atomic64_store(&si->used, 0);
+	gb_mutex_init(&si->commit_mutex);
+	si->committed = 0;
+	for (isize i = 0; i < STRING_INTERN_SHARD_COUNT; i++) {
+		StringInternShard *shard = &si->shards[i];
+		gb_mutex_init(&shard->mutex);
+		shard->slot_count = 64;
+		shard->slots = gb_alloc_array(heap_allocator(), InternedStringHeader *, shard->slot_count);
+		shard->count = 0;
+	}
+
+	si->end  = cast(u8 *)base + size;
+	si->base = cast(u8 *)base;
+}
+
+gb_inline InternedStringHeader *string_interned_header(String const &s) {
+	StringInterner *si = &global_string_interner;
+	u8 *text = s.text;
+	if (text < si->base + gb_size_of(InternedStringHeader) || text >= si->end) {
+		return nullptr;
+	}
+	if ((cast(uintptr)text & (gb_align_of(InternedStringHeader)-1)) != 0) {
+		return nullptr;
+	}
+	InternedStringHeader *header = cast(InternedStringHeader *)(text - gb_size_of(InternedStringHeader));
+	if (header->text != text || header->len != s.len) {
+		// NOTE: A substring of an interned string
+		return nullptr;
+	}
+	return header;
+}
+
+gb_inline bool string_is_interned(String const &s) {
+	return string_interned_header(s) != nullptr;
+}
+
+InternedStringHeader *string_intern__alloc(String const &s, u64 hash) {
+	StringInterner *si = &global_string_interner;
+	isize size = gb_size_of(InternedStringHeader) + s.len + 1;
+	size = align_formula_isize(size, gb_align_of(InternedStringHeader));
+
+	isize offset = cast(isize)gb_atomic64_fetch_add(&si->used, size);
+	if (offset + size > si->end - si->base) {
+		return nullptr;
+	}
+
+#if defined(GB_SYSTEM_WINDOWS)
+	gb_mutex_lock(&si->commit_mutex);
+	if (offset + size > si->committed) {
+		isize new_committed = align_formula_isize(offset + size, STRING_INTERN_COMMIT_SIZE);
+		new_committed = gb_min(new_committed, si->end - si->base);
+		if (VirtualAlloc(si->base + si->committed, new_committed - si->committed, MEM_COMMIT, PAGE_READWRITE) == nullptr) {
+			gb_mutex_unlock(&si->commit_mutex);
+			return nullptr;
+		}
+		si->committed = new_committed;
+	}
+	gb_mutex_unlock(&si->commit_mutex);
+#endif
+
+	InternedStringHeader *header = cast(InternedStringHeader *)(si->base + offset);
+	header->hash = hash;
+	header->text = cast(u8 *)(header+1);
+	header->len  = s.len;
+	gb_memmove(header->text, s.text, s.len);
+	header->text[s.len] = 0;
+	return header;
+}
+
+void string_intern__grow_shard(StringInternShard *shard) {
+	isize new_slot_count = shard->slot_count*2;
+	auto **new_slots = gb_alloc_array(heap_allocator(), InternedStringHeader *, new_slot_count);
+	isize mask = new_slot_count-1;
+	for (isize i = 0; i < shard->slot_count; i++) {
+		InternedStringHeader *header = shard->slots[i];
+		if (header == nullptr) {
+			continue;
+		}
+		isize j = cast(isize)header->hash & mask;
+		while (new_slots[j] != nullptr) {
+			j = (j+1) & mask;
+		}
+		new_slots[j] = header;
+	}
+	gb_free(heap_allocator(), shard->slots);
+	shard->slots = new_slots;
+	shard->slot_count = new_slot_count;
+}
+
+// NOTE: Returns the canonical copy of the string, which is valid for the rest of the
+// compilation. If the string cannot be interned, it is returned unchanged.
+String string_intern(String const &s) {
+	StringInterner *si = &global_string_interner;
+	if (si->base == nullptr || s.len == 0 || string_is_interned(s)) {
+		return s;
+	}
+
+	u64 hash = gb_fnv64a(s.text, s.len);
+	// NOTE: The top bits pick the shard, the low bits the slot within it
+	StringInternShard *shard = &si->shards[(hash >> 58) % STRING_INTERN_SHARD_COUNT];
+
+	gb_mutex_lock(&shard->mutex);
+	defer (gb_mutex_unlock(&shard->mutex));
+
+	isize mask = shard->slot_count-1;
+	isize i = cast(isize)hash & mask;
+	for (;;) {
+		InternedStringHeader *header = shard->slots[i];
+		if (header == nullptr) {
+			break;
+		}
+		if (header->hash == hash && header->len == s.len &&
+		    gb_memcompare(header->text, s.text, s.len) == 0) {
+			return make_string(header->text, header->len);
+		}
+		i = (i+1) & mask;
+	}
+
+	InternedStringHeader *header = string_intern__alloc(s, hash);
+	if (header == nullptr) {
+		return s;
+	}
+	shard->slots[i] = header;
+	shard->count += 1;
+	if (shard->count*4 >= shard->slot_count*3) {
+		string_intern__grow_shard(shard);
+	}
+	return make_string(header->text, header->len);
+}
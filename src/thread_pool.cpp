@@ -0,0 +1,199 @@
+// Thread pool with per-worker task deques and work stealing
+//
+// A worker pushes and pops tasks at the back of its own deque and, when it
+// runs dry, steals from the front of the other workers' deques. Tasks added
+// from a thread that is not part of the pool are distributed round-robin.
+// Idle workers sleep on a semaphore rather than spinning.
+
+#define WORKER_TASK_PROC(name) isize name(void *data)
+typedef WORKER_TASK_PROC(WorkerTaskProc);
+
+struct WorkerTask {
+	WorkerTaskProc *do_work;
+	void *          data;
+};
+
+struct ThreadPoolDeque {
+	gbMutex           mutex;
+	Array<WorkerTask> tasks;
+	isize             head; // NOTE: Index of the oldest task, stolen from the front
+};
+
+struct ThreadPool {
+	Array<gbThread>        threads;
+	Array<ThreadPoolDeque> deques;
+
+	gbSemaphore   task_available; // NOTE: One post per task added, plus one per worker on shutdown
+	gbSemaphore   tasks_done;     // NOTE: Posted whenever the outstanding task count reaches zero
+	gbAtomic64    outstanding_tasks;
+	gbAtomic64    next_deque;
+	gbAtomic64    steal_count;
+	b32 volatile  is_running;
+};
+
+struct ThreadPoolWorkerContext {
+	ThreadPool *pool;
+	isize       index;
+};
+
+gb_thread_local ThreadPoolWorkerContext thread_pool_current_worker = {};
+
+
+void thread_pool_init(ThreadPool *pool, gbAllocator const &a, isize thread_count);
+void thread_pool_destroy(ThreadPool *pool);
+void thread_pool_add_task(ThreadPool *pool, WorkerTaskProc *proc, void *data);
+void thread_pool_wait_to_process(ThreadPool *pool);
+
+
+bool thread_pool__deque_pop_back(ThreadPoolDeque *d, WorkerTask *task) {
+	gb_mutex_lock(&d->mutex);
+	defer (gb_mutex_unlock(&d->mutex));
+
+	if (d->tasks.count <= d->head) {
+		return false;
+	}
+	*task = array_pop(&d->tasks);
+	if (d->tasks.count == d->head) {
+		array_clear(&d->tasks);
+		d->head = 0;
+	}
+	return true;
+}
+
+bool thread_pool__deque_steal_front(ThreadPoolDeque *d, WorkerTask *task) {
+	gb_mutex_lock(&d->mutex);
+	defer (gb_mutex_unlock(&d->mutex));
+
+	if (d->tasks.count <= d->head) {
+		return false;
+	}
+	*task = d->tasks[d->head++];
+	if (d->tasks.count == d->head) {
+		array_clear(&d->tasks);
+		d->head = 0;
+	}
+	return true;
+}
+
+bool thread_pool__take_task(ThreadPool *pool, isize worker_index, WorkerTask *task) {
+	if (thread_pool__deque_pop_back(&pool->deques[worker_index], task)) {
+		return true;
+	}
+	isize count = pool->deques.count;
+	for (isize i = 1; i < count; i++) {
+		isize victim = (worker_index + i) % count;
+		if (thread_pool__deque_steal_front(&pool->deques[victim], task)) {
+			gb_atomic64_fetch_add(&pool->steal_count, 1);
+			return true;
+		}
+	}
+	return false;
+}
+
+GB_THREAD_PROC(thread_pool_worker_proc) {
+	ThreadPool *pool = cast(ThreadPool *)thread->user_data;
+	isize index = thread->user_index;
+
+	thread_pool_current_worker.pool  = pool;
+	thread_pool_current_worker.index = index;
+
+	for (;;) {
+		gb_semaphore_wait(&pool->task_available);
+
+		WorkerTask task = {};
+		// NOTE: Every post of 'task_available' is preceded by a push, so
+		// having acquired the semaphore there is a task waiting somewhere
+		while (!thread_pool__take_task(pool, index, &task)) {
+			if (!pool->is_running) {
+				return 0;
+			}
+			gb_yield_thread();
+		}
+
+		task.do_work(task.data);
+
+		if (gb_atomic64_fetch_add(&pool->outstanding_tasks, -1) == 1) {
+			gb_semaphore_release(&pool->tasks_done);
+		}
+	}
+	return 0;
+}
+
+
+void thread_pool_init(ThreadPool *pool, gbAllocator const &a, isize thread_count) {
+	thread_count = gb_max(thread_count, 1);
+
+	gb_semaphore_init(&pool->task_available);
+	gb_semaphore_init(&pool->tasks_done);
+	gb_atomic64_store(&pool->outstanding_tasks, 0);
+	gb_atomic64_store(&pool->next_deque, 0);
+	gb_atomic64_store(&pool->steal_count, 0);
+	pool->is_running = true;
+
+	array_init(&pool->deques, a, thread_count);
+	for_array(i, pool->deques) {
+		ThreadPoolDeque *d = &pool->deques[i];
+		gb_mutex_init(&d->mutex);
+		array_init(&d->tasks, a, 0, 64);
+		d->head = 0;
+	}
+
+	array_init(&pool->threads, a, thread_count);
+	for_array(i, pool->threads) {
+		gbThread *t = &pool->threads[i];
+		gb_thread_init(t);
+		t->user_index = i;
+		gb_thread_start(t, thread_pool_worker_proc, pool);
+	}
+}
+
+void thread_pool_destroy(ThreadPool *pool) {
+	thread_pool_wait_to_process(pool);
+
+	pool->is_running = false;
+	gb_semaphore_post(&pool->task_available, cast(i32)pool->threads.count);
+
+	for_array(i, pool->threads) {
+		gb_thread_destroy(&pool->threads[i]);
+	}
+	for_array(i, pool->deques) {
+		ThreadPoolDeque *d = &pool->deques[i];
+		gb_mutex_destroy(&d->mutex);
+		array_free(&d->tasks);
+	}
+
+	array_free(&pool->threads);
+	array_free(&pool->deques);
+	gb_semaphore_destroy(&pool->task_available);
+	gb_semaphore_destroy(&pool->tasks_done);
+}
+
+void thread_pool_add_task(ThreadPool *pool, WorkerTaskProc *proc, void *data) {
+	GB_ASSERT(proc != nullptr);
+	WorkerTask task = {proc, data};
+
+	isize index = 0;
+	if (thread_pool_current_worker.pool == pool) {
+		// NOTE: Tasks spawned by a worker go to its own deque for locality
+		index = thread_pool_current_worker.index;
+	} else {
+		index = cast(isize)(gb_atomic64_fetch_add(&pool->next_deque, 1) % pool->deques.count);
+	}
+
+	gb_atomic64_fetch_add(&pool->outstanding_tasks, 1);
+
+	ThreadPoolDeque *d = &pool->deques[index];
+	gb_mutex_lock(&d->mutex);
+	array_add(&d->tasks, task);
+	gb_mutex_unlock(&d->mutex);
+
+	gb_semaphore_release(&pool->task_available);
+}
+
+// NOTE: Must not be called from a worker thread of the same pool
+void thread_pool_wait_to_process(ThreadPool *pool) {
+	GB_ASSERT(thread_pool_current_worker.pool != pool);
+	while (gb_atomic64_load(&pool->outstanding_tasks) > 0) {
+		gb_semaphore_wait(&pool->tasks_done);
+	}
+}
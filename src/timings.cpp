@@ -158,12 +158,17 @@ f64 time_stamp(TimeStamp const &ts, u64 freq, TimingUnit unit) {
 	}
 }
 
+void timings_finish(Timings *t) {
+	timings__stop_current_section(t);
+	t->total.finish = time_stamp_time_now();
+	t->total_time_seconds = time_stamp_as_s(t->total, t->freq);
+}
+
 void timings_print_all(Timings *t, TimingUnit unit = TimingUnit_Millisecond) {
 	char const SPACES[] = "                                                                ";
 	isize max_len;
 
-	timings__stop_current_section(t);
-	t->total.finish = time_stamp_time_now();
+	timings_finish(t);
 
 	max_len = t->total.label.len;
 	max_len = 36;
@@ -174,8 +179,6 @@ void timings_print_all(Timings *t, TimingUnit unit = TimingUnit_Millisecond) {
 
 	GB_ASSERT(max_len <= gb_size_of(SPACES)-1);
 
-	t->total_time_seconds = time_stamp_as_s(t->total, t->freq);
-
 	f64 total_time = time_stamp(t->total, t->freq, unit);
 
 	gb_printf("%.*s%.*s - % 9.3f %s - %6.2f%%\n",
@@ -196,3 +199,212 @@ void timings_print_all(Timings *t, TimingUnit unit = TimingUnit_Millisecond) {
 		          100.0*section_time/total_time);
 	}
 }
+
+
+// NOTE: With '-show-timings:json', nested scopes are recorded from any thread and written out
+// along with the sections of a Timings in the Chrome trace event format (chrome://tracing)
+struct TimingsTraceEvent {
+	char const *category;
+	String      label;
+	String      detail; // NOTE: Optional, owned by the trace
+	u64         start;
+	u64         finish;
+	u32         thread_id;
+};
+
+struct TimingsTraceCounter {
+	char const *name;
+	i64         value;
+};
+
+struct TimingsTrace {
+	gbMutex                    mutex;
+	u32                        main_thread_id;
+	Array<TimingsTraceEvent>   events;
+	Array<TimingsTraceCounter> counters;
+};
+
+// NOTE: Only set when tracing, so a scope costs a single branch otherwise
+gb_global TimingsTrace *global_timings_trace = nullptr;
+
+void timings_trace_init(TimingsTrace *t) {
+	gb_mutex_init(&t->mutex);
+	t->main_thread_id = gb_thread_current_id();
+	array_init(&t->events, heap_allocator(), 0, 1024);
+	array_init(&t->counters, heap_allocator());
+	global_timings_trace = t;
+}
+
+void timings_trace_destroy(TimingsTrace *t) {
+	if (global_timings_trace == t) {
+		global_timings_trace = nullptr;
+	}
+	for_array(i, t->events) {
+		if (t->events[i].detail.len > 0) {
+			gb_free(heap_allocator(), t->events[i].detail.text);
+		}
+	}
+	array_free(&t->events);
+	array_free(&t->counters);
+	gb_mutex_destroy(&t->mutex);
+}
+
+u64 timings_trace_begin(void) {
+	if (global_timings_trace == nullptr) {
+		return 0;
+	}
+	return time_stamp_time_now();
+}
+
+// NOTE: 'label' must outlive the trace, 'detail' is copied
+void timings_trace_end(char const *category, String label, u64 start, String detail = {}) {
+	TimingsTrace *t = global_timings_trace;
+	if (t == nullptr) {
+		return;
+	}
+	TimingsTraceEvent e = {};
+	e.category  = category;
+	e.label     = label;
+	e.start     = start;
+	e.finish    = time_stamp_time_now();
+	e.thread_id = gb_thread_current_id();
+	if (detail.len > 0) {
+		e.detail = copy_string(heap_allocator(), detail);
+	}
+
+	gb_mutex_lock(&t->mutex);
+	array_add(&t->events, e);
+	gb_mutex_unlock(&t->mutex);
+}
+
+#define TIMINGS_TRACE_SCOPE(category, label) \
+	u64 GB_JOIN2(timings_trace_start_, __LINE__) = timings_trace_begin(); \
+	defer (timings_trace_end(category, label, GB_JOIN2(timings_trace_start_, __LINE__)))
+
+// NOTE: Consecutive scopes within a procedure, like the sections of a Timings
+struct TimingsTraceSection {
+	char const *category;
+	String      label;
+	u64         start;
+};
+
+void timings_trace_section_end(TimingsTraceSection *s) {
+	if (s->label.len > 0) {
+		timings_trace_end(s->category, s->label, s->start);
+		s->label = {};
+	}
+}
+
+void timings_trace_section_start(TimingsTraceSection *s, String label) {
+	timings_trace_section_end(s);
+	s->label = label;
+	s->start = timings_trace_begin();
+}
+
+void timings_trace_add_counter(TimingsTrace *t, char const *name, i64 value) {
+	TimingsTraceCounter c = {name, value};
+	array_add(&t->counters, c);
+}
+
+
+gbString timings__append_json_string(gbString str, String s) {
+	str = gb_string_appendc(str, "\"");
+	isize start = 0;
+	for (isize i = 0; i < s.len; i++) {
+		u8 c = s[i];
+		if (c != '"' && c != '\\' && c >= 0x20) {
+			continue;
+		}
+		str = gb_string_append_length(str, s.text+start, i-start);
+		start = i+1;
+		switch (c) {
+		case '"':  str = gb_string_appendc(str, "\\\""); break;
+		case '\\': str = gb_string_appendc(str, "\\\\"); break;
+		case '\n': str = gb_string_appendc(str, "\\n");  break;
+		case '\t': str = gb_string_appendc(str, "\\t");  break;
+		default:   str = gb_string_append_fmt(str, "\\u%04x", cast(u32)c); break;
+		}
+	}
+	str = gb_string_append_length(str, s.text+start, s.len-start);
+	return gb_string_appendc(str, "\"");
+}
+
+gbString timings__append_trace_event(gbString str, Timings *t, char const *category, String label, u64 start, u64 finish, isize tid) {
+	f64 ts  = 1.0e6*cast(f64)(start - t->total.start)/cast(f64)t->freq;
+	f64 dur = 1.0e6*cast(f64)(finish - start)/cast(f64)t->freq;
+	str = gb_string_appendc(str, ",\n{\"name\":");
+	str = timings__append_json_string(str, label);
+	str = gb_string_append_fmt(str, ",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%td", category, ts, dur, tid);
+	return str;
+}
+
+isize timings__trace_thread_index(Array<u32> *thread_ids, u32 id) {
+	for_array(i, *thread_ids) {
+		if ((*thread_ids)[i] == id) {
+			return i;
+		}
+	}
+	array_add(thread_ids, id);
+	return thread_ids->count-1;
+}
+
+// NOTE: Requires 'timings_finish' to be called before this
+bool timings_write_trace_json(Timings *t, TimingsTrace *trace, String path) {
+	gbString str = gb_string_make_reserve(heap_allocator(), 1<<16);
+	defer (gb_string_free(str));
+
+	auto thread_ids = array_make<u32>(heap_allocator(), 0, 16);
+	defer (array_free(&thread_ids));
+	array_add(&thread_ids, trace->main_thread_id);
+
+	str = gb_string_appendc(str, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+	str = gb_string_appendc(str, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"odin\"}}");
+
+	str = timings__append_trace_event(str, t, "total", t->total.label, t->total.start, t->total.finish, 0);
+	str = gb_string_appendc(str, "}");
+	for_array(i, t->sections) {
+		TimeStamp ts = t->sections[i];
+		str = timings__append_trace_event(str, t, "section", ts.label, ts.start, ts.finish, 0);
+		str = gb_string_appendc(str, "}");
+	}
+
+	gb_mutex_lock(&trace->mutex);
+	for_array(i, trace->events) {
+		TimingsTraceEvent *e = &trace->events[i];
+		isize tid = timings__trace_thread_index(&thread_ids, e->thread_id);
+		str = timings__append_trace_event(str, t, e->category, e->label, e->start, e->finish, tid);
+		if (e->detail.len > 0) {
+			str = gb_string_appendc(str, ",\"args\":{\"detail\":");
+			str = timings__append_json_string(str, e->detail);
+			str = gb_string_appendc(str, "}");
+		}
+		str = gb_string_appendc(str, "}");
+	}
+	gb_mutex_unlock(&trace->mutex);
+
+	for_array(i, thread_ids) {
+		str = gb_string_append_fmt(str, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%td,\"args\":{\"name\":\"%s %td\"}}",
+		                           i, i == 0 ? "main" : "worker", i);
+	}
+
+	if (trace->counters.count > 0) {
+		f64 ts = 1.0e6*cast(f64)(t->total.finish - t->total.start)/cast(f64)t->freq;
+		str = gb_string_append_fmt(str, ",\n{\"name\":\"counters\",\"ph\":\"C\",\"ts\":%.3f,\"pid\":1,\"tid\":0,\"args\":{", ts);
+		for_array(i, trace->counters) {
+			TimingsTraceCounter c = trace->counters[i];
+			str = gb_string_append_fmt(str, "%s\"%s\":%td", i > 0 ? "," : "", c.name, cast(isize)c.value);
+		}
+		str = gb_string_appendc(str, "}}");
+	}
+	str = gb_string_appendc(str, "\n]}\n");
+
+	char *path_c = alloc_cstring(heap_allocator(), path);
+	defer (gb_free(heap_allocator(), path_c));
+
+	gbFile f = {};
+	if (gb_file_create(&f, path_c) != gbFileError_None) {
+		return false;
+	}
+	defer (gb_file_close(&f));
+	return gb_file_write(&f, str, gb_string_length(str)) != 0;
+}
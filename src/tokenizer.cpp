@@ -143,6 +143,41 @@ String const token_strings[] = {
 };
 
 
+// NOTE: Keywords (and directive names in the parser) are found with a perfect hash
+// of their length and first and last bytes. The tables are filled from the lists of names
+// on startup, which checks that the hash is still perfect whenever a name is added.
+#define NAME_HASH_TABLE_SIZE 128
+
+gb_inline u32 name_hash_index(String const &s) {
+	GB_ASSERT(s.len > 0);
+	u32 h = cast(u32)s.len*2 + cast(u32)s[0]*47 + cast(u32)s[s.len-1]*23;
+	return h & (NAME_HASH_TABLE_SIZE-1);
+}
+
+gb_global u8 keyword_hash_table[NAME_HASH_TABLE_SIZE] = {}; // NOTE: TokenKind, Token_Invalid when empty
+
+void init_keyword_hash_table(void) {
+	for (i32 k = Token__KeywordBegin+1; k < Token__KeywordEnd; k++) {
+		u32 index = name_hash_index(token_strings[k]);
+		GB_ASSERT_MSG(keyword_hash_table[index] == Token_Invalid,
+		              "Keyword hash collision between '%.*s' and '%.*s'",
+		              LIT(token_strings[k]), LIT(token_strings[keyword_hash_table[index]]));
+		keyword_hash_table[index] = cast(u8)k;
+	}
+}
+
+// NOTE: Returns Token_Ident if 'name' is not a keyword
+gb_inline TokenKind keyword_token_kind(String const &name) {
+	if (name.len > 1) { // NOTE: All keywords are > 1
+		TokenKind k = cast(TokenKind)keyword_hash_table[name_hash_index(name)];
+		if (k != Token_Invalid && token_strings[k] == name) {
+			return k;
+		}
+	}
+	return Token_Ident;
+}
+
+
 struct TokenPos {
 	String file;
 	isize  offset; // starting at 0
@@ -198,15 +233,126 @@ void init_global_error_collector(void) {
 	gb_mutex_init(&global_error_collector.mutex);
 }
 
+struct ErrorValue {
+	TokenPos pos;
+	isize    index; // NOTE: The order in which it was reported
+	String   text;
+};
+
+// NOTE: Whilst procedure bodies are checked in parallel, each one reports to its own buffer
+// and the diagnostics are printed in source order once all of them have been checked, see
+// 'error_values_print'
+struct ErrorBuffer {
+	TokenPos          prev;
+	Array<ErrorValue> values;
+};
+
+gb_thread_local ErrorBuffer *thread_error_buffer = nullptr;
+
+// NOTE: Called with 'global_error_collector.mutex' held
+TokenPos *error_prev_pos(void) {
+	if (thread_error_buffer != nullptr) {
+		return &thread_error_buffer->prev;
+	}
+	return &global_error_collector.prev;
+}
+
+void error_reset_prev_pos(void) {
+	TokenPos zero_pos = {};
+	gb_mutex_lock(&global_error_collector.mutex);
+	*error_prev_pos() = zero_pos;
+	gb_mutex_unlock(&global_error_collector.mutex);
+}
+
+// NOTE: Called with 'global_error_collector.mutex' held
+void error_out(TokenPos pos, char const *fmt, ...) {
+	va_list va;
+	va_start(va, fmt);
+	if (thread_error_buffer == nullptr) {
+		gb_printf_err_va(fmt, va);
+	} else {
+		// NOTE: Not 'gb_bprintf_va' as the arguments are usually in its buffer
+		char text[4096];
+		gb_snprintf_va(text, gb_size_of(text), fmt, va);
+		ErrorValue value = {};
+		value.pos   = pos;
+		value.index = thread_error_buffer->values.count;
+		value.text  = copy_string(heap_allocator(), make_string_c(text));
+		array_add(&thread_error_buffer->values, value);
+	}
+	va_end(va);
+}
+
+// NOTE: Continues the previous diagnostic
+void error_line(char const *fmt, ...) {
+	va_list va;
+	va_start(va, fmt);
+	if (thread_error_buffer == nullptr || thread_error_buffer->values.count == 0) {
+		gb_printf_err_va(fmt, va);
+	} else {
+		char text[4096];
+		gb_snprintf_va(text, gb_size_of(text), fmt, va);
+		ErrorValue *value = &thread_error_buffer->values[thread_error_buffer->values.count-1];
+		String prev = value->text;
+		value->text = concatenate_strings(heap_allocator(), prev, make_string_c(text));
+		gb_free(heap_allocator(), prev.text);
+	}
+	va_end(va);
+}
+
+bool error_too_many(void) {
+	// NOTE: A buffered diagnostic is not printed until 'error_values_print'
+	return thread_error_buffer == nullptr && global_error_collector.count > 20;
+}
+
+GB_COMPARE_PROC(error_value_cmp) {
+	ErrorValue const *x = cast(ErrorValue const *)a;
+	ErrorValue const *y = cast(ErrorValue const *)b;
+	int cmp = gb_memcompare(x->pos.file.text, y->pos.file.text, gb_min(x->pos.file.len, y->pos.file.len));
+	if (cmp != 0) {
+		return cmp;
+	}
+	if (x->pos.file.len != y->pos.file.len) {
+		return x->pos.file.len < y->pos.file.len ? -1 : +1;
+	}
+	if (x->pos.line != y->pos.line) {
+		return x->pos.line < y->pos.line ? -1 : +1;
+	}
+	if (x->pos.column != y->pos.column) {
+		return x->pos.column < y->pos.column ? -1 : +1;
+	}
+	return x->index < y->index ? -1 : x->index > y->index;
+}
+
+// NOTE: 'index' must be unique across all of 'values' so that the order is deterministic
+void error_values_print(Array<ErrorValue> values) {
+	gb_sort_array(values.data, values.count, error_value_cmp);
+
+	gb_mutex_lock(&global_error_collector.mutex);
+	for_array(i, values) {
+		ErrorValue *v = &values[i];
+		// NOTE: Duplicate error, skip it
+		if (v->pos.line == 0 || global_error_collector.prev != v->pos) {
+			global_error_collector.prev = v->pos;
+			gb_printf_err("%.*s", LIT(v->text));
+		}
+		gb_free(heap_allocator(), v->text.text);
+	}
+	gb_mutex_unlock(&global_error_collector.mutex);
+	if (global_error_collector.count > 20) {
+		gb_exit(1);
+	}
+}
+
 void warning_va(Token token, char *fmt, va_list va) {
 	gb_mutex_lock(&global_error_collector.mutex);
 	global_error_collector.warning_count++;
 	// NOTE(bill): Duplicate error, skip it
 	if (token.pos.line == 0) {
-		gb_printf_err("Error: %s\n", gb_bprintf_va(fmt, va));
-	} else if (global_error_collector.prev != token.pos) {
-		global_error_collector.prev = token.pos;
-		gb_printf_err("%.*s(%td:%td) Warning: %s\n",
+		error_out(token.pos, "Error: %s\n", gb_bprintf_va(fmt, va));
+	} else if (*error_prev_pos() != token.pos) {
+		*error_prev_pos() = token.pos;
+		error_out(token.pos, "%.*s(%td:%td) Warning: %s\n",
 		              LIT(token.pos.file), token.pos.line, token.pos.column,
 		              gb_bprintf_va(fmt, va));
 	}
@@ -219,15 +365,15 @@ void error_va(Token token, char *fmt, va_list va) {
 	global_error_collector.count++;
 	// NOTE(bill): Duplicate error, skip it
 	if (token.pos.line == 0) {
-		gb_printf_err("Error: %s\n", gb_bprintf_va(fmt, va));
-	} else if (global_error_collector.prev != token.pos) {
-		global_error_collector.prev = token.pos;
-		gb_printf_err("%.*s(%td:%td) %s\n",
+		error_out(token.pos, "Error: %s\n", gb_bprintf_va(fmt, va));
+	} else if (*error_prev_pos() != token.pos) {
+		*error_prev_pos() = token.pos;
+		error_out(token.pos, "%.*s(%td:%td) %s\n",
 		              LIT(token.pos.file), token.pos.line, token.pos.column,
 		              gb_bprintf_va(fmt, va));
 	}
 	gb_mutex_unlock(&global_error_collector.mutex);
-	if (global_error_collector.count > 20) {
+	if (error_too_many()) {
 		gb_exit(1);
 	}
 }
@@ -237,15 +383,15 @@ void error_no_newline_va(Token token, char *fmt, va_list va) {
 	global_error_collector.count++;
 	// NOTE(bill): Duplicate error, skip it
 	if (token.pos.line == 0) {
-		gb_printf_err("Error: %s", gb_bprintf_va(fmt, va));
-	} else if (global_error_collector.prev != token.pos) {
-		global_error_collector.prev = token.pos;
-		gb_printf_err("%.*s(%td:%td) %s",
+		error_out(token.pos, "Error: %s", gb_bprintf_va(fmt, va));
+	} else if (*error_prev_pos() != token.pos) {
+		*error_prev_pos() = token.pos;
+		error_out(token.pos, "%.*s(%td:%td) %s",
 		              LIT(token.pos.file), token.pos.line, token.pos.column,
 		              gb_bprintf_va(fmt, va));
 	}
 	gb_mutex_unlock(&global_error_collector.mutex);
-	if (global_error_collector.count > 20) {
+	if (error_too_many()) {
 		gb_exit(1);
 	}
 }
@@ -255,17 +401,17 @@ void syntax_error_va(Token token, char *fmt, va_list va) {
 	gb_mutex_lock(&global_error_collector.mutex);
 	global_error_collector.count++;
 	// NOTE(bill): Duplicate error, skip it
-	if (global_error_collector.prev != token.pos) {
-		global_error_collector.prev = token.pos;
-		gb_printf_err("%.*s(%td:%td) Syntax Error: %s\n",
+	if (*error_prev_pos() != token.pos) {
+		*error_prev_pos() = token.pos;
+		error_out(token.pos, "%.*s(%td:%td) Syntax Error: %s\n",
 		              LIT(token.pos.file), token.pos.line, token.pos.column,
 		              gb_bprintf_va(fmt, va));
 	} else if (token.pos.line == 0) {
-		gb_printf_err("Syntax Error: %s\n", gb_bprintf_va(fmt, va));
+		error_out(token.pos, "Syntax Error: %s\n", gb_bprintf_va(fmt, va));
 	}
 
 	gb_mutex_unlock(&global_error_collector.mutex);
-	if (global_error_collector.count > 20) {
+	if (error_too_many()) {
 		gb_exit(1);
 	}
 }
@@ -274,13 +420,13 @@ void syntax_warning_va(Token token, char *fmt, va_list va) {
 	gb_mutex_lock(&global_error_collector.mutex);
 	global_error_collector.warning_count++;
 	// NOTE(bill): Duplicate error, skip it
-	if (global_error_collector.prev != token.pos) {
-		global_error_collector.prev = token.pos;
-		gb_printf_err("%.*s(%td:%td) Syntax Warning: %s\n",
+	if (*error_prev_pos() != token.pos) {
+		*error_prev_pos() = token.pos;
+		error_out(token.pos, "%.*s(%td:%td) Syntax Warning: %s\n",
 		              LIT(token.pos.file), token.pos.line, token.pos.column,
 		              gb_bprintf_va(fmt, va));
 	} else if (token.pos.line == 0) {
-		gb_printf_err("Warning: %s\n", gb_bprintf_va(fmt, va));
+		error_out(token.pos, "Warning: %s\n", gb_bprintf_va(fmt, va));
 	}
 
 	gb_mutex_unlock(&global_error_collector.mutex);
@@ -384,6 +530,7 @@ struct Tokenizer {
 	String fullpath;
 	u8 *start;
 	u8 *end;
+	isize mapped_size; // NOTE: Non-zero when 'start' is a memory mapped view of the file
 
 	Rune  curr_rune;   // current character
 	u8 *  curr;        // character pos
@@ -465,16 +612,272 @@ void advance_to_next_rune(Tokenizer *t) {
 	}
 }
 
+
+// NOTE: Runs of ASCII bytes which the scanner would otherwise step over one rune
+// at a time. None of them contain NUL or a non-ASCII byte, which are left to the rune path.
+enum TokenizerRunKind {
+	TokenizerRun_Whitespace,   // ' ' '\t' '\n' '\r'
+	TokenizerRun_Identifier,   // [A-Za-z0-9_]
+	TokenizerRun_LineComment,  // anything but '\n'
+	TokenizerRun_BlockComment, // anything but '*' and '/'
+	TokenizerRun_String,       // anything but '"', '\\' and '\n'
+	TokenizerRun_RawString,    // anything but '`'
+};
+
+gb_inline bool tokenizer_run_continues(TokenizerRunKind kind, u8 c) {
+	if (c == 0 || c >= 0x80) {
+		return false;
+	}
+	switch (kind) {
+	case TokenizerRun_Whitespace:
+		return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+	case TokenizerRun_Identifier:
+		return gb_is_between(c|0x20, 'a', 'z') || gb_is_between(c, '0', '9') || c == '_';
+	case TokenizerRun_LineComment:
+		return c != '\n';
+	case TokenizerRun_BlockComment:
+		return c != '*' && c != '/';
+	case TokenizerRun_String:
+		return c != '"' && c != '\\' && c != '\n';
+	case TokenizerRun_RawString:
+		return c != '`';
+	}
+	return false;
+}
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define TOKENIZER_SIMD_WIDTH 32
+typedef __m256i TokenizerSimd;
+gb_inline TokenizerSimd tokenizer_simd_load(u8 const *p)                   { return _mm256_loadu_si256(cast(__m256i const *)p); }
+gb_inline TokenizerSimd tokenizer_simd_set1(char c)                        { return _mm256_set1_epi8(c); }
+gb_inline TokenizerSimd tokenizer_simd_eq(TokenizerSimd a, char c)         { return _mm256_cmpeq_epi8(a, _mm256_set1_epi8(c)); }
+gb_inline TokenizerSimd tokenizer_simd_gt(TokenizerSimd a, TokenizerSimd b) { return _mm256_cmpgt_epi8(a, b); }
+gb_inline TokenizerSimd tokenizer_simd_or(TokenizerSimd a, TokenizerSimd b) { return _mm256_or_si256(a, b); }
+gb_inline TokenizerSimd tokenizer_simd_and(TokenizerSimd a, TokenizerSimd b) { return _mm256_and_si256(a, b); }
+gb_inline TokenizerSimd tokenizer_simd_andnot(TokenizerSimd a, TokenizerSimd b) { return _mm256_andnot_si256(a, b); } // ~a & b
+gb_inline u32 tokenizer_simd_mask(TokenizerSimd a)                         { return cast(u32)_mm256_movemask_epi8(a); }
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define TOKENIZER_SIMD_WIDTH 16
+typedef __m128i TokenizerSimd;
+gb_inline TokenizerSimd tokenizer_simd_load(u8 const *p)                   { return _mm_loadu_si128(cast(__m128i const *)p); }
+gb_inline TokenizerSimd tokenizer_simd_set1(char c)                        { return _mm_set1_epi8(c); }
+gb_inline TokenizerSimd tokenizer_simd_eq(TokenizerSimd a, char c)         { return _mm_cmpeq_epi8(a, _mm_set1_epi8(c)); }
+gb_inline TokenizerSimd tokenizer_simd_gt(TokenizerSimd a, TokenizerSimd b) { return _mm_cmpgt_epi8(a, b); }
+gb_inline TokenizerSimd tokenizer_simd_or(TokenizerSimd a, TokenizerSimd b) { return _mm_or_si128(a, b); }
+gb_inline TokenizerSimd tokenizer_simd_and(TokenizerSimd a, TokenizerSimd b) { return _mm_and_si128(a, b); }
+gb_inline TokenizerSimd tokenizer_simd_andnot(TokenizerSimd a, TokenizerSimd b) { return _mm_andnot_si128(a, b); } // ~a & b
+gb_inline u32 tokenizer_simd_mask(TokenizerSimd a)                         { return cast(u32)_mm_movemask_epi8(a); }
+#else
+#define TOKENIZER_SIMD_WIDTH 0
+#endif
+
+#if TOKENIZER_SIMD_WIDTH > 0
+// NOTE: Bytes >= 0x80 are negative as signed bytes, so 'gt' against zero or any
+// positive bound also rejects them
+gb_inline TokenizerSimd tokenizer_simd_in_range(TokenizerSimd c, char lo, char hi) {
+	return tokenizer_simd_and(tokenizer_simd_gt(c, tokenizer_simd_set1(lo-1)),
+	                          tokenizer_simd_gt(tokenizer_simd_set1(hi+1), c));
+}
+
+// NOTE: Returns a bit mask of the bytes for which 'tokenizer_run_continues' is true
+gb_inline u32 tokenizer_simd_run_mask(TokenizerRunKind kind, u8 const *p) {
+	TokenizerSimd c = tokenizer_simd_load(p);
+	TokenizerSimd ascii = tokenizer_simd_gt(c, tokenizer_simd_set1(0));
+	TokenizerSimd v = {};
+	switch (kind) {
+	case TokenizerRun_Whitespace:
+		v = tokenizer_simd_or(tokenizer_simd_or(tokenizer_simd_eq(c, ' '),  tokenizer_simd_eq(c, '\t')),
+		                      tokenizer_simd_or(tokenizer_simd_eq(c, '\n'), tokenizer_simd_eq(c, '\r')));
+		break;
+	case TokenizerRun_Identifier:
+		v = tokenizer_simd_in_range(tokenizer_simd_or(c, tokenizer_simd_set1(0x20)), 'a', 'z');
+		v = tokenizer_simd_or(v, tokenizer_simd_in_range(c, '0', '9'));
+		v = tokenizer_simd_or(v, tokenizer_simd_eq(c, '_'));
+		break;
+	case TokenizerRun_LineComment:
+		v = tokenizer_simd_andnot(tokenizer_simd_eq(c, '\n'), ascii);
+		break;
+	case TokenizerRun_BlockComment:
+		v = tokenizer_simd_andnot(tokenizer_simd_or(tokenizer_simd_eq(c, '*'), tokenizer_simd_eq(c, '/')), ascii);
+		break;
+	case TokenizerRun_String:
+		v = tokenizer_simd_or(tokenizer_simd_eq(c, '"'), tokenizer_simd_eq(c, '\\'));
+		v = tokenizer_simd_andnot(tokenizer_simd_or(v, tokenizer_simd_eq(c, '\n')), ascii);
+		break;
+	case TokenizerRun_RawString:
+		v = tokenizer_simd_andnot(tokenizer_simd_eq(c, '`'), ascii);
+		break;
+	}
+	return tokenizer_simd_mask(v);
+}
+
+gb_inline isize tokenizer_lowest_bit(u32 mask) {
+	GB_ASSERT(mask != 0);
+#if defined(GB_COMPILER_MSVC)
+	unsigned long index = 0;
+	_BitScanForward(&index, mask);
+	return cast(isize)index;
+#else
+	return cast(isize)__builtin_ctz(mask);
+#endif
+}
+#endif
+
+// NOTE: Returns the length of the run of 'kind' starting at 'p'
+gb_inline isize tokenizer_scan_run(TokenizerRunKind kind, u8 const *p, u8 const *end) {
+	u8 const *start = p;
+#if TOKENIZER_SIMD_WIDTH > 0
+	u32 const all = (TOKENIZER_SIMD_WIDTH == 32) ? 0xffffffffu : ((1u<<TOKENIZER_SIMD_WIDTH)-1);
+	// NOTE: Never load past 'end', the sentinel is only guaranteed for one byte
+	while (end-p >= TOKENIZER_SIMD_WIDTH) {
+		u32 mask = tokenizer_simd_run_mask(kind, p);
+		if (mask != all) {
+			return (p-start) + tokenizer_lowest_bit(~mask & all);
+		}
+		p += TOKENIZER_SIMD_WIDTH;
+	}
+#endif
+	while (p < end && tokenizer_run_continues(kind, *p)) {
+		p++;
+	}
+	return p-start;
+}
+
+// NOTE: Steps over the run of 'kind' which begins with the current rune, returning
+// false if the current rune does not begin one. Afterwards the tokenizer is in the same
+// state as if 'advance_to_next_rune' had been called for each byte of the run.
+gb_inline bool tokenizer_skip_run(Tokenizer *t, TokenizerRunKind kind) {
+	if (t->curr_rune < 0 || t->curr_rune >= 0x80 || !tokenizer_run_continues(kind, cast(u8)t->curr_rune)) {
+		return false;
+	}
+	GB_ASSERT(t->read_curr == t->curr+1);
+
+	u8 *end = t->curr + tokenizer_scan_run(kind, t->curr, t->end);
+	u8 *last = end-1;
+	if (kind != TokenizerRun_Identifier && kind != TokenizerRun_LineComment && kind != TokenizerRun_String) {
+		// NOTE: 'advance_to_next_rune' handles a newline as the last byte of the run
+		for (u8 *nl = t->curr; nl < last; nl++) {
+			nl = cast(u8 *)gb_memchr(nl, '\n', last-nl);
+			if (nl == nullptr) {
+				break;
+			}
+			t->line = nl+1;
+			t->line_count++;
+		}
+	}
+
+	t->curr_rune = *last;
+	t->curr = last;
+	t->read_curr = end;
+	advance_to_next_rune(t);
+	return true;
+}
+
+// NOTE: The scanner relies upon a NUL byte directly after the contents of
+// the file. The mapping is only used when that sentinel is guaranteed, otherwise
+// the file is read into memory as usual.
+#if defined(GB_SYSTEM_WINDOWS)
+bool tokenizer_map_file(String fullpath, gbFileContents *fc, isize *mapped_size) {
+	String16 wpath = string_to_string16(heap_allocator(), fullpath);
+	defer (gb_free(heap_allocator(), wpath.text));
+
+	HANDLE file = CreateFileW(wpath.text, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE) {
+		return false;
+	}
+	defer (CloseHandle(file));
+
+	LARGE_INTEGER file_size = {};
+	if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart <= 0) {
+		return false;
+	}
+	isize size = cast(isize)file_size.QuadPart;
+	isize page_size = gb_virtual_memory_page_size(nullptr);
+	if (size % page_size == 0) {
+		// NOTE: No room left in the last page for the zeroed sentinel
+		return false;
+	}
+
+	HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+	if (mapping == nullptr) {
+		return false;
+	}
+	defer (CloseHandle(mapping));
+
+	void *data = MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0);
+	if (data == nullptr) {
+		return false;
+	}
+
+	fc->data = data;
+	fc->size = size;
+	*mapped_size = align_formula_isize(size, page_size);
+	return true;
+}
+
+void tokenizer_unmap_file(void *data, isize mapped_size) {
+	UnmapViewOfFile(data);
+}
+#else
+bool tokenizer_map_file(String fullpath, gbFileContents *fc, isize *mapped_size) {
+	char *c_str = alloc_cstring(heap_allocator(), fullpath);
+	defer (gb_free(heap_allocator(), c_str));
+
+	int fd = open(c_str, O_RDONLY);
+	if (fd < 0) {
+		return false;
+	}
+	defer (close(fd));
+
+	struct stat st = {};
+	if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size <= 0) {
+		return false;
+	}
+	isize size = cast(isize)st.st_size;
+	isize page_size = gb_virtual_memory_page_size(nullptr);
+	isize total_size = align_formula_isize(size+1, page_size);
+
+	// NOTE: Reserve zeroed pages covering the file plus the sentinel byte and
+	// map the file over the front of them. Bytes past the end of the file within
+	// its last page are zeroed by the kernel, and the page after it (if the file
+	// fills its last page exactly) is anonymous memory, which is zeroed too.
+	void *base = mmap(nullptr, total_size, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANON, -1, 0);
+	if (base == MAP_FAILED) {
+		return false;
+	}
+	void *data = mmap(base, size, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_FIXED, fd, 0);
+	if (data == MAP_FAILED) {
+		munmap(base, total_size);
+		return false;
+	}
+
+	fc->data = data;
+	fc->size = size;
+	*mapped_size = total_size;
+	return true;
+}
+
+void tokenizer_unmap_file(void *data, isize mapped_size) {
+	munmap(data, mapped_size);
+}
+#endif
+
 TokenizerInitError init_tokenizer(Tokenizer *t, String fullpath) {
 	TokenizerInitError err = TokenizerInit_None;
 
 	char *c_str = alloc_cstring(heap_allocator(), fullpath);
 	defer (gb_free(heap_allocator(), c_str));
 
-	// TODO(bill): Memory map rather than copy contents
-	gbFileContents fc = gb_file_read_contents(heap_allocator(), true, c_str);
 	gb_zero_item(t);
 
+	gbFileContents fc = {};
+	if (!tokenizer_map_file(fullpath, &fc, &t->mapped_size)) {
+		t->mapped_size = 0;
+		fc = gb_file_read_contents(heap_allocator(), true, c_str);
+	}
+
 	t->fullpath = fullpath;
 	t->line_count = 1;
 
@@ -490,6 +893,9 @@ TokenizerInitError init_tokenizer(Tokenizer *t, String fullpath) {
 
 		array_init(&t->allocated_strings, heap_allocator());
 	} else {
+		// NOTE: An empty file is a single Token_EOF
+		t->curr_rune = GB_RUNE_EOF;
+
 		gbFile f = {};
 		gbFileError file_err = gb_file_open(&f, c_str);
 		defer (gb_file_close(&f));
@@ -509,7 +915,9 @@ TokenizerInitError init_tokenizer(Tokenizer *t, String fullpath) {
 }
 
 gb_inline void destroy_tokenizer(Tokenizer *t) {
-	if (t->start != nullptr) {
+	if (t->mapped_size > 0) {
+		tokenizer_unmap_file(t->start, t->mapped_size);
+	} else if (t->start != nullptr) {
 		gb_free(heap_allocator(), t->start);
 	}
 	for_array(i, t->allocated_strings) {
@@ -519,12 +927,7 @@ gb_inline void destroy_tokenizer(Tokenizer *t) {
 }
 
 void tokenizer_skip_whitespace(Tokenizer *t) {
-	while (t->curr_rune == ' ' ||
-	       t->curr_rune == '\t' ||
-	       t->curr_rune == '\n' ||
-	       t->curr_rune == '\r') {
-		advance_to_next_rune(t);
-	}
+	tokenizer_skip_run(t, TokenizerRun_Whitespace);
 }
 
 gb_inline i32 digit_value(Rune r) {
@@ -550,11 +953,13 @@ Token scan_number_to_token(Tokenizer *t, bool seen_decimal_point) {
 	token.string = make_string(t->curr, 1);
 	token.pos.file = t->fullpath;
 	token.pos.line = t->line_count;
+	token.pos.offset = t->curr-t->start;
 	token.pos.column = t->curr-t->line+1;
 
 	if (seen_decimal_point) {
 		token.string.text -= 1;
 		token.string.len  += 1;
+		token.pos.offset -= 1;
 		token.pos.column -= 1;
 		token.kind = Token_Float;
 		scan_mantissa(t, 10);
@@ -790,21 +1195,18 @@ Token tokenizer_get_token(Tokenizer *t) {
 	Rune curr_rune = t->curr_rune;
 	if (rune_is_letter(curr_rune)) {
 		token.kind = Token_Ident;
-		while (rune_is_letter(t->curr_rune) || rune_is_digit(t->curr_rune)) {
-			advance_to_next_rune(t);
+		for (;;) {
+			tokenizer_skip_run(t, TokenizerRun_Identifier);
+			// NOTE: The run stops at every ASCII rune which cannot be in an identifier
+			if (t->curr_rune < 0x80 || (!rune_is_letter(t->curr_rune) && !rune_is_digit(t->curr_rune))) {
+				break;
+			}
+			advance_to_next_rune(t); // NOTE: Non-ASCII letter or digit
 		}
 
 		token.string.len = t->curr - token.string.text;
 
-		// NOTE(bill): All keywords are > 1
-		if (token.string.len > 1) {
-			for (i32 k = Token__KeywordBegin+1; k < Token__KeywordEnd; k++) {
-				if (token.string == token_strings[k]) {
-					token.kind = cast(TokenKind)k;
-					break;
-				}
-			}
-		}
+		token.kind = keyword_token_kind(token.string);
 
 	} else if (gb_is_between(curr_rune, '0', '9')) {
 		token = scan_number_to_token(t, false);
@@ -863,6 +1265,7 @@ Token tokenizer_get_token(Tokenizer *t) {
 			token.kind = Token_String;
 			if (curr_rune == '"') {
 				for (;;) {
+					tokenizer_skip_run(t, TokenizerRun_String);
 					Rune r = t->curr_rune;
 					if (r == '\n' || r < 0) {
 						tokenizer_err(t, "String literal not terminated");
@@ -878,6 +1281,7 @@ Token tokenizer_get_token(Tokenizer *t) {
 				}
 			} else {
 				for (;;) {
+					tokenizer_skip_run(t, TokenizerRun_RawString);
 					Rune r = t->curr_rune;
 					if (r < 0) {
 						tokenizer_err(t, "String literal not terminated");
@@ -968,7 +1372,9 @@ Token tokenizer_get_token(Tokenizer *t) {
 		case '#':
 			if (t->curr_rune == '!') {
 				while (t->curr_rune != '\n' && t->curr_rune != GB_RUNE_EOF) {
-					advance_to_next_rune(t);
+					if (!tokenizer_skip_run(t, TokenizerRun_LineComment)) {
+						advance_to_next_rune(t);
+					}
 				}
 				token.kind = Token_Comment;
 			} else {
@@ -980,7 +1386,9 @@ Token tokenizer_get_token(Tokenizer *t) {
 		case '/': {
 			if (t->curr_rune == '/') {
 				while (t->curr_rune != '\n' && t->curr_rune != GB_RUNE_EOF) {
-					advance_to_next_rune(t);
+					if (!tokenizer_skip_run(t, TokenizerRun_LineComment)) {
+						advance_to_next_rune(t);
+					}
 				}
 				token.kind = Token_Comment;
 			} else if (t->curr_rune == '*') {
@@ -1001,7 +1409,7 @@ Token tokenizer_get_token(Tokenizer *t) {
 							advance_to_next_rune(t);
 							comment_scope--;
 						}
-					} else {
+					} else if (!tokenizer_skip_run(t, TokenizerRun_BlockComment)) {
 						advance_to_next_rune(t);
 					}
 				}
@@ -1049,5 +1457,8 @@ Token tokenizer_get_token(Tokenizer *t) {
 	}
 
 	token.string.len = t->curr - token.string.text;
+	if (token.kind == Token_Ident) {
+		token.string = string_intern(token.string);
+	}
 	return token;
 }
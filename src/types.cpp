@@ -294,6 +294,15 @@ Selection selection_combine(Selection const &lhs, Selection const &rhs) {
 
 
 
+// NOTE: Guards the lazily calculated layout of types which may be shared
+// between procedure bodies that are being checked in parallel
+gb_global gbMutex global_type_mutex;
+
+void init_global_type_mutex(void) {
+	gb_mutex_init(&global_type_mutex);
+}
+
+
 gb_global Type basic_types[] = {
 	{Type_Basic, {Basic_Invalid,           0,                                          0, STR_LIT("invalid type")}},
 
@@ -496,6 +505,12 @@ gb_global Type *t_source_code_location_ptr    = nullptr;
 gb_global Type *t_map_key                     = nullptr;
 gb_global Type *t_map_header                  = nullptr;
 
+// NOTE: The fields of built-in types which can be selected directly, see 'lookup_field_with_selection'
+gb_global Entity *entity__any_data                = nullptr;
+gb_global Entity *entity__any_id                  = nullptr;
+gb_global Entity *entity__dynamic_array_allocator = nullptr;
+gb_global Entity *entity__map_allocator           = nullptr;
+
 
 
 i64      type_size_of               (Type *t);
@@ -576,16 +591,125 @@ void set_base_type(Type *t, Type *base) {
 }
 
 
+gb_global Arena global_type_arena = {};
+gb_global gbAtomic64 global_type_count = {0};
+
+gbAllocator type_allocator(void) {
+	Arena *arena = &global_type_arena;
+	return arena_allocator(arena);
+}
+
 Type *alloc_type(TypeKind kind) {
-	gbAllocator a = heap_allocator();
+	gbAllocator a = type_allocator();
 	Type *t = gb_alloc_item(a, Type);
 	gb_zero_item(t);
+	gb_atomic64_fetch_add(&global_type_count, 1);
 	t->kind = kind;
 	t->cached_size  = -1;
 	t->cached_align = -1;
 	return t;
 }
 
+// NOTE: Unnamed structural types which are never modified once made (pointers, opaques,
+// arrays, slices, dynamic arrays, maps, and bit sets) are hash-consed so that identical ones
+// share a single node. The element types are compared by pointer, so 'are_types_identical'
+// is still needed for types which are only structurally identical (e.g. through an alias).
+// Tuples and procedures are not hash-consed, as their entities carry names and scopes.
+struct TypeCanonicalKey {
+	i64   kind; // NOTE: i64 so that there is no padding, the key is hashed and compared as bytes
+	Type *a;
+	Type *b;
+	i64   x;
+	i64   y;
+};
+
+#define TYPE_CANONICAL_SHARD_COUNT 16
+
+struct TypeCanonicalShard {
+	gbMutex     mutex;
+	Map<Type *> types; // Key: hash of TypeCanonicalKey (multi map)
+};
+
+// NOTE: Sharded as types are made whilst procedure bodies are checked in parallel
+gb_global TypeCanonicalShard global_canonical_types[TYPE_CANONICAL_SHARD_COUNT] = {};
+
+void init_canonical_types(void) {
+	for (isize i = 0; i < TYPE_CANONICAL_SHARD_COUNT; i++) {
+		TypeCanonicalShard *shard = &global_canonical_types[i];
+		gb_mutex_init(&shard->mutex);
+		map_init(&shard->types, heap_allocator(), 1024);
+	}
+}
+
+TypeCanonicalKey type_canonical_key(Type const *t) {
+	TypeCanonicalKey key = {t->kind};
+	switch (t->kind) {
+	case Type_Pointer:
+		key.a = t->Pointer.elem;
+		break;
+	case Type_Opaque:
+		key.a = t->Opaque.elem;
+		break;
+	case Type_Array:
+		key.a = t->Array.elem;
+		key.x = t->Array.count;
+		break;
+	case Type_Slice:
+		key.a = t->Slice.elem;
+		break;
+	case Type_DynamicArray:
+		key.a = t->DynamicArray.elem;
+		break;
+	case Type_Map:
+		key.a = t->Map.key;
+		key.b = t->Map.value;
+		break;
+	case Type_BitSet:
+		key.a = t->BitSet.elem;
+		key.b = t->BitSet.underlying;
+		key.x = t->BitSet.lower;
+		key.y = t->BitSet.upper;
+		break;
+	default:
+		GB_PANIC("Type %.*s cannot be made canonical", LIT(type_strings[t->kind]));
+		break;
+	}
+	return key;
+}
+
+// NOTE: Returns the shared node which is identical to 'proto', which is copied if there is none yet
+Type *alloc_type_canonical(Type const *proto) {
+	TypeCanonicalKey key = type_canonical_key(proto);
+	u64 hash = gb_fnv64a(&key, gb_size_of(key));
+	HashKey hkey = hash_integer(hash);
+	TypeCanonicalShard *shard = &global_canonical_types[hash % TYPE_CANONICAL_SHARD_COUNT];
+
+	gb_mutex_lock(&shard->mutex);
+	defer (gb_mutex_unlock(&shard->mutex));
+
+	for (MapEntry<Type *> *e = multi_map_find_first(&shard->types, hkey);
+	     e != nullptr;
+	     e = multi_map_find_next(&shard->types, e)) {
+		TypeCanonicalKey other = type_canonical_key(e->value);
+		if (gb_memcompare(&key, &other, gb_size_of(key)) == 0) {
+			return e->value;
+		}
+	}
+
+	Type *t = alloc_type(proto->kind);
+	switch (proto->kind) {
+	case Type_Pointer:      t->Pointer      = proto->Pointer;      break;
+	case Type_Opaque:       t->Opaque       = proto->Opaque;       break;
+	case Type_Array:        t->Array        = proto->Array;        break;
+	case Type_Slice:        t->Slice        = proto->Slice;        break;
+	case Type_DynamicArray: t->DynamicArray = proto->DynamicArray; break;
+	case Type_Map:          t->Map          = proto->Map;          break;
+	case Type_BitSet:       t->BitSet       = proto->BitSet;       break;
+	}
+	multi_map_insert(&shard->types, hkey, t);
+	return t;
+}
+
 
 Type *alloc_type_generic(Scope *scope, i64 id, String name, Type *specialized) {
 	Type *t = alloc_type(Type_Generic);
@@ -597,41 +721,43 @@ Type *alloc_type_generic(Scope *scope, i64 id, String name, Type *specialized) {
 }
 
 Type *alloc_type_opaque(Type *elem) {
-	Type *t = alloc_type(Type_Opaque);
-	t->Opaque.elem = elem;
-	return t;
+	Type t = {Type_Opaque};
+	t.Opaque.elem = elem;
+	return alloc_type_canonical(&t);
 }
 
 Type *alloc_type_pointer(Type *elem) {
-	Type *t = alloc_type(Type_Pointer);
-	t->Pointer.elem = elem;
-	return t;
+	Type t = {Type_Pointer};
+	t.Pointer.elem = elem;
+	return alloc_type_canonical(&t);
 }
 
 Type *alloc_type_array(Type *elem, i64 count, Type *generic_count = nullptr) {
-	if (generic_count != nullptr) {
+	if (generic_count != nullptr || count < 0) {
+		// NOTE: Polymorphic and '[?]T' counts are filled in later, so these cannot be shared
 		Type *t = alloc_type(Type_Array);
 		t->Array.elem = elem;
 		t->Array.count = count;
 		t->Array.generic_count = generic_count;
 		return t;
 	}
-	Type *t = alloc_type(Type_Array);
-	t->Array.elem = elem;
-	t->Array.count = count;
-	return t;
+	Type t = {Type_Array};
+	t.Array.elem = elem;
+	t.Array.count = count;
+	t.Array.generic_count = nullptr;
+	return alloc_type_canonical(&t);
 }
 
 Type *alloc_type_slice(Type *elem) {
-	Type *t = alloc_type(Type_Slice);
-	t->Array.elem = elem;
-	return t;
+	Type t = {Type_Slice};
+	t.Slice.elem = elem;
+	return alloc_type_canonical(&t);
 }
 
 Type *alloc_type_dynamic_array(Type *elem) {
-	Type *t = alloc_type(Type_DynamicArray);
-	t->DynamicArray.elem = elem;
-	return t;
+	Type t = {Type_DynamicArray};
+	t.DynamicArray.elem = elem;
+	return alloc_type_canonical(&t);
 }
 
 
@@ -699,10 +825,14 @@ Type *alloc_type_map(i64 count, Type *key, Type *value) {
 		GB_ASSERT(is_type_valid_for_keys(key));
 		GB_ASSERT(value != nullptr);
 	}
-	Type *t = alloc_type(Type_Map);
-	t->Map.key   = key;
-	t->Map.value = value;
-	return t;
+	Type t = {Type_Map};
+	t.Map.key                   = key;
+	t.Map.value                 = value;
+	t.Map.entry_type            = nullptr;
+	t.Map.generated_struct_type = nullptr;
+	t.Map.internal_type         = nullptr;
+	t.Map.lookup_result_type    = nullptr;
+	return alloc_type_canonical(&t);
 }
 
 Type *alloc_type_bit_field_value(u32 bits) {
@@ -720,6 +850,19 @@ Type *alloc_type_bit_set() {
 	return t;
 }
 
+// NOTE: Bit sets are filled in whilst being checked, so they are only made canonical afterwards
+Type *bit_set_type_canonical(Type *t) {
+	GB_ASSERT(t->kind == Type_BitSet);
+	Type *elem       = t->BitSet.elem;
+	Type *underlying = t->BitSet.underlying;
+	if ((elem != nullptr && elem->kind == Type_Generic) ||
+	    (underlying != nullptr && underlying->kind == Type_Generic)) {
+		// NOTE: Polymorphic bit sets are modified when they are specialized
+		return t;
+	}
+	return alloc_type_canonical(t);
+}
+
 
 
 
@@ -1642,6 +1785,96 @@ bool are_types_identical(Type *x, Type *y) {
 	return false;
 }
 
+u64 type_hash_combine(u64 h, u64 value) {
+	return h ^ (value + 0x9e3779b97f4a7c15ull + (h<<6) + (h>>2));
+}
+
+// NOTE: Types which are identical (see 'are_types_identical') have the same structural hash,
+// so it has to follow the same rules, but it may ignore anything which is cheap to compare later
+u64 type_hash_structural(Type *t) {
+	if (t == nullptr) {
+		return 0;
+	}
+	t = strip_type_aliasing(t);
+
+	u64 h = cast(u64)t->kind;
+	switch (t->kind) {
+	case Type_Generic:
+		return type_hash_combine(h, type_hash_structural(t->Generic.specialized));
+	case Type_Opaque:
+		return type_hash_combine(h, type_hash_structural(t->Opaque.elem));
+	case Type_Basic:
+		return type_hash_combine(h, cast(u64)t->Basic.kind);
+	case Type_Array:
+		h = type_hash_combine(h, cast(u64)t->Array.count);
+		return type_hash_combine(h, type_hash_structural(t->Array.elem));
+	case Type_DynamicArray:
+		return type_hash_combine(h, type_hash_structural(t->DynamicArray.elem));
+	case Type_Slice:
+		return type_hash_combine(h, type_hash_structural(t->Slice.elem));
+	case Type_Pointer:
+		return type_hash_combine(h, type_hash_structural(t->Pointer.elem));
+	case Type_Map:
+		h = type_hash_combine(h, type_hash_structural(t->Map.key));
+		return type_hash_combine(h, type_hash_structural(t->Map.value));
+
+	case Type_BitField:
+		h = type_hash_combine(h, cast(u64)t->BitField.fields.count);
+		return type_hash_combine(h, cast(u64)t->BitField.custom_align);
+
+	case Type_BitSet:
+		h = type_hash_combine(h, type_hash_structural(t->BitSet.elem));
+		h = type_hash_combine(h, type_hash_structural(t->BitSet.underlying));
+		h = type_hash_combine(h, cast(u64)t->BitSet.lower);
+		return type_hash_combine(h, cast(u64)t->BitSet.upper);
+
+	case Type_Union:
+		h = type_hash_combine(h, cast(u64)t->Union.variants.count);
+		h = type_hash_combine(h, cast(u64)t->Union.custom_align);
+		for_array(i, t->Union.variants) {
+			h = type_hash_combine(h, type_hash_structural(t->Union.variants[i]));
+		}
+		return h;
+
+	case Type_Struct:
+		h = type_hash_combine(h, cast(u64)t->Struct.is_raw_union);
+		h = type_hash_combine(h, cast(u64)t->Struct.is_packed);
+		h = type_hash_combine(h, cast(u64)t->Struct.custom_align);
+		h = type_hash_combine(h, cast(u64)t->Struct.fields.count);
+		for_array(i, t->Struct.fields) {
+			Entity *f = t->Struct.fields[i];
+			String name = f->token.string;
+			h = type_hash_combine(h, cast(u64)f->kind);
+			h = type_hash_combine(h, gb_fnv64a(name.text, name.len));
+			h = type_hash_combine(h, type_hash_structural(f->type));
+		}
+		return h;
+
+	case Type_Named:
+		return type_hash_combine(h, cast(u64)cast(uintptr)t->Named.type_name);
+
+	case Type_Tuple:
+		h = type_hash_combine(h, cast(u64)t->Tuple.variables.count);
+		for_array(i, t->Tuple.variables) {
+			Entity *v = t->Tuple.variables[i];
+			h = type_hash_combine(h, cast(u64)v->kind);
+			h = type_hash_combine(h, type_hash_structural(v->type));
+		}
+		return h;
+
+	case Type_Proc:
+		h = type_hash_combine(h, cast(u64)t->Proc.calling_convention);
+		h = type_hash_combine(h, cast(u64)t->Proc.c_vararg);
+		h = type_hash_combine(h, cast(u64)t->Proc.variadic);
+		h = type_hash_combine(h, cast(u64)t->Proc.diverging);
+		h = type_hash_combine(h, type_hash_structural(t->Proc.params));
+		return type_hash_combine(h, type_hash_structural(t->Proc.results));
+	}
+
+	// NOTE: Enums and everything else are only identical to themselves
+	return type_hash_combine(h, cast(u64)cast(uintptr)t);
+}
+
 Type *default_bit_field_value_type(Type *type) {
 	if (type == nullptr) {
 		return t_invalid;
@@ -2073,8 +2306,7 @@ Selection lookup_field_with_selection(Type *type_, String field_name, bool is_ty
 			// `Raw_Any` type?
 			String data_str = str_lit("data");
 			String id_str = str_lit("id");
-			gb_local_persist Entity *entity__any_data = alloc_entity_field(nullptr, make_token_ident(data_str), t_rawptr, false, 0);
-			gb_local_persist Entity *entity__any_id = alloc_entity_field(nullptr, make_token_ident(id_str), t_typeid, false, 1);
+			GB_ASSERT(entity__any_data != nullptr && entity__any_id != nullptr);
 
 			if (field_name == data_str) {
 				selection_add_index(&sel, 0);
@@ -2115,26 +2347,24 @@ Selection lookup_field_with_selection(Type *type_, String field_name, bool is_ty
 	} else if (type->kind == Type_DynamicArray) {
 		// IMPORTANT TODO(bill): Should these members be available to should I only allow them with
 		// `Raw_Dynamic_Array` type?
-		GB_ASSERT(t_allocator != nullptr);
+		GB_ASSERT(entity__dynamic_array_allocator != nullptr);
 		String allocator_str = str_lit("allocator");
-		gb_local_persist Entity *entity__allocator = alloc_entity_field(nullptr, make_token_ident(allocator_str), t_allocator, false, 3);
 
 		if (field_name == allocator_str) {
 			selection_add_index(&sel, 3);
-			sel.entity = entity__allocator;
+			sel.entity = entity__dynamic_array_allocator;
 			return sel;
 		}
 	} else if (type->kind == Type_Map) {
 		// IMPORTANT TODO(bill): Should these members be available to should I only allow them with
 		// `Raw_Map` type?
-		GB_ASSERT(t_allocator != nullptr);
+		GB_ASSERT(entity__map_allocator != nullptr);
 		String allocator_str = str_lit("allocator");
-		gb_local_persist Entity *entity__allocator = alloc_entity_field(nullptr, make_token_ident(allocator_str), t_allocator, false, 3);
 
 		if (field_name == allocator_str) {
 			selection_add_index(&sel, 1);
 			selection_add_index(&sel, 3);
-			sel.entity = entity__allocator;
+			sel.entity = entity__map_allocator;
 			return sel;
 		}
 	}
@@ -2428,6 +2658,8 @@ Array<i64> type_set_offsets_of(Array<Entity *> fields, bool is_packed, bool is_r
 
 bool type_set_offsets(Type *t) {
 	t = base_type(t);
+	gb_mutex_lock(&global_type_mutex);
+	defer (gb_mutex_unlock(&global_type_mutex));
 	if (t->kind == Type_Struct) {
 		if (!t->Struct.are_offsets_set) {
 			t->Struct.are_offsets_being_processed = true;
@@ -2589,6 +2821,8 @@ i64 type_size_of_internal(Type *t, TypePath *path) {
 			if (path->failure) {
 				return FAILURE_SIZE;
 			}
+			gb_mutex_lock(&global_type_mutex);
+			defer (gb_mutex_unlock(&global_type_mutex));
 			if (t->Struct.are_offsets_being_processed && t->Struct.offsets.data == nullptr) {
 				type_path_print_illegal_cycle(path, path->path.count-1);
 				return FAILURE_SIZE;